@@ -0,0 +1,117 @@
+/*
+ * Counts global heap allocations made while parsing a classfile from memory,
+ * with nodes allocated from the heap versus from a monotonic arena.
+ */
+
+#include <ClassFile/ClassFile.hpp>
+#include <ClassFile/Parser.hpp>
+
+#include <iostream>
+#include <fstream>
+#include <chrono>
+#include <cstdlib>
+#include <new>
+#include <vector>
+#include <memory_resource>
+
+static size_t AllocationCount{0};
+
+void* operator new(std::size_t size)
+{
+  AllocationCount++;
+
+  if(void* ptr = std::malloc(size))
+    return ptr;
+
+  throw std::bad_alloc{};
+}
+
+//std::pmr::new_delete_resource() allocates through the aligned overloads
+void* operator new(std::size_t size, std::align_val_t align)
+{
+  AllocationCount++;
+
+  size_t alignment = static_cast<size_t>(align);
+  size = (size + alignment - 1) & ~(alignment - 1);
+
+  if(void* ptr = std::aligned_alloc(alignment, size))
+    return ptr;
+
+  throw std::bad_alloc{};
+}
+
+void operator delete(void* ptr) noexcept { std::free(ptr); }
+void operator delete(void* ptr, std::size_t) noexcept { std::free(ptr); }
+void operator delete(void* ptr, std::align_val_t) noexcept { std::free(ptr); }
+void operator delete(void* ptr, std::size_t, std::align_val_t) noexcept { std::free(ptr); }
+
+using Clock = std::chrono::high_resolution_clock;
+
+template <typename Func>
+static void Run(std::string_view name, size_t iterations, Func&& parse)
+{
+  size_t countBefore = AllocationCount;
+  auto before = Clock::now();
+
+  for(size_t i = 0; i < iterations; i++)
+  {
+    if(!parse())
+      return;
+  }
+
+  auto after = Clock::now();
+  size_t allocations = AllocationCount - countBefore;
+
+  std::cout << name << ": " << allocations / iterations << " allocations/parse, ~"
+    << std::chrono::duration_cast<std::chrono::nanoseconds>(after-before).count() / 1000.0 / iterations
+    << " microseconds/parse\n";
+}
+
+int main(int argc, char** argv)
+{
+  if(argc < 2)
+  {
+    std::cout << "Usage: " << argv[0] << " <classfile> (iterations)\n";
+    return -1;
+  }
+
+  size_t iterations = argc > 2 ? std::stoul(argv[2]) : 1000;
+
+  std::ifstream infile{argv[1], std::ios::binary};
+
+  if(!infile.good())
+  {
+    std::cout << "Unable to open file \"" << argv[1] << "\"\n";
+    return -2;
+  }
+
+  std::vector<ClassFile::U8> contents{std::istreambuf_iterator<char>(infile), {}};
+
+  auto parse = [&](const ClassFile::ParseOptions& opts)
+  {
+    auto errOrClass = ClassFile::Parser::ParseClassFile(contents.data(), contents.size(), opts);
+
+    if(errOrClass.IsError())
+    {
+      std::cout << "PARSING ERROR: " << errOrClass.GetError().Message() << '\n';
+      return false;
+    }
+
+    return true;
+  };
+
+  Run("heap ", iterations, [&]()
+  {
+    return parse({});
+  });
+
+  Run("arena", iterations, [&]()
+  {
+    std::pmr::monotonic_buffer_resource arena{contents.size() * 4};
+
+    ClassFile::ParseOptions opts;
+    opts.Resource = &arena;
+
+    return parse(opts);
+  });
+}
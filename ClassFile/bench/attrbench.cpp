@@ -0,0 +1,132 @@
+/*
+ * Measures what attributes cost while parsing a classfile from memory: a
+ * plain parse (standard attributes other than the fixed size ones are only
+ * retained), a parse followed by decoding every attribute of the class, its
+ * fields, methods and Code attributes, and decoding alone. Every variant is
+ * run <iterations> times.
+ */
+
+#include <ClassFile/ClassFile.hpp>
+#include <ClassFile/Parser.hpp>
+
+#include <iostream>
+#include <fstream>
+#include <chrono>
+#include <iterator>
+#include <string>
+#include <vector>
+
+using Clock = std::chrono::high_resolution_clock;
+
+static double Seconds(Clock::time_point before, Clock::time_point after)
+{
+  return std::chrono::duration_cast<std::chrono::nanoseconds>(after-before).count() / 1e9;
+}
+
+static void Report(std::string_view name, size_t iterations, double seconds)
+{
+  std::cout << name << ": " << iterations << " classes in ~" << seconds * 1000.0 << " milliseconds ("
+    << seconds / iterations * 1e6 << " microseconds per class)\n";
+}
+
+static bool DecodeAll(std::vector< std::unique_ptr<ClassFile::AttributeInfo> >& attrs,
+    const ClassFile::ConstantPool& cp, size_t& decoded)
+{
+  for(auto& pAttr : attrs)
+  {
+    if(ClassFile::Parser::DecodeAttribute(*pAttr, cp).IsError())
+      return false;
+
+    decoded++;
+
+    if(pAttr->GetType() == ClassFile::AttributeInfo::Type::Code)
+    {
+      auto& code = static_cast<ClassFile::CodeAttribute&>(*pAttr);
+
+      if(!DecodeAll(code.Attributes, cp, decoded))
+        return false;
+    }
+  }
+
+  return true;
+}
+
+static bool DecodeAll(ClassFile::ClassFile& cf, size_t& decoded)
+{
+  for(auto& field : cf.Fields)
+  {
+    if(!DecodeAll(field.Attributes, cf.ConstPool, decoded))
+      return false;
+  }
+
+  for(auto& method : cf.Methods)
+  {
+    if(!DecodeAll(method.Attributes, cf.ConstPool, decoded))
+      return false;
+  }
+
+  return DecodeAll(cf.Attributes, cf.ConstPool, decoded);
+}
+
+int main(int argc, char** argv)
+{
+  if(argc < 2)
+  {
+    std::cout << "Usage: " << argv[0] << " <classfile> (iterations)\n";
+    return -1;
+  }
+
+  size_t iterations = argc > 2 ? std::stoul(argv[2]) : 10000;
+
+  std::ifstream infile{argv[1], std::ios::binary};
+
+  if(!infile.good())
+  {
+    std::cout << "Unable to open file \"" << argv[1] << "\"\n";
+    return -2;
+  }
+
+  std::vector<ClassFile::U8> contents{std::istreambuf_iterator<char>(infile), {}};
+
+  auto before = Clock::now();
+  for(size_t i = 0; i < iterations; i++)
+  {
+    if(ClassFile::Parser::ParseClassFile(contents.data(), contents.size()).IsError())
+      return -3;
+  }
+  auto after = Clock::now();
+
+  Report("parse           ", iterations, Seconds(before, after));
+
+  size_t decoded{0};
+  before = Clock::now();
+  for(size_t i = 0; i < iterations; i++)
+  {
+    auto errOrClass = ClassFile::Parser::ParseClassFile(contents.data(), contents.size());
+
+    if(errOrClass.IsError() || !DecodeAll(errOrClass.Get(), decoded))
+      return -4;
+  }
+  after = Clock::now();
+
+  Report("parse + decode  ", iterations, Seconds(before, after));
+  std::cout << "  (" << decoded / iterations << " attributes per class)\n";
+
+  //decoding only, every iteration starts from an undecoded class
+  std::vector<ClassFile::ClassFile> classes;
+  classes.reserve(iterations);
+
+  for(size_t i = 0; i < iterations; i++)
+    classes.emplace_back(ClassFile::Parser::ParseClassFile(contents.data(), contents.size()).Release());
+
+  decoded = 0;
+  before = Clock::now();
+  for(auto& cf : classes)
+  {
+    if(!DecodeAll(cf, decoded))
+      return -4;
+  }
+  after = Clock::now();
+
+  Report("decode          ", iterations, Seconds(before, after));
+}
@@ -0,0 +1,89 @@
+/*
+ * Measures BatchParser scaling by parsing a synthetic in-memory corpus of 
+ * <copies> copies of a classfile with 1, 2, 4, ... up to <threads> workers
+ * (defaults to the number of hardware threads).
+ */
+
+#include <ClassFile/BatchParser.hpp>
+
+#include <iostream>
+#include <fstream>
+#include <chrono>
+#include <string>
+#include <thread>
+#include <vector>
+
+using Clock = std::chrono::high_resolution_clock;
+
+static double Seconds(Clock::time_point before, Clock::time_point after)
+{
+  return std::chrono::duration_cast<std::chrono::nanoseconds>(after-before).count() / 1e9;
+}
+
+int main(int argc, char** argv)
+{
+  if(argc < 2)
+  {
+    std::cout << "Usage: " << argv[0] << " <classfile> (copies) (threads)\n";
+    return -1;
+  }
+
+  size_t copies = argc > 2 ? std::stoul(argv[2]) : 100000;
+  unsigned maxThreads = argc > 3 ? std::stoul(argv[3]) : std::thread::hardware_concurrency();
+
+  std::ifstream infile{argv[1], std::ios::binary};
+
+  if(!infile.good())
+  {
+    std::cout << "Unable to open file \"" << argv[1] << "\"\n";
+    return -2;
+  }
+
+  //one contiguous corpus with a separate copy per input, so workers don't 
+  //all read the same cache lines
+  std::vector<ClassFile::U8> contents{std::istreambuf_iterator<char>(infile), {}};
+  std::vector<ClassFile::U8> corpus(contents.size() * copies);
+
+  std::vector<ClassFile::ByteView> buffers;
+  buffers.reserve(copies);
+
+  for(size_t i = 0; i < copies; i++)
+  {
+    ClassFile::U8* dst = corpus.data() + i * contents.size();
+    std::copy(contents.begin(), contents.end(), dst);
+    buffers.push_back({dst, contents.size()});
+  }
+
+  double baseline{0};
+
+  for(unsigned threads = 1; threads <= std::max(1u, maxThreads); threads *= 2)
+  {
+    ClassFile::BatchOptions opts;
+    opts.Threads = threads;
+
+    ClassFile::BatchParser parser{opts};
+
+    auto before = Clock::now();
+    auto result = parser.ParseBuffers(buffers);
+    auto after = Clock::now();
+
+    for(auto& errOrClass : result)
+    {
+      if(errOrClass.IsError())
+      {
+        std::cout << "Failed to parse: " << errOrClass.GetError().Message() << '\n';
+        return -3;
+      }
+    }
+
+    double seconds = Seconds(before, after);
+
+    if(threads == 1)
+      baseline = seconds;
+
+    std::cout << threads << " thread(s): " << copies << " files in ~" << seconds * 1000.0 
+      << " milliseconds (" << copies / seconds << " files/s, " 
+      << corpus.size() / seconds / (1024.0 * 1024.0) << " MiB/s, speedup x" 
+      << baseline / seconds << ")\n";
+  }
+}
@@ -0,0 +1,306 @@
+/*
+ * Measures ControlFlowGraph::Create() on synthetic methods with thousands of
+ * basic blocks: randomly nested if/else, while and do-while loops with the
+ * occasional break or continue, tableswitches, early returns and try blocks
+ * with handlers. Every size is run <iterations> times.
+ */
+
+#include <ClassFile/Attribute.hpp>
+#include <ClassFile/ControlFlowGraph.hpp>
+#include <ClassFile/Instruction.hpp>
+
+#include <iostream>
+#include <algorithm>
+#include <chrono>
+#include <random>
+#include <string>
+#include <vector>
+
+using Clock = std::chrono::high_resolution_clock;
+using Opcode = ClassFile::Instruction::Opcode;
+
+//Emits instructions referring to labels, which are resolved to offsets by
+//Finish() once switch padding is known
+class Assembler
+{
+  public:
+    size_t NewLabel()
+    {
+      m_labels.push_back(0);
+      return m_labels.size() - 1;
+    }
+
+    void Bind(size_t label) { m_labels[label] = m_attr.Code.size(); }
+
+    void Emit(Opcode op) { m_attr.Code.push_back(ClassFile::Instruction::MakeInstruction(op).Get()); }
+
+    void Branch(Opcode op, size_t label)
+    {
+      m_fixups.push_back({m_attr.Code.size(), {label}});
+      Emit(op);
+      Terminators++;
+    }
+
+    //targets.front() is the default
+    void Switch(std::vector<size_t> targets)
+    {
+      ClassFile::SwitchTable table{};
+      table.Offsets.resize(targets.size() - 1);
+
+      m_fixups.push_back({m_attr.Code.size(), std::move(targets)});
+      m_attr.Code.push_back(ClassFile::Instruction::MakeSwitch(Opcode::TABLESWITCH, 
+        static_cast<ClassFile::U32>(m_attr.Switches.size())).Get());
+      m_attr.Switches.push_back(std::move(table));
+      Terminators++;
+    }
+
+    void Return()
+    {
+      Emit(Opcode::RETURN);
+      Terminators++;
+    }
+
+    void Try(size_t start, size_t end, size_t handler) { m_handlers.push_back({start, end, handler}); }
+
+    ClassFile::CodeAttribute Finish()
+    {
+      const auto& code = m_attr.Code;
+
+      std::vector<size_t> offsets(code.size() + 1);
+      for(size_t i = 0; i < code.size(); i++)
+        offsets[i+1] = offsets[i] + code[i].GetLength(offsets[i], m_attr.Switches);
+
+      auto offset = [&](size_t label) { return offsets[m_labels[label]]; };
+      auto relative = [&](size_t instr, size_t label)
+      {
+        return static_cast<ClassFile::S32>(offset(label)) - static_cast<ClassFile::S32>(offsets[instr]);
+      };
+
+      for(const auto& [instr, targets] : m_fixups)
+      {
+        ClassFile::Instruction& branch = m_attr.Code[instr];
+
+        if(!branch.IsSwitch())
+        {
+          (void)branch.SetOperand(0, relative(instr, targets[0]));
+          continue;
+        }
+
+        ClassFile::SwitchTable& table = m_attr.Switches[branch.GetSwitchIndex()];
+        table.Default = relative(instr, targets[0]);
+
+        for(size_t i = 0; i < table.Offsets.size(); i++)
+          table.Offsets[i] = relative(instr, targets[i+1]);
+      }
+
+      for(const auto& [start, end, handler] : m_handlers)
+      {
+        m_attr.ExceptionTable.push_back({static_cast<ClassFile::U16>(offset(start)),
+          static_cast<ClassFile::U16>(offset(end)), static_cast<ClassFile::U16>(offset(handler)), 0});
+      }
+
+      m_attr.MaxStack = 1;
+      m_attr.MaxLocals = 1;
+
+      return std::move(m_attr);
+    }
+
+    size_t Terminators{0};
+
+  private:
+    struct Handler
+    {
+      size_t Start;
+      size_t End;
+      size_t Target;
+    };
+
+    ClassFile::CodeAttribute m_attr;
+    std::vector<size_t> m_labels;
+    std::vector< std::pair<size_t, std::vector<size_t>> > m_fixups;
+    std::vector<Handler> m_handlers;
+};
+
+struct Generator
+{
+  static constexpr int MaxDepth = 6;
+
+  Assembler& Asm;
+  std::mt19937& Rng;
+
+  //innermost loop's continue & break labels
+  std::vector< std::pair<size_t, size_t> > Loops;
+
+  int Percent() { return std::uniform_int_distribution<int>{0, 99}(Rng); }
+
+  void Body(int depth)
+  {
+    for(int i = std::uniform_int_distribution<int>{1, 3}(Rng); i > 0; i--)
+      Statement(depth + 1);
+  }
+
+  void Statement(int depth)
+  {
+    int kind = depth < MaxDepth ? Percent() : 0;
+
+    if(kind < 25)
+    {
+      Asm.Emit(Opcode::NOP);
+
+      //break or continue
+      if(!Loops.empty() && Percent() < 20)
+      {
+        size_t skip = Asm.NewLabel();
+
+        Asm.Emit(Opcode::ICONST_0);
+        Asm.Branch(Opcode::IFEQ, skip);
+        Asm.Branch(Opcode::GOTO, Percent() < 50 ? Loops.back().first : Loops.back().second);
+        Asm.Bind(skip);
+      }
+    }
+    else if(kind < 45)
+    {
+      size_t otherwise = Asm.NewLabel(), end = Asm.NewLabel();
+
+      Asm.Emit(Opcode::ICONST_0);
+      Asm.Branch(Opcode::IFEQ, otherwise);
+      Body(depth);
+      Asm.Branch(Opcode::GOTO, end);
+      Asm.Bind(otherwise);
+      Body(depth);
+      Asm.Bind(end);
+    }
+    else if(kind < 60)
+    {
+      //while: jump to the condition at the bottom
+      size_t body = Asm.NewLabel(), condition = Asm.NewLabel(), end = Asm.NewLabel();
+
+      Asm.Branch(Opcode::GOTO, condition);
+      Asm.Bind(body);
+      Loops.push_back({condition, end});
+      Body(depth);
+      Loops.pop_back();
+      Asm.Bind(condition);
+      Asm.Emit(Opcode::ICONST_0);
+      Asm.Branch(Opcode::IFNE, body);
+      Asm.Bind(end);
+      Asm.Emit(Opcode::NOP);
+    }
+    else if(kind < 75)
+    {
+      size_t body = Asm.NewLabel(), condition = Asm.NewLabel(), end = Asm.NewLabel();
+
+      Asm.Bind(body);
+      Loops.push_back({condition, end});
+      Body(depth);
+      Loops.pop_back();
+      Asm.Bind(condition);
+      Asm.Emit(Opcode::ICONST_0);
+      Asm.Branch(Opcode::IFNE, body);
+      Asm.Bind(end);
+      Asm.Emit(Opcode::NOP);
+    }
+    else if(kind < 82)
+    {
+      size_t end = Asm.NewLabel();
+      std::vector<size_t> cases(4);
+
+      for(size_t& label : cases)
+        label = Asm.NewLabel();
+
+      Asm.Emit(Opcode::ICONST_0);
+      Asm.Switch({end, cases[0], cases[1], cases[2], cases[3]});
+
+      for(size_t label : cases)
+      {
+        Asm.Bind(label);
+        Body(depth);
+
+        //fall through to the next case otherwise
+        if(Percent() < 70)
+          Asm.Branch(Opcode::GOTO, end);
+      }
+
+      Asm.Bind(end);
+      Asm.Emit(Opcode::NOP);
+    }
+    else if(kind < 90)
+    {
+      size_t start = Asm.NewLabel(), end = Asm.NewLabel(), handler = Asm.NewLabel(), after = Asm.NewLabel();
+
+      Asm.Bind(start);
+      Body(depth);
+      Asm.Bind(end);
+      Asm.Branch(Opcode::GOTO, after);
+      Asm.Bind(handler);
+      Body(depth);
+      Asm.Bind(after);
+      Asm.Emit(Opcode::NOP);
+      Asm.Try(start, end, handler);
+    }
+    else
+    {
+      size_t skip = Asm.NewLabel();
+
+      Asm.Emit(Opcode::ICONST_0);
+      Asm.Branch(Opcode::IFEQ, skip);
+      Asm.Return();
+      Asm.Bind(skip);
+    }
+  }
+};
+
+//Top level statements until roughly blockCount blocks were emitted
+static ClassFile::CodeAttribute MakeMethod(size_t blockCount, std::mt19937& rng)
+{
+  Assembler assembler;
+  Generator generator{assembler, rng, {}};
+
+  while(assembler.Terminators < blockCount)
+    generator.Statement(0);
+
+  assembler.Return();
+
+  return assembler.Finish();
+}
+
+int main(int argc, char** argv)
+{
+  size_t iterations = argc > 1 ? std::stoul(argv[1]) : 100;
+
+  std::mt19937 rng{42};
+
+  //code_length stays below 65536 so ExceptionTable offsets fit
+  for(size_t blockCount : {1000, 4000, 12000})
+  {
+    ClassFile::CodeAttribute attr = MakeMethod(blockCount, rng);
+
+    auto errOrGraph = ClassFile::ControlFlowGraph::Create(attr);
+    if(errOrGraph.IsError())
+    {
+      std::cout << "ERROR: " << errOrGraph.GetError().Message() << '\n';
+      return -1;
+    }
+
+    const ClassFile::ControlFlowGraph& cfg = errOrGraph.Get();
+
+    ClassFile::U32 maxDepth{0};
+    for(const auto& loop : cfg.Loops)
+      maxDepth = std::max(maxDepth, loop.Depth);
+
+    auto before = Clock::now();
+    for(size_t i = 0; i < iterations; i++)
+    {
+      if(ClassFile::ControlFlowGraph::Create(attr).IsError())
+        return -1;
+    }
+    auto after = Clock::now();
+
+    double micros = std::chrono::duration_cast<std::chrono::nanoseconds>(after-before).count() / 1000.0 / iterations;
+
+    std::cout << attr.Code.size() << " instructions, " << cfg.Blocks.size() << " blocks ("
+      << cfg.ReversePostOrder.size() << " reachable), " << cfg.Edges.size() << " edges, "
+      << cfg.Loops.size() << " loops (max depth " << maxDepth << "): ~" << micros
+      << " microseconds per graph (" << micros * 1000.0 / cfg.Blocks.size() << " ns per block)\n";
+  }
+}
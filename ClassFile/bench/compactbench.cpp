@@ -0,0 +1,131 @@
+/*
+ * Measures ConstantPoolRewriter::Compact() on a classfile parsed with its
+ * debug attributes stripped, which leaves their names and the names of
+ * local variables unreferenced: the time a parse + compaction takes, the
+ * size of the serialized class with and without compaction and the time it
+ * takes to parse either. Every variant is run <iterations> times.
+ */
+
+#include <ClassFile/ClassFile.hpp>
+#include <ClassFile/ConstantPoolRewriter.hpp>
+#include <ClassFile/Parser.hpp>
+#include <ClassFile/Serializer.hpp>
+
+#include <iostream>
+#include <fstream>
+#include <chrono>
+#include <iterator>
+#include <string>
+#include <vector>
+
+using Clock = std::chrono::high_resolution_clock;
+
+static double Seconds(Clock::time_point before, Clock::time_point after)
+{
+  return std::chrono::duration_cast<std::chrono::nanoseconds>(after-before).count() / 1e9;
+}
+
+static void Report(std::string_view name, size_t iterations, double seconds)
+{
+  std::cout << name << ": " << iterations << " classes in ~" << seconds * 1000.0 << " milliseconds ("
+    << seconds / iterations * 1e6 << " microseconds per class)\n";
+}
+
+static bool Parse(const std::vector<ClassFile::U8>& bytes, size_t iterations)
+{
+  for(size_t i = 0; i < iterations; i++)
+  {
+    if(ClassFile::Parser::ParseClassFile(bytes.data(), bytes.size()).IsError())
+      return false;
+  }
+
+  return true;
+}
+
+int main(int argc, char** argv)
+{
+  if(argc < 2)
+  {
+    std::cout << "Usage: " << argv[0] << " <classfile> (iterations)\n";
+    return -1;
+  }
+
+  size_t iterations = argc > 2 ? std::stoul(argv[2]) : 10000;
+
+  std::ifstream infile{argv[1], std::ios::binary};
+
+  if(!infile.good())
+  {
+    std::cout << "Unable to open file \"" << argv[1] << "\"\n";
+    return -2;
+  }
+
+  std::vector<ClassFile::U8> contents{std::istreambuf_iterator<char>(infile), {}};
+
+  ClassFile::ParseOptions opts;
+  opts.Filter = ClassFile::AttributeFilter::StripDebug();
+
+  auto before = Clock::now();
+  for(size_t i = 0; i < iterations; i++)
+  {
+    if(ClassFile::Parser::ParseClassFile(contents.data(), contents.size(), opts).IsError())
+      return -3;
+  }
+  auto after = Clock::now();
+
+  Report("strip           ", iterations, Seconds(before, after));
+
+  before = Clock::now();
+  for(size_t i = 0; i < iterations; i++)
+  {
+    auto errOrClass = ClassFile::Parser::ParseClassFile(contents.data(), contents.size(), opts);
+
+    if(errOrClass.IsError() || ClassFile::ConstantPoolRewriter::Compact(errOrClass.Get()).IsError())
+      return -4;
+  }
+  after = Clock::now();
+
+  Report("strip + compact ", iterations, Seconds(before, after));
+
+  auto errOrClass = ClassFile::Parser::ParseClassFile(contents.data(), contents.size(), opts);
+  if(errOrClass.IsError())
+    return -3;
+
+  ClassFile::ClassFile& cf = errOrClass.Get();
+  ClassFile::U16 count = cf.ConstPool.GetCount();
+
+  auto errOrStripped = ClassFile::Serializer::SerializeClassFile(cf);
+  auto errOrRemoved = ClassFile::ConstantPoolRewriter::Compact(cf);
+
+  if(errOrStripped.IsError() || errOrRemoved.IsError())
+    return -4;
+
+  auto errOrCompacted = ClassFile::Serializer::SerializeClassFile(cf);
+  if(errOrCompacted.IsError())
+    return -4;
+
+  std::cout << "\nconstant_pool_count " << count << " -> " << cf.ConstPool.GetCount()
+    << ", class size " << contents.size() << " -> " << errOrStripped.Get().size()
+    << " (stripped) -> " << errOrCompacted.Get().size() << " (compacted) bytes\n\n";
+
+  before = Clock::now();
+  if(!Parse(contents, iterations))
+    return -5;
+  after = Clock::now();
+
+  Report("parse original  ", iterations, Seconds(before, after));
+
+  before = Clock::now();
+  if(!Parse(errOrStripped.Get(), iterations))
+    return -5;
+  after = Clock::now();
+
+  Report("parse stripped  ", iterations, Seconds(before, after));
+
+  before = Clock::now();
+  if(!Parse(errOrCompacted.Get(), iterations))
+    return -5;
+  after = Clock::now();
+
+  Report("parse compacted ", iterations, Seconds(before, after));
+}
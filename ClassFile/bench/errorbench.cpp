@@ -0,0 +1,93 @@
+/*
+ * Measures the cost of failure paths: LookupString & LookupDescriptor over
+ * every constant pool entry (most of which have no descriptor, some no
+ * name), the way readclass prints the pool, and parsing a truncated copy of
+ * the classfile. Every variant is run <iterations> times.
+ */
+
+#include <ClassFile/ClassFile.hpp>
+#include <ClassFile/Parser.hpp>
+
+#include <iostream>
+#include <fstream>
+#include <chrono>
+#include <iterator>
+#include <string>
+#include <vector>
+
+using Clock = std::chrono::high_resolution_clock;
+
+static double Seconds(Clock::time_point before, Clock::time_point after)
+{
+  return std::chrono::duration_cast<std::chrono::nanoseconds>(after-before).count() / 1e9;
+}
+
+static void Report(std::string_view name, size_t count, size_t errors, double seconds)
+{
+  std::cout << name << ": " << count << " calls, " << errors << " errors in ~"
+    << seconds * 1000.0 << " milliseconds (" << seconds / count * 1e9 << " ns per call)\n";
+}
+
+int main(int argc, char** argv)
+{
+  if(argc < 2)
+  {
+    std::cout << "Usage: " << argv[0] << " <classfile> (iterations)\n";
+    return -1;
+  }
+
+  size_t iterations = argc > 2 ? std::stoul(argv[2]) : 10000;
+
+  std::ifstream infile{argv[1], std::ios::binary};
+
+  if(!infile.good())
+  {
+    std::cout << "Unable to open file \"" << argv[1] << "\"\n";
+    return -2;
+  }
+
+  std::vector<ClassFile::U8> contents{std::istreambuf_iterator<char>(infile), {}};
+
+  auto errOrClass = ClassFile::Parser::ParseClassFile(contents.data(), contents.size());
+
+  if(errOrClass.IsError())
+  {
+    std::cout << "Failed to parse \"" << argv[1] << "\"\n";
+    return -3;
+  }
+
+  const ClassFile::ConstantPool& cp = errOrClass.Get().ConstPool;
+
+  size_t calls{0}, errors{0};
+  auto before = Clock::now();
+  for(size_t i = 0; i < iterations; i++)
+  {
+    for(ClassFile::U16 index = 1; index < cp.GetCount(); index++)
+    {
+      if(cp[index] == nullptr)
+        continue;
+
+      errors += cp.LookupString(index).IsError();
+      errors += cp.LookupDescriptor(index).IsError();
+      calls += 2;
+    }
+  }
+  auto after = Clock::now();
+
+  Report("lookups         ", calls, errors, Seconds(before, after));
+
+  //cut in the middle of the constant pool, so the error is raised a few
+  //frames deep
+  size_t truncated = std::min<size_t>(contents.size(), 64);
+
+  calls = errors = 0;
+  before = Clock::now();
+  for(size_t i = 0; i < iterations; i++)
+  {
+    errors += ClassFile::Parser::ParseClassFile(contents.data(), truncated).IsError();
+    calls++;
+  }
+  after = Clock::now();
+
+  Report("truncated parse ", calls, errors, Seconds(before, after));
+}
@@ -0,0 +1,123 @@
+/*
+ * Compares parsing a classfile from memory with every attribute kept to
+ * parsing it with AttributeFilter::StripDebug(): global heap allocations,
+ * bytes allocated and time per parse, and the size of the serialized class.
+ */
+
+#include <ClassFile/ClassFile.hpp>
+#include <ClassFile/Parser.hpp>
+#include <ClassFile/Serializer.hpp>
+
+#include <iostream>
+#include <fstream>
+#include <chrono>
+#include <cstdlib>
+#include <iterator>
+#include <new>
+#include <vector>
+
+static size_t AllocationCount{0};
+static size_t AllocatedBytes{0};
+
+void* operator new(std::size_t size)
+{
+  AllocationCount++;
+  AllocatedBytes += size;
+
+  if(void* ptr = std::malloc(size))
+    return ptr;
+
+  throw std::bad_alloc{};
+}
+
+//std::pmr::new_delete_resource() allocates through the aligned overloads
+void* operator new(std::size_t size, std::align_val_t align)
+{
+  AllocationCount++;
+  AllocatedBytes += size;
+
+  size_t alignment = static_cast<size_t>(align);
+  size = (size + alignment - 1) & ~(alignment - 1);
+
+  if(void* ptr = std::aligned_alloc(alignment, size))
+    return ptr;
+
+  throw std::bad_alloc{};
+}
+
+void operator delete(void* ptr) noexcept { std::free(ptr); }
+void operator delete(void* ptr, std::size_t) noexcept { std::free(ptr); }
+void operator delete(void* ptr, std::align_val_t) noexcept { std::free(ptr); }
+void operator delete(void* ptr, std::size_t, std::align_val_t) noexcept { std::free(ptr); }
+
+using Clock = std::chrono::high_resolution_clock;
+
+static bool Run(std::string_view name, size_t iterations, const std::vector<ClassFile::U8>& contents,
+    const ClassFile::ParseOptions& opts)
+{
+  size_t countBefore = AllocationCount;
+  size_t bytesBefore = AllocatedBytes;
+  auto before = Clock::now();
+
+  for(size_t i = 0; i < iterations; i++)
+  {
+    auto errOrClass = ClassFile::Parser::ParseClassFile(contents.data(), contents.size(), opts);
+
+    if(errOrClass.IsError())
+    {
+      std::cout << "PARSING ERROR: " << errOrClass.GetError().Message() << '\n';
+      return false;
+    }
+  }
+
+  auto after = Clock::now();
+  size_t allocations = AllocationCount - countBefore;
+  size_t bytes = AllocatedBytes - bytesBefore;
+
+  auto errOrClass = ClassFile::Parser::ParseClassFile(contents.data(), contents.size(), opts);
+  auto errOrSize = ClassFile::Serializer::GetSerializedSize(errOrClass.Get());
+
+  if(errOrSize.IsError())
+  {
+    std::cout << "SERIALIZATION ERROR: " << errOrSize.GetError().Message() << '\n';
+    return false;
+  }
+
+  std::cout << name << ": " << allocations / iterations << " allocations/parse, "
+    << bytes / iterations << " bytes/parse, ~"
+    << std::chrono::duration_cast<std::chrono::nanoseconds>(after-before).count() / 1000.0 / iterations
+    << " microseconds/parse, serialized to " << errOrSize.Get() << " bytes\n";
+
+  return true;
+}
+
+int main(int argc, char** argv)
+{
+  if(argc < 2)
+  {
+    std::cout << "Usage: " << argv[0] << " <classfile> (iterations)\n";
+    return -1;
+  }
+
+  size_t iterations = argc > 2 ? std::stoul(argv[2]) : 10000;
+
+  std::ifstream infile{argv[1], std::ios::binary};
+
+  if(!infile.good())
+  {
+    std::cout << "Unable to open file \"" << argv[1] << "\"\n";
+    return -2;
+  }
+
+  std::vector<ClassFile::U8> contents{std::istreambuf_iterator<char>(infile), {}};
+  std::cout << "input: " << contents.size() << " bytes\n";
+
+  ClassFile::ParseOptions stripped;
+  stripped.Filter = ClassFile::AttributeFilter::StripDebug();
+
+  if(!Run("all attributes", iterations, contents, {}) ||
+     !Run("strip debug   ", iterations, contents, stripped))
+  {
+    return -3;
+  }
+}
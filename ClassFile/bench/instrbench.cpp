@@ -0,0 +1,65 @@
+/*
+ * Microbenchmarks Instruction metadata and operand access: GetLength() and 
+ * GetOperand() over one instruction of every non-complex opcode.
+ */
+
+#include <ClassFile/Instruction.hpp>
+
+#include <iostream>
+#include <chrono>
+#include <vector>
+#include <string>
+
+using Clock = std::chrono::high_resolution_clock;
+using ClassFile::Instruction;
+
+template <typename Func>
+static void Run(std::string_view name, size_t calls, Func&& func)
+{
+  auto before = Clock::now();
+  size_t sink = func();
+  auto after = Clock::now();
+
+  std::cout << name << ": ~" 
+    << std::chrono::duration_cast<std::chrono::nanoseconds>(after-before).count() / static_cast<double>(calls)
+    << " nanoseconds/call (" << sink << ")\n";
+}
+
+int main(int argc, char** argv)
+{
+  size_t iterations = argc > 1 ? std::stoul(argv[1]) : 100000;
+
+  std::vector<Instruction> instrs;
+  for(int op = 0; op < Instruction::Opcode::_N; op++)
+  {
+    auto opcode = static_cast<Instruction::Opcode>(op);
+
+    if(!Instruction::IsComplex(opcode))
+      instrs.emplace_back(Instruction::MakeInstruction(opcode).Release());
+  }
+
+  size_t operands{0};
+  for(const auto& instr : instrs)
+    operands += instr.GetNOperands();
+
+  Run("GetLength ", iterations * instrs.size(), [&]()
+  {
+    size_t total{0};
+    for(size_t i = 0; i < iterations; i++)
+      for(const auto& instr : instrs)
+        total += instr.GetLength();
+
+    return total;
+  });
+
+  Run("GetOperand", iterations * operands, [&]()
+  {
+    size_t total{0};
+    for(size_t i = 0; i < iterations; i++)
+      for(const auto& instr : instrs)
+        for(size_t j = 0; j < instr.GetNOperands(); j++)
+          total += instr.GetOperand(j).Get();
+
+    return total;
+  });
+}
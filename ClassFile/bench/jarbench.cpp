@@ -0,0 +1,74 @@
+/*
+ * Measures end-to-end JAR ingestion: opening the archive, inflating every 
+ * ".class" entry and parsing it, with 1, 2, 4, ... up to <threads> workers
+ * (defaults to the number of hardware threads).
+ */
+
+#include <ClassFile/BatchParser.hpp>
+#include <ClassFile/ZipArchive.hpp>
+
+#include <iostream>
+#include <chrono>
+#include <string>
+#include <thread>
+
+using Clock = std::chrono::high_resolution_clock;
+
+static double Seconds(Clock::time_point before, Clock::time_point after)
+{
+  return std::chrono::duration_cast<std::chrono::nanoseconds>(after-before).count() / 1e9;
+}
+
+int main(int argc, char** argv)
+{
+  if(argc < 2)
+  {
+    std::cout << "Usage: " << argv[0] << " <jar> (threads)\n";
+    return -1;
+  }
+
+  unsigned maxThreads = argc > 2 ? std::stoul(argv[2]) : std::thread::hardware_concurrency();
+
+  auto errOrArchive = ClassFile::ZipArchive::Open(argv[1]);
+
+  if(errOrArchive.IsError())
+  {
+    std::cout << "Failed to open \"" << argv[1] << "\": " << errOrArchive.GetError().Message() << '\n';
+    return -2;
+  }
+
+  const ClassFile::ZipArchive& archive = errOrArchive.Get();
+
+  size_t uncompressed{0};
+  for(const auto& entry : archive.GetEntries())
+    uncompressed += entry.UncompressedSize;
+
+  double baseline{0};
+
+  for(unsigned threads = 1; threads <= std::max(1u, maxThreads); threads *= 2)
+  {
+    ClassFile::BatchOptions opts;
+    opts.Threads = threads;
+
+    ClassFile::BatchParser parser{opts};
+
+    auto before = Clock::now();
+    auto result = parser.ParseArchive(archive);
+    auto after = Clock::now();
+
+    size_t failed{0};
+    for(auto& errOrClass : result)
+      failed += errOrClass.IsError();
+
+    double seconds = Seconds(before, after);
+
+    if(threads == 1)
+      baseline = seconds;
+
+    std::cout << threads << " thread(s): " << result.GetSize() << " classes (" << failed 
+      << " failed) in ~" << seconds * 1000.0 << " milliseconds (" 
+      << result.GetSize() / seconds << " classes/s, " 
+      << uncompressed / seconds / (1024.0 * 1024.0) << " MiB/s inflated, speedup x" 
+      << baseline / seconds << ")\n";
+  }
+}
@@ -0,0 +1,117 @@
+/*
+ * Measures ConstantPoolRewriter::PackLoadables(): the time a parse + packing
+ * takes compared to a plain parse, the number of ldc_w rewritten to ldc and
+ * the size of the bytecode and of the serialized class before and after.
+ * Every variant is run <iterations> times.
+ */
+
+#include <ClassFile/ClassFile.hpp>
+#include <ClassFile/ConstantPoolRewriter.hpp>
+#include <ClassFile/Parser.hpp>
+#include <ClassFile/Serializer.hpp>
+
+#include <iostream>
+#include <fstream>
+#include <chrono>
+#include <iterator>
+#include <string>
+#include <vector>
+
+using Clock = std::chrono::high_resolution_clock;
+
+static double Seconds(Clock::time_point before, Clock::time_point after)
+{
+  return std::chrono::duration_cast<std::chrono::nanoseconds>(after-before).count() / 1e9;
+}
+
+static void Report(std::string_view name, size_t iterations, double seconds)
+{
+  std::cout << name << ": " << iterations << " classes in ~" << seconds * 1000.0 << " milliseconds ("
+    << seconds / iterations * 1e6 << " microseconds per class)\n";
+}
+
+//Summed code_length of every decoded Code attribute
+static size_t CodeLength(const ClassFile::ClassFile& cf)
+{
+  size_t length{0};
+
+  for(const auto& method : cf.Methods)
+  {
+    for(const auto& pAttr : method.Attributes)
+    {
+      if(pAttr->GetType() != ClassFile::AttributeInfo::Type::Code)
+        continue;
+
+      const auto& code = static_cast<const ClassFile::CodeAttribute&>(*pAttr);
+      size_t offset{0};
+
+      for(const auto& instr : code.Code)
+        offset += instr.GetLength(offset, code.Switches);
+
+      length += offset;
+    }
+  }
+
+  return length;
+}
+
+int main(int argc, char** argv)
+{
+  if(argc < 2)
+  {
+    std::cout << "Usage: " << argv[0] << " <classfile> (iterations)\n";
+    return -1;
+  }
+
+  size_t iterations = argc > 2 ? std::stoul(argv[2]) : 10000;
+
+  std::ifstream infile{argv[1], std::ios::binary};
+
+  if(!infile.good())
+  {
+    std::cout << "Unable to open file \"" << argv[1] << "\"\n";
+    return -2;
+  }
+
+  std::vector<ClassFile::U8> contents{std::istreambuf_iterator<char>(infile), {}};
+
+  auto before = Clock::now();
+  for(size_t i = 0; i < iterations; i++)
+  {
+    if(ClassFile::Parser::ParseClassFile(contents.data(), contents.size()).IsError())
+      return -3;
+  }
+  auto after = Clock::now();
+
+  Report("parse        ", iterations, Seconds(before, after));
+
+  before = Clock::now();
+  for(size_t i = 0; i < iterations; i++)
+  {
+    auto errOrClass = ClassFile::Parser::ParseClassFile(contents.data(), contents.size());
+
+    if(errOrClass.IsError() || ClassFile::ConstantPoolRewriter::PackLoadables(errOrClass.Get()).IsError())
+      return -4;
+  }
+  after = Clock::now();
+
+  Report("parse + pack ", iterations, Seconds(before, after));
+
+  auto errOrClass = ClassFile::Parser::ParseClassFile(contents.data(), contents.size());
+  if(errOrClass.IsError())
+    return -3;
+
+  ClassFile::ClassFile& cf = errOrClass.Get();
+  size_t codeBefore = CodeLength(cf);
+
+  auto errOrShortened = ClassFile::ConstantPoolRewriter::PackLoadables(cf);
+  if(errOrShortened.IsError())
+    return -4;
+
+  auto errOrPacked = ClassFile::Serializer::SerializeClassFile(cf);
+  if(errOrPacked.IsError())
+    return -4;
+
+  std::cout << "\n" << errOrShortened.Get() << " ldc_w rewritten to ldc, code " << codeBefore << " -> "
+    << CodeLength(cf) << " bytes, class " << contents.size() << " -> " << errOrPacked.Get().size() << " bytes\n";
+}
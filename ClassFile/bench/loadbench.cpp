@@ -0,0 +1,100 @@
+/*
+ * Compares std::ifstream and memory-mapped loading throughput by writing 
+ * <copies> copies of a classfile into a scratch directory and parsing each of 
+ * them through both paths.
+ */
+
+#include <ClassFile/ClassFile.hpp>
+#include <ClassFile/Parser.hpp>
+#include <ClassFile/MappedClassFile.hpp>
+
+#include <iostream>
+#include <fstream>
+#include <chrono>
+#include <filesystem>
+#include <string>
+#include <vector>
+
+namespace fs = std::filesystem;
+using Clock = std::chrono::high_resolution_clock;
+
+static double Seconds(Clock::time_point before, Clock::time_point after)
+{
+  return std::chrono::duration_cast<std::chrono::nanoseconds>(after-before).count() / 1e9;
+}
+
+static void Report(std::string_view name, size_t files, size_t bytes, double seconds)
+{
+  std::cout << name << ": " << files << " files in ~" << seconds * 1000.0 << " milliseconds ("
+    << files / seconds << " files/s, " << bytes / seconds / (1024.0 * 1024.0) << " MiB/s)\n";
+}
+
+int main(int argc, char** argv)
+{
+  if(argc < 2)
+  {
+    std::cout << "Usage: " << argv[0] << " <classfile> (copies)\n";
+    return -1;
+  }
+
+  size_t copies = argc > 2 ? std::stoul(argv[2]) : 10000;
+
+  std::ifstream infile{argv[1], std::ios::binary};
+
+  if(!infile.good())
+  {
+    std::cout << "Unable to open file \"" << argv[1] << "\"\n";
+    return -2;
+  }
+
+  std::vector<char> contents{std::istreambuf_iterator<char>(infile), {}};
+
+  fs::path dir = fs::temp_directory_path() / "classfile-loadbench";
+  fs::create_directories(dir);
+
+  std::vector<std::string> paths;
+  paths.reserve(copies);
+
+  for(size_t i = 0; i < copies; i++)
+  {
+    paths.emplace_back( (dir / (std::to_string(i) + ".class")).string() );
+
+    std::ofstream out{paths.back(), std::ios::binary};
+    out.write(contents.data(), contents.size());
+  }
+
+  size_t totalBytes = contents.size() * copies;
+
+  auto before = Clock::now();
+  for(const auto& path : paths)
+  {
+    std::ifstream stream{path, std::ios::binary};
+    auto errOrClass = ClassFile::Parser::ParseClassFile(stream);
+
+    if(errOrClass.IsError())
+    {
+      std::cout << "PARSING ERROR: " << errOrClass.GetError().Message() << '\n';
+      return -3;
+    }
+  }
+  auto after = Clock::now();
+
+  Report("istream", copies, totalBytes, Seconds(before, after));
+
+  before = Clock::now();
+  for(const auto& path : paths)
+  {
+    auto errOrMapped = ClassFile::MappedClassFile::Load(path);
+
+    if(errOrMapped.IsError())
+    {
+      std::cout << "PARSING ERROR: " << errOrMapped.GetError().Message() << '\n';
+      return -3;
+    }
+  }
+  after = Clock::now();
+
+  Report("mmap   ", copies, totalBytes, Seconds(before, after));
+
+  fs::remove_all(dir);
+}
@@ -0,0 +1,145 @@
+/*
+ * Compares editing a classfile through ClassFilePatcher against a full
+ * parse, modify and serialize round trip. The edit renames the first UTF8
+ * constant, keeping its length for the in-place rows and growing it by one
+ * byte for the resizing row. Every variant is run <iterations> times.
+ */
+
+#include <ClassFile/ClassFile.hpp>
+#include <ClassFile/ClassFilePatcher.hpp>
+#include <ClassFile/Parser.hpp>
+#include <ClassFile/Serializer.hpp>
+
+#include <iostream>
+#include <fstream>
+#include <chrono>
+#include <iterator>
+#include <string>
+#include <vector>
+
+using Clock = std::chrono::high_resolution_clock;
+
+static double Seconds(Clock::time_point before, Clock::time_point after)
+{
+  return std::chrono::duration_cast<std::chrono::nanoseconds>(after-before).count() / 1e9;
+}
+
+static void Report(std::string_view name, size_t iterations, double seconds)
+{
+  std::cout << name << ": " << iterations << " edits in ~" << seconds * 1000.0 << " milliseconds ("
+    << seconds / iterations * 1e6 << " microseconds per edit)\n";
+}
+
+int main(int argc, char** argv)
+{
+  if(argc < 2)
+  {
+    std::cout << "Usage: " << argv[0] << " <classfile> (iterations)\n";
+    return -1;
+  }
+
+  size_t iterations = argc > 2 ? std::stoul(argv[2]) : 100000;
+
+  std::ifstream infile{argv[1], std::ios::binary};
+
+  if(!infile.good())
+  {
+    std::cout << "Unable to open file \"" << argv[1] << "\"\n";
+    return -2;
+  }
+
+  std::vector<ClassFile::U8> contents{std::istreambuf_iterator<char>(infile), {}};
+
+  auto errOrPatcher = ClassFile::ClassFilePatcher::Create(contents);
+
+  if(errOrPatcher.IsError())
+  {
+    std::cout << "Failed to index \"" << argv[1] << "\"\n" << errOrPatcher.GetError().Message() << '\n';
+    return -3;
+  }
+
+  auto& patcher = errOrPatcher.Get();
+
+  ClassFile::U16 index{0};
+  std::string original;
+
+  for(ClassFile::U16 i = 1; i < 0xFFFF; i++)
+  {
+    auto errOrType = patcher.GetConstantType(i);
+    if(errOrType.IsError())
+      break;
+
+    if(errOrType.Get() == ClassFile::CPInfo::Type::UTF8 && !patcher.GetUTF8(i).Get().empty())
+    {
+      index = i;
+      original = std::string{patcher.GetUTF8(i).Get()};
+      break;
+    }
+  }
+
+  if(index == 0)
+  {
+    std::cout << "No UTF8 constant to patch in \"" << argv[1] << "\"\n";
+    return -4;
+  }
+
+  std::string renamed = original;
+  renamed[0] = renamed[0] == '_' ? '$' : '_';
+  std::string grown = original + '_';
+
+  //patches an already indexed buffer
+  auto before = Clock::now();
+  for(size_t i = 0; i < iterations; i++)
+  {
+    if(patcher.SetUTF8(index, i % 2 ? original : renamed).IsError())
+      return -5;
+  }
+  auto after = Clock::now();
+
+  Report("patch           ", iterations, Seconds(before, after));
+
+  //index + patch, starting from a fresh copy of the bytes every time
+  before = Clock::now();
+  for(size_t i = 0; i < iterations; i++)
+  {
+    auto errOrFresh = ClassFile::ClassFilePatcher::Create(contents);
+
+    if(errOrFresh.IsError() || errOrFresh.Get().SetUTF8(index, renamed).IsError())
+      return -5;
+  }
+  after = Clock::now();
+
+  Report("index + patch   ", iterations, Seconds(before, after));
+
+  //size changing edit, reserialized by the patcher
+  before = Clock::now();
+  for(size_t i = 0; i < iterations; i++)
+  {
+    if(patcher.SetUTF8(index, i % 2 ? original : grown).IsError())
+      return -5;
+  }
+  after = Clock::now();
+
+  Report("patch (resize)  ", iterations, Seconds(before, after));
+
+  //parse, modify, serialize
+  before = Clock::now();
+  for(size_t i = 0; i < iterations; i++)
+  {
+    auto errOrClass = ClassFile::Parser::ParseClassFile(contents.data(), contents.size());
+    if(errOrClass.IsError())
+      return -6;
+
+    auto errOrUTF8 = errOrClass.Get().ConstPool.Get<ClassFile::UTF8Info>(index);
+    if(errOrUTF8.IsError())
+      return -6;
+
+    errOrUTF8.Get()->SetString(renamed);
+
+    if(ClassFile::Serializer::SerializeClassFile(errOrClass.Get()).IsError())
+      return -6;
+  }
+  after = Clock::now();
+
+  Report("parse+serialize ", iterations, Seconds(before, after));
+}
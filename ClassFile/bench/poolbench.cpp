@@ -0,0 +1,130 @@
+/*
+ * Compares LookupString & LookupDescriptor over every constant pool entry,
+ * the way readclass prints the pool, on the parsed ConstantPool and on a
+ * FlatConstantPool made from it. Also times flattening the pool. Every
+ * variant is run <iterations> times, both pools have to agree on every
+ * lookup.
+ */
+
+#include <ClassFile/ClassFile.hpp>
+#include <ClassFile/Parser.hpp>
+#include <ClassFile/FlatConstantPool.hpp>
+
+#include <iostream>
+#include <fstream>
+#include <chrono>
+#include <iterator>
+#include <string>
+#include <vector>
+
+using Clock = std::chrono::high_resolution_clock;
+
+static double Seconds(Clock::time_point before, Clock::time_point after)
+{
+  return std::chrono::duration_cast<std::chrono::nanoseconds>(after-before).count() / 1e9;
+}
+
+static void Report(std::string_view name, size_t count, double seconds)
+{
+  std::cout << name << ": " << count << " calls in ~" << seconds * 1000.0
+    << " milliseconds (" << seconds / count * 1e9 << " ns per call)\n";
+}
+
+//Sums the lengths of the resolved strings so the lookups can't be dropped
+template <typename Pool>
+static size_t LookupAll(const Pool& pool, ClassFile::U16 count, size_t& calls)
+{
+  size_t chars{0};
+
+  for(ClassFile::U16 index = 1; index < count; index++)
+  {
+    if(pool[index] == nullptr)
+      continue;
+
+    auto errOrString = pool.LookupString(index);
+    auto errOrDesc = pool.LookupDescriptor(index);
+
+    chars += errOrString.IsError() ? 0 : errOrString.Get().size();
+    chars += errOrDesc.IsError() ? 0 : errOrDesc.Get().size();
+    calls += 2;
+  }
+
+  return chars;
+}
+
+int main(int argc, char** argv)
+{
+  if(argc < 2)
+  {
+    std::cout << "Usage: " << argv[0] << " <classfile> (iterations)\n";
+    return -1;
+  }
+
+  size_t iterations = argc > 2 ? std::stoul(argv[2]) : 10000;
+
+  std::ifstream infile{argv[1], std::ios::binary};
+
+  if(!infile.good())
+  {
+    std::cout << "Unable to open file \"" << argv[1] << "\"\n";
+    return -2;
+  }
+
+  std::vector<ClassFile::U8> contents{std::istreambuf_iterator<char>(infile), {}};
+
+  auto errOrClass = ClassFile::Parser::ParseClassFile(contents.data(), contents.size());
+
+  if(errOrClass.IsError())
+  {
+    std::cout << "Failed to parse \"" << argv[1] << "\"\n";
+    return -3;
+  }
+
+  const ClassFile::ConstantPool& cp = errOrClass.Get().ConstPool;
+  ClassFile::FlatConstantPool flat{cp};
+
+  for(ClassFile::U16 index = 1; index < cp.GetCount(); index++)
+  {
+    auto string = cp.LookupString(index), flatString = flat.LookupString(index);
+    auto desc = cp.LookupDescriptor(index), flatDesc = flat.LookupDescriptor(index);
+
+    bool same = string.IsError() == flatString.IsError() && desc.IsError() == flatDesc.IsError() &&
+      (string.IsError() || string.Get() == flatString.Get()) && (desc.IsError() || desc.Get() == flatDesc.Get());
+
+    if(!same || (cp[index] == nullptr) != (flat[index] == nullptr))
+    {
+      std::cout << "ERROR: pools disagree on entry " << index << '\n';
+      return -4;
+    }
+  }
+
+  size_t calls{0}, chars{0};
+  auto before = Clock::now();
+  for(size_t i = 0; i < iterations; i++)
+    chars += LookupAll(cp, cp.GetCount(), calls);
+  auto after = Clock::now();
+
+  Report("ConstantPool     ", calls, Seconds(before, after));
+
+  size_t flatCalls{0}, flatChars{0};
+  before = Clock::now();
+  for(size_t i = 0; i < iterations; i++)
+    flatChars += LookupAll(flat, flat.GetCount(), flatCalls);
+  after = Clock::now();
+
+  Report("FlatConstantPool ", flatCalls, Seconds(before, after));
+
+  size_t entries{0};
+  before = Clock::now();
+  for(size_t i = 0; i < iterations; i++)
+    entries += ClassFile::FlatConstantPool{cp}.GetCount();
+  after = Clock::now();
+
+  std::cout << "flattening       : " << iterations << " pools of " << cp.GetCount() << " entries in ~"
+    << Seconds(before, after) * 1000.0 << " milliseconds (" << Seconds(before, after) / iterations * 1e6
+    << " microseconds per pool)\n";
+
+  //keeps the results alive
+  if(chars != flatChars || entries == 0)
+    return -5;
+}
@@ -0,0 +1,121 @@
+/*
+ * Compares serialization throughput of the std::ostream path, the 
+ * exact-size buffer path and the buffer path over a classfile parsed with
+ * ParseOptions::RetainSource (clean fields, methods and attributes copied 
+ * verbatim) by serializing the same classfile <iterations> times through each.
+ */
+
+#include <ClassFile/ClassFile.hpp>
+#include <ClassFile/Parser.hpp>
+#include <ClassFile/Serializer.hpp>
+
+#include <iostream>
+#include <fstream>
+#include <sstream>
+#include <chrono>
+#include <iterator>
+#include <string>
+#include <vector>
+
+using Clock = std::chrono::high_resolution_clock;
+
+static double Seconds(Clock::time_point before, Clock::time_point after)
+{
+  return std::chrono::duration_cast<std::chrono::nanoseconds>(after-before).count() / 1e9;
+}
+
+static void Report(std::string_view name, size_t iterations, size_t bytes, double seconds)
+{
+  std::cout << name << ": " << iterations << " classfiles in ~" << seconds * 1000.0 << " milliseconds ("
+    << bytes / seconds << " bytes/s, " << bytes / seconds / (1024.0 * 1024.0) << " MiB/s)\n";
+}
+
+int main(int argc, char** argv)
+{
+  if(argc < 2)
+  {
+    std::cout << "Usage: " << argv[0] << " <classfile> (iterations)\n";
+    return -1;
+  }
+
+  size_t iterations = argc > 2 ? std::stoul(argv[2]) : 100000;
+
+  std::ifstream infile{argv[1], std::ios::binary};
+
+  if(!infile.good())
+  {
+    std::cout << "Unable to open file \"" << argv[1] << "\"\n";
+    return -2;
+  }
+
+  std::vector<ClassFile::U8> contents{std::istreambuf_iterator<char>(infile), {}};
+
+  auto errOrClass = ClassFile::Parser::ParseClassFile(contents.data(), contents.size(), 
+      ClassFile::ParseOptions{});
+
+  ClassFile::ParseOptions retainOpts;
+  retainOpts.RetainSource = true;
+
+  auto errOrRetained = ClassFile::Parser::ParseClassFile(contents.data(), contents.size(), retainOpts);
+
+  if(errOrClass.IsError() || errOrRetained.IsError())
+  {
+    std::cout << "Failed to parse \"" << argv[1] << "\"\n";
+    return -3;
+  }
+
+  const ClassFile::ClassFile& cf = errOrClass.Get();
+  const ClassFile::ClassFile& retained = errOrRetained.Get();
+
+  size_t streamBytes{0};
+  auto before = Clock::now();
+  for(size_t i = 0; i < iterations; i++)
+  {
+    std::ostringstream out{std::ios::binary};
+
+    if(ClassFile::Serializer::SerializeClassFile(out, cf).IsError())
+      return -4;
+
+    streamBytes += static_cast<size_t>(out.tellp());
+  }
+  auto after = Clock::now();
+
+  Report("ostream ", iterations, streamBytes, Seconds(before, after));
+
+  size_t bufferBytes{0};
+  before = Clock::now();
+  for(size_t i = 0; i < iterations; i++)
+  {
+    auto errOrBytes = ClassFile::Serializer::SerializeClassFile(cf);
+
+    if(errOrBytes.IsError())
+      return -5;
+
+    bufferBytes += errOrBytes.Get().size();
+  }
+  after = Clock::now();
+
+  Report("buffer  ", iterations, bufferBytes, Seconds(before, after));
+
+  size_t retainedBytes{0};
+  before = Clock::now();
+  for(size_t i = 0; i < iterations; i++)
+  {
+    auto errOrBytes = ClassFile::Serializer::SerializeClassFile(retained);
+
+    if(errOrBytes.IsError())
+      return -5;
+
+    retainedBytes += errOrBytes.Get().size();
+  }
+  after = Clock::now();
+
+  Report("retained", iterations, retainedBytes, Seconds(before, after));
+
+  if(streamBytes != bufferBytes || bufferBytes != retainedBytes)
+  {
+    std::cout << "Size mismatch between paths: " << streamBytes << " vs " << bufferBytes 
+      << " vs " << retainedBytes << '\n';
+    return -6;
+  }
+}
@@ -0,0 +1,167 @@
+/*
+ * Decoding & encoding throughput of a switch heavy code array: a synthesized
+ * method body where every few plain instructions are followed by a 
+ * tableswitch, a lookupswitch or a wide load/iinc, with switches landing at
+ * every alignment. Measures Instruction::Decode(), Instruction::Encode() and
+ * the length only walk of Instruction::GetEncodedLength() over the array,
+ * each run <iterations> times.
+ */
+
+#include <ClassFile/Instruction.hpp>
+
+#include <iostream>
+#include <chrono>
+#include <string>
+#include <vector>
+
+using Clock = std::chrono::high_resolution_clock;
+using ClassFile::U8;
+using ClassFile::S32;
+using Opcode = ClassFile::Instruction::Opcode;
+
+static double Seconds(Clock::time_point before, Clock::time_point after)
+{
+  return std::chrono::duration_cast<std::chrono::nanoseconds>(after-before).count() / 1e9;
+}
+
+static void Report(std::string_view name, size_t instructions, size_t bytes, double seconds)
+{
+  std::cout << name << ": " << instructions << " instructions in ~" << seconds * 1000.0 
+    << " milliseconds (" << seconds / instructions * 1e9 << " ns per instruction, "
+    << bytes / seconds / (1024.0 * 1024.0) << " MiB/s)\n";
+}
+
+static void Push32(std::vector<U8>& code, S32 value)
+{
+  for(int shift = 24; shift >= 0; shift -= 8)
+    code.push_back(static_cast<U8>(value >> shift));
+}
+
+static void PushSwitch(std::vector<U8>& code, Opcode op, S32 entries)
+{
+  code.push_back(op);
+
+  while(code.size() % 4 != 0)
+    code.push_back(0);
+
+  Push32(code, 64); //default
+
+  if(op == Opcode::TABLESWITCH)
+  {
+    Push32(code, -entries / 2);
+    Push32(code, -entries / 2 + entries - 1);
+
+    for(S32 i = 0; i < entries; i++)
+      Push32(code, 8 * i);
+  }
+  else
+  {
+    Push32(code, entries);
+
+    for(S32 i = 0; i < entries; i++)
+    {
+      Push32(code, i * 37 - 100);
+      Push32(code, 8 * i);
+    }
+  }
+}
+
+static std::vector<U8> MakeCode(size_t blocks)
+{
+  std::vector<U8> code;
+
+  for(size_t i = 0; i < blocks; i++)
+  {
+    //plain instructions of every encoding, shifting the next switch's alignment
+    for(size_t j = 0; j < i % 4; j++)
+      code.push_back(Opcode::NOP);
+
+    code.insert(code.end(), {Opcode::ILOAD, 4, Opcode::SIPUSH, 0x12, 0x34, Opcode::IADD});
+    code.insert(code.end(), {Opcode::INVOKESTATIC, 0x00, 0x10, Opcode::GOTO_W, 0, 0, 1, 0});
+
+    switch(i % 3)
+    {
+      case 0: PushSwitch(code, Opcode::TABLESWITCH, 8); break;
+      case 1: PushSwitch(code, Opcode::LOOKUPSWITCH, 6); break;
+      case 2: code.insert(code.end(), {Opcode::WIDE, Opcode::ILOAD, 0x01, 0x00, 
+                                       Opcode::WIDE, Opcode::IINC, 0x01, 0x00, 0xFF, 0xFE}); break;
+    }
+  }
+
+  return code;
+}
+
+int main(int argc, char** argv)
+{
+  size_t iterations = argc > 1 ? std::stoul(argv[1]) : 2000;
+
+  std::vector<U8> code = MakeCode(600);
+
+  std::vector<ClassFile::Instruction> instrs;
+  std::vector<ClassFile::SwitchTable> switches;
+  size_t decoded{0};
+
+  auto before = Clock::now();
+  for(size_t i = 0; i < iterations; i++)
+  {
+    instrs.clear();
+    switches.clear();
+
+    for(size_t offset = 0; offset < code.size();)
+    {
+      size_t length;
+      auto errOrInstr = ClassFile::Instruction::Decode(code.data(), code.size(), offset, switches, length);
+
+      if(errOrInstr.IsError())
+      {
+        std::cout << "Failed to decode:\n" << errOrInstr.GetError().Message() << '\n';
+        return -1;
+      }
+
+      instrs.push_back(errOrInstr.Get());
+      offset += length;
+    }
+
+    decoded += instrs.size();
+  }
+  auto after = Clock::now();
+
+  Report("decode  ", decoded, code.size() * iterations, Seconds(before, after));
+
+  size_t walked{0};
+
+  before = Clock::now();
+  for(size_t i = 0; i < iterations; i++)
+  {
+    for(size_t offset = 0; offset < code.size(); walked++)
+      offset += ClassFile::Instruction::GetEncodedLength(code.data(), code.size(), offset).Get();
+  }
+  after = Clock::now();
+
+  Report("walk    ", walked, code.size() * iterations, Seconds(before, after));
+
+  std::vector<U8> encoded(code.size());
+
+  before = Clock::now();
+  for(size_t i = 0; i < iterations; i++)
+  {
+    size_t offset{0};
+
+    for(const auto& instr : instrs)
+    {
+      if(instr.Encode(encoded.data() + offset, offset, switches).IsError())
+        return -2;
+
+      offset += instr.GetLength(offset, switches);
+    }
+  }
+  after = Clock::now();
+
+  Report("encode  ", decoded, code.size() * iterations, Seconds(before, after));
+
+  if(encoded != code)
+  {
+    std::cout << "Encoded code array differs from the decoded one\n";
+    return -3;
+  }
+}
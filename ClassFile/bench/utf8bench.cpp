@@ -0,0 +1,145 @@
+/*
+ * Throughput of the ModifiedUTF8 validation & conversions over synthesized
+ * strings: long pure ASCII strings (the common case for names, descriptors
+ * and most string literals), mostly ASCII text with an occasional accented
+ * character or NUL, and CJK text without any ASCII. Also measures the cost 
+ * of ParseOptions::ValidateUTF8 when parsing <classfile>. Every variant is 
+ * run <iterations> times.
+ */
+
+#include <ClassFile/ClassFile.hpp>
+#include <ClassFile/ModifiedUTF8.hpp>
+#include <ClassFile/Parser.hpp>
+
+#include <iostream>
+#include <fstream>
+#include <chrono>
+#include <iterator>
+#include <string>
+#include <vector>
+
+using Clock = std::chrono::high_resolution_clock;
+using ClassFile::ModifiedUTF8;
+
+static double Seconds(Clock::time_point before, Clock::time_point after)
+{
+  return std::chrono::duration_cast<std::chrono::nanoseconds>(after-before).count() / 1e9;
+}
+
+static void Report(std::string_view name, size_t bytes, double seconds)
+{
+  std::cout << name << ": " << bytes << " bytes in ~" << seconds * 1000.0 
+    << " milliseconds (" << bytes / seconds / (1024.0 * 1024.0) << " MiB/s)\n";
+}
+
+template <typename Func>
+static void Run(std::string_view name, const std::vector<std::string>& strings, 
+    size_t iterations, Func&& func)
+{
+  size_t bytes{0}, sink{0};
+
+  auto before = Clock::now();
+  for(size_t i = 0; i < iterations; i++)
+  {
+    for(const auto& str : strings)
+    {
+      sink += func(str);
+      bytes += str.size();
+    }
+  }
+  auto after = Clock::now();
+
+  if(sink == static_cast<size_t>(-1))
+    std::cout << sink;
+
+  Report(name, bytes, Seconds(before, after));
+}
+
+static void RunAll(std::string_view set, const std::vector<std::string>& strings, size_t iterations)
+{
+  std::vector<std::u16string> utf16;
+  for(const auto& str : strings)
+    utf16.push_back(ModifiedUTF8::ToUTF16(str).Get());
+
+  std::cout << set << ":\n";
+
+  Run("  validate  ", strings, iterations, [](const std::string& str) 
+      { return ModifiedUTF8::Validate(str).IsError(); });
+
+  Run("  to UTF-16 ", strings, iterations, [](const std::string& str) 
+      { return ModifiedUTF8::ToUTF16(str).Get().size(); });
+
+  Run("  to UTF-8  ", strings, iterations, [](const std::string& str) 
+      { return ModifiedUTF8::ToUTF8(str).Get().size(); });
+
+  size_t next{0};
+  Run("  from UTF-16", strings, iterations, [&](const std::string&) 
+      { return ModifiedUTF8::FromUTF16(utf16[next++ % utf16.size()]).size(); });
+}
+
+int main(int argc, char** argv)
+{
+  if(argc < 2)
+  {
+    std::cout << "Usage: " << argv[0] << " <classfile> (iterations)\n";
+    return -1;
+  }
+
+  size_t iterations = argc > 2 ? std::stoul(argv[2]) : 2000;
+
+  std::vector<std::string> ascii, mixed, cjk;
+
+  for(size_t i = 0; i < 64; i++)
+  {
+    std::string a, m, c;
+
+    for(size_t j = 0; j < 64 + i * 4; j++)
+    {
+      char ch = static_cast<char>('a' + (i + j) % 26);
+
+      a += ch;
+      m += ch;
+      c += "\xE6\x96\x87"; //U+6587
+
+      if(j % 61 == 60)
+        m += "\xC3\xA9"; //U+00E9
+      if(j % 97 == 96)
+        m += "\xC0\x80";
+    }
+
+    ascii.push_back(a);
+    mixed.push_back(m);
+    cjk.push_back(c);
+  }
+
+  RunAll("ascii", ascii, iterations);
+  RunAll("mixed", mixed, iterations);
+  RunAll("cjk  ", cjk, iterations);
+
+  std::ifstream infile{argv[1], std::ios::binary};
+
+  if(!infile.good())
+  {
+    std::cout << "Unable to open file \"" << argv[1] << "\"\n";
+    return -2;
+  }
+
+  std::vector<ClassFile::U8> contents{std::istreambuf_iterator<char>(infile), {}};
+
+  for(bool validate : {false, true})
+  {
+    ClassFile::ParseOptions opts;
+    opts.ValidateUTF8 = validate;
+
+    auto before = Clock::now();
+    for(size_t i = 0; i < iterations; i++)
+    {
+      if(ClassFile::Parser::ParseClassFile(contents.data(), contents.size(), opts).IsError())
+        return -3;
+    }
+    auto after = Clock::now();
+
+    Report(validate ? "parse, validated" : "parse           ", contents.size() * iterations, 
+        Seconds(before, after));
+  }
+}
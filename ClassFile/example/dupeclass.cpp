@@ -5,6 +5,7 @@
 #include <ClassFile/ClassFile.hpp>
 #include <ClassFile/Parser.hpp>
 #include <ClassFile/Serializer.hpp>
+#include <ClassFile/MappedClassFile.hpp>
 
 #include <iostream>
 #include <fstream>
@@ -18,31 +19,21 @@ int main(int argc, char** argv)
     return -1;
   }
 
-  std::ifstream infile{argv[1], std::ios::ate};
-
-  if(!infile.good())
-  {
-    std::cout << "Unable to open file \"" << argv[1] << "\"\n";
-    return -2;
-  }
-
-  size_t fileSize = infile.tellg();
-  infile.seekg(0);
-
   auto before = std::chrono::high_resolution_clock::now();
-  auto errOrClass = ClassFile::Parser::ParseClassFile(infile);
+  auto errOrClass = ClassFile::MappedClassFile::Load(argv[1]);
   auto after = std::chrono::high_resolution_clock::now();
 
   if(errOrClass.IsError())
   {
-    std::cout << "PARSING ERROR: " << errOrClass.GetError().What << '\n';
+    std::cout << "PARSING ERROR: " << errOrClass.GetError().Message() << '\n';
     return -3;
   }
 
-  std::cout << "Parsed " << infile.tellg() << '/' << fileSize << " bytes ";
+  std::cout << "Parsed " << errOrClass.Get().GetBytes().Size << " bytes ";
   std::cout << "in ~" << std::chrono::duration_cast<std::chrono::nanoseconds>(after-before).count() / 1000000.0f << " milliseconds\n";
 
-  ClassFile::ClassFile cf = errOrClass.Release();
+  ClassFile::MappedClassFile mapped = errOrClass.Release();
+  const ClassFile::ClassFile& cf = mapped.Get();
 
   std::ofstream outfile{"dupe.class"};
 
@@ -58,7 +49,7 @@ int main(int argc, char** argv)
 
   if(err.IsError())
   {
-    std::cout << "SERIALIZATION ERROR: " << err.GetError().What << '\n';
+    std::cout << "SERIALIZATION ERROR: " << err.GetError().Message() << '\n';
     return -5;
   }
 
@@ -0,0 +1,121 @@
+/*
+ * Checks ZipArchive against a known archive: every entry must extract (which
+ * verifies its CRC-32), every entry named like <classfile> must inflate to
+ * exactly its bytes and parse through BatchParser::ParseArchive(), and
+ * entries claiming impossible or oversized uncompressed sizes must be refused.
+ * example/foo.jar holds example/foo.class deflated at two levels and stored.
+ */
+
+#include <ClassFile/BatchParser.hpp>
+#include <ClassFile/ZipArchive.hpp>
+
+#include <iostream>
+#include <fstream>
+#include <iterator>
+#include <string>
+#include <string_view>
+#include <vector>
+
+static int Failures{0};
+
+static void Check(bool condition, std::string_view what)
+{
+  if(condition)
+    return;
+
+  std::cout << "FAILED: " << what << '\n';
+  Failures++;
+}
+
+static bool EndsWith(std::string_view str, std::string_view suffix)
+{
+  return str.size() >= suffix.size() && str.compare(str.size() - suffix.size(), suffix.size(), suffix) == 0;
+}
+
+int main(int argc, char** argv)
+{
+  if(argc < 3)
+  {
+    std::cout << "Usage: " << argv[0] << " <jar> <classfile>\n";
+    return -1;
+  }
+
+  std::ifstream infile{argv[2], std::ios::binary};
+
+  if(!infile.good())
+  {
+    std::cout << "Unable to open file \"" << argv[2] << "\"\n";
+    return -2;
+  }
+
+  std::vector<ClassFile::U8> expected{std::istreambuf_iterator<char>(infile), {}};
+
+  std::string_view className = argv[2];
+  className = className.substr(className.find_last_of('/') + 1);
+
+  auto errOrArchive = ClassFile::ZipArchive::Open(argv[1]);
+
+  if(errOrArchive.IsError())
+  {
+    std::cout << "Failed to open \"" << argv[1] << "\": " << errOrArchive.GetError().Message() << '\n';
+    return -2;
+  }
+
+  ClassFile::ZipArchive& archive = errOrArchive.Get();
+  size_t matches{0};
+
+  for(const auto& entry : archive.GetEntries())
+  {
+    auto errOrBytes = archive.Extract(entry);
+
+    if(errOrBytes.IsError())
+    {
+      std::cout << errOrBytes.GetError().Message() << '\n';
+      Check(false, "extracting every entry");
+      continue;
+    }
+
+    if(EndsWith(entry.Name, className))
+    {
+      Check(errOrBytes.Get() == expected, "entry inflates to the class file");
+      matches++;
+    }
+  }
+
+  Check(matches > 0, "archive holds the class file");
+
+  ClassFile::BatchParser parser;
+  auto results = parser.ParseArchive(archive);
+
+  Check(results.GetSize() == matches, "every class entry is parsed");
+
+  for(auto& errOrClass : results)
+    Check(!errOrClass.IsError(), "class entry parses");
+
+  for(const auto& original : archive.GetEntries())
+  {
+    if(original.Method != ClassFile::ZipArchive::Deflated || original.CompressedSize == 0)
+      continue;
+
+    auto entry = original;
+    entry.UncompressedSize = 0xFFFFFFFF;
+    Check(archive.Extract(entry).IsError(), "refusing 4 GiB entries");
+
+    entry.UncompressedSize = entry.CompressedSize * ClassFile::ZipArchive::MaxDeflateRatio + 1024;
+    Check(archive.Extract(entry).IsError(), "refusing sizes beyond the maximum DEFLATE expansion");
+  }
+
+  archive.SetMaxEntrySize(static_cast<ClassFile::U32>(expected.size() - 1));
+
+  for(const auto& entry : archive.GetEntries())
+  {
+    if(EndsWith(entry.Name, className))
+      Check(archive.Extract(entry).IsError(), "refusing entries above the maximum entry size");
+  }
+
+  if(Failures != 0)
+    return -3;
+
+  std::cout << "OK: " << archive.GetEntries().size() << " entries, " << matches << " copies of "
+    << className << '\n';
+}
@@ -13,6 +13,7 @@
 #include <ClassFile/ClassFile.hpp>
 #include <ClassFile/Parser.hpp>
 #include <ClassFile/Serializer.hpp>
+#include <ClassFile/MappedClassFile.hpp>
 
 static bool PrintDetails{false};
 
@@ -84,11 +85,39 @@ std::string_view GetOperandTypeName(ClassFile::Instruction::OperandType type)
   return "UNKNOWN_TYPE";
 }
 
-void PrintInstrInfo(const ClassFile::Instruction& instr)
+void PrintSwitch(const ClassFile::Instruction& instr, const ClassFile::SwitchTable& table)
+{
+  std::cout << ": default{" << table.Default << "}";
+
+  for(size_t i = 0; i < table.Offsets.size(); i++)
+  {
+    ClassFile::S64 match = instr.Op == ClassFile::Instruction::Opcode::TABLESWITCH 
+      ? ClassFile::S64{table.Low} + static_cast<ClassFile::S64>(i) : table.Matches[i];
+
+    std::cout << ", " << match << "{" << table.Offsets[i] << "}";
+  }
+
+  std::cout << '\n';
+}
+
+void PrintInstrInfo(const ClassFile::Instruction& instr, const ClassFile::CodeAttribute& codeAttr)
 {
   std::cout << instr.GetMnemonic() << " (0x";
   std::cout << std::hex << (int)instr.Op << std::dec << ")";
 
+  if(instr.Op == ClassFile::Instruction::Opcode::WIDE)
+    std::cout << " " << ClassFile::Instruction::GetMnemonic(instr.GetWidenedOpcode());
+
+  if(instr.IsSwitch())
+  {
+    if(instr.GetSwitchIndex() < codeAttr.Switches.size())
+      PrintSwitch(instr, codeAttr.Switches[instr.GetSwitchIndex()]);
+    else
+      std::cout << '\n';
+
+    return;
+  }
+
   if(instr.GetNOperands() > 0)
     std::cout << ": Opreands[";
   else
@@ -202,7 +231,7 @@ void PrintMethods(const ClassFile::ClassFile& cf)
           std::cout << ":\n";
 
         std::cout << "    ";
-        PrintInstrInfo(codeAttr.Code[j]);
+        PrintInstrInfo(codeAttr.Code[j], codeAttr);
       }
 
     }
@@ -299,33 +328,30 @@ int main(int argc, char** argv)
     return -2;
   }
 
-  std::ifstream infile{argv[1], std::ios::ate};
-
-  if(!infile.good())
-  {
-    std::cout << "Unable to open file \"" << argv[1] << "\"\n";
-    return -3;
-  }
-
-  auto fileSize = infile.tellg();
-  infile.seekg(0);
-
+  //method bodies are only printed with --details, skip decoding them otherwise
+  ClassFile::ParseOptions opts;
+  opts.LazyCode = !PrintDetails;
 
   auto before = std::chrono::high_resolution_clock::now();
-  auto errOrClass = ClassFile::Parser::ParseClassFile(infile);
+  auto errOrClass = ClassFile::MappedClassFile::Load(argv[1], opts);
   auto after = std::chrono::high_resolution_clock::now();
 
   if(errOrClass.IsError())
   {
-    std::cout << "ERROR: " << errOrClass.GetError().What << '\n';
+    std::cout << "ERROR: " << errOrClass.GetError().Message() << '\n';
     return -1;
   }
 
-  std::cout << "Parsed " << infile.tellg() << '/' << fileSize << " bytes ";
+  std::cout << "Parsed " << errOrClass.Get().GetBytes().Size << " bytes ";
   std::cout << "in ~" << std::chrono::duration_cast<std::chrono::nanoseconds>(after-before).count() / 1000000.0f << " milliseconds\n\n";
 
-  ClassFile::ClassFile cf = errOrClass.Release();
-  PrintClassInfo(cf);
+  //the mapping must stay alive for as long as the class is used
+  ClassFile::MappedClassFile mapped = errOrClass.Release();
+
+  //every constant is looked up at least once when printing
+  mapped->ConstPool.BuildResolutionCache();
+
+  PrintClassInfo(mapped.Get());
 
   return 0;
 }
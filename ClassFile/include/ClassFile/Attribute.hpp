@@ -3,7 +3,10 @@
 #include "Instruction.hpp"
 #include "Defs.hpp"
 #include "Error.hpp"
+#include "Memory.hpp"
 
+#include <memory>
+#include <string>
 #include <string_view>
 #include <cassert>
 #include <vector>
@@ -11,21 +14,52 @@
 namespace ClassFile
 {
 
+class ConstantPool;
 
-struct AttributeInfo
+struct AttributeInfo : public ResourceAllocated
 {
   public:
     enum class Type
     {
       ConstantValue,
       Code,
-
+      StackMapTable,
+      Exceptions,
+      InnerClasses,
+      EnclosingMethod,
+      Synthetic,
+      Signature,
       SourceFile,
+      SourceDebugExtension,
+      LineNumberTable,
+      LocalVariableTable,
+      LocalVariableTypeTable,
+      Deprecated,
+      RuntimeVisibleAnnotations,
+      RuntimeInvisibleAnnotations,
+      RuntimeVisibleParameterAnnotations,
+      RuntimeInvisibleParameterAnnotations,
+      RuntimeVisibleTypeAnnotations,
+      RuntimeInvisibleTypeAnnotations,
+      AnnotationDefault,
+      BootstrapMethods,
+      MethodParameters,
+      Module,
+      ModulePackages,
+      ModuleMainClass,
+      NestHost,
+      NestMembers,
+      Record,
+      PermittedSubclasses,
   
       Raw, //Non standard 
     };
   
     static ErrorOr<Type> GetType(std::string_view);
+
+    //Whether attributes of this type are parsed into a LazyAttribute, which 
+    //retains its body until decoded
+    static bool IsLazy(Type);
     static std::string_view GetTypeName(Type);
   
     std::string_view GetName() const;
@@ -43,6 +77,15 @@ struct AttributeInfo
     //size of a serialized attribute: 
     //GetHeaderLength() + GetLength() = actual serialized length of attribute
     static U32 GetHeaderLength() { return 6; }
+
+    //Serialized bytes (header included) this attribute was parsed from, see 
+    //ParseOptions::RetainSource. While retained the Serializer copies them 
+    //as is, so MarkDirty() has to be called after modifying the attribute 
+    //(a modified nested attribute of a Code attribute is enough).
+    ByteView GetSource() const { return m_source; }
+    void SetSource(ByteView source) { m_source = source; }
+    bool HasSource() const { return m_source.Data != nullptr; }
+    void MarkDirty() { m_source = {}; }
   
     virtual ~AttributeInfo() = default;
   
@@ -51,6 +94,7 @@ struct AttributeInfo
 
   private:
     Type m_type;
+    ByteView m_source;
 };
 
 
@@ -70,14 +114,161 @@ struct SourceFileAttribute : public AttributeInfo
   U16 SourceFileIndex;
 };
 
-struct CodeAttribute : public AttributeInfo
+struct EnclosingMethodAttribute : public AttributeInfo
+{
+  EnclosingMethodAttribute() : AttributeInfo(Type::EnclosingMethod) {}
+  U32 GetLength() const override { return 4;  }
+
+  U16 ClassIndex;
+  U16 MethodIndex; //0 if not enclosed by a method or constructor
+};
+
+struct SyntheticAttribute : public AttributeInfo
+{
+  SyntheticAttribute() : AttributeInfo(Type::Synthetic) {}
+  U32 GetLength() const override { return 0;  }
+};
+
+struct DeprecatedAttribute : public AttributeInfo
+{
+  DeprecatedAttribute() : AttributeInfo(Type::Deprecated) {}
+  U32 GetLength() const override { return 0;  }
+};
+
+struct SignatureAttribute : public AttributeInfo
+{
+  SignatureAttribute() : AttributeInfo(Type::Signature) {}
+  U32 GetLength() const override { return 2;  }
+
+  U16 SignatureIndex;
+};
+
+struct NestHostAttribute : public AttributeInfo
+{
+  NestHostAttribute() : AttributeInfo(Type::NestHost) {}
+  U32 GetLength() const override { return 2;  }
+
+  U16 HostClassIndex;
+};
+
+struct ModuleMainClassAttribute : public AttributeInfo
 {
-  CodeAttribute() : AttributeInfo(Type::Code) {}
+  ModuleMainClassAttribute() : AttributeInfo(Type::ModuleMainClass) {}
+  U32 GetLength() const override { return 2;  }
+
+  U16 MainClassIndex;
+};
+
+//Base of the attributes which are retained as bytes when parsed and only 
+//decoded by Parser::DecodeAttribute(), so the cost of an attribute is only
+//paid by code that looks at it. A default constructed attribute is decoded.
+struct LazyAttribute : public AttributeInfo
+{
+  bool IsDecoded() const { return !m_deferred; }
+  ByteView GetUndecodedBody() const { return m_undecoded; }
+  bool BorrowsUndecodedBody() const { return m_deferred && m_ownedUndecoded.empty(); }
+
+  //The viewed bytes must outlive this attribute, or until it is decoded
+  void Defer(ByteView body)
+  {
+    m_ownedUndecoded.clear();
+    m_undecoded = body;
+    m_deferred = true;
+  }
+
+  void Defer(std::vector<U8>&& body)
+  {
+    m_ownedUndecoded = std::move(body);
+    m_undecoded = {m_ownedUndecoded.data(), m_ownedUndecoded.size()};
+    m_deferred = true;
+  }
+
+  void ClearUndecoded()
+  {
+    m_ownedUndecoded = {};
+    m_undecoded = {};
+    m_deferred = false;
+  }
+
+  U32 GetLength() const override
+  {
+    if(!IsDecoded())
+      return static_cast<U32>(m_undecoded.Size);
+
+    return GetDecodedLength();
+  }
+
+  //Length of the decoded contents, which are empty while !IsDecoded()
+  virtual U32 GetDecodedLength() const = 0;
+
+  protected:
+  LazyAttribute(Type type) : AttributeInfo(type) {}
+
+  //An owned body is viewed through m_undecoded, which has to follow the
+  //vector into the copy
+  LazyAttribute(const LazyAttribute& other)
+    : AttributeInfo(other), m_undecoded{other.m_undecoded}, m_ownedUndecoded{other.m_ownedUndecoded},
+      m_deferred{other.m_deferred}
+  {
+    rebindUndecoded();
+  }
+
+  LazyAttribute(LazyAttribute&& other) noexcept
+    : AttributeInfo(other), m_undecoded{other.m_undecoded}, m_ownedUndecoded{std::move(other.m_ownedUndecoded)},
+      m_deferred{other.m_deferred}
+  {
+    rebindUndecoded();
+    other.ClearUndecoded();
+  }
+
+  LazyAttribute& operator=(const LazyAttribute& other)
+  {
+    AttributeInfo::operator=(other);
+    m_undecoded = other.m_undecoded;
+    m_ownedUndecoded = other.m_ownedUndecoded;
+    m_deferred = other.m_deferred;
+    rebindUndecoded();
+    return *this;
+  }
+
+  LazyAttribute& operator=(LazyAttribute&& other) noexcept
+  {
+    if(this == &other)
+      return *this;
+
+    AttributeInfo::operator=(other);
+    m_undecoded = other.m_undecoded;
+    m_ownedUndecoded = std::move(other.m_ownedUndecoded);
+    m_deferred = other.m_deferred;
+    rebindUndecoded();
+    other.ClearUndecoded();
+    return *this;
+  }
+
+  private:
+  void rebindUndecoded()
+  {
+    if(!m_ownedUndecoded.empty())
+      m_undecoded = {m_ownedUndecoded.data(), m_ownedUndecoded.size()};
+  }
+
+  ByteView m_undecoded;
+  std::vector<U8> m_ownedUndecoded;
+  bool m_deferred{false};
+};
+
+struct CodeAttribute : public LazyAttribute
+{
+  CodeAttribute() : LazyAttribute(Type::Code) {}
 
   U16 MaxStack;
   U16 MaxLocals;
   std::vector<Instruction> Code;
 
+  //Tables of the tableswitch & lookupswitch instructions in Code, which 
+  //refer to them by Instruction::GetSwitchIndex()
+  std::vector<SwitchTable> Switches;
+
   struct ExceptionHandler
   {
     U16 StartPC;
@@ -85,20 +276,61 @@ struct CodeAttribute : public AttributeInfo
     U16 HandlerPC;
     U16 CatchType;
   };
+  static_assert(sizeof(ExceptionHandler) == sizeof(U16) * 4, "read & written as an array of U16");
   std::vector<ExceptionHandler> ExceptionTable;
 
   std::vector< std::unique_ptr<AttributeInfo> > Attributes;
 
+  //When parsed with ParseOptions::LazyCode only MaxStack & MaxLocals are read,
+  //the rest of the attribute (code_length onwards) is the undecoded body and
+  //Code, ExceptionTable & Attributes stay empty until Parser::DecodeCode().
+
+  //The bytecode array of an undecoded attribute, empty if decoded or malformed
+  ByteView GetUndecodedCode() const
+  {
+    ByteView body = GetUndecodedBody();
+
+    if(body.Size < sizeof(U32))
+      return {};
+
+    const U8* b = body.Data;
+    U32 codeLen = (U32{b[0]} << 24) | (U32{b[1]} << 16) | (U32{b[2]} << 8) | U32{b[3]};
+
+    if(codeLen > body.Size - sizeof(U32))
+      return {};
+
+    return {b + sizeof(U32), codeLen};
+  }
+
+  //Length of the encoded code array, switch padding depends on the offset of
+  //every instruction
+  U32 GetCodeLength() const
+  {
+    size_t offset{0};
+
+    for(const Instruction& instr : Code)
+      offset += instr.GetLength(offset, Switches);
+
+    return static_cast<U32>(offset);
+  }
+
   U32 GetLength() const override 
   { 
+    if(!IsDecoded())
+      return sizeof(MaxStack) + sizeof(MaxLocals) + static_cast<U32>(GetUndecodedBody().Size);
+
+    return GetDecodedLength();
+  }
+
+  U32 GetDecodedLength() const override
+  {
     U32 len{0};
     len += sizeof(MaxStack);
     len += sizeof(MaxLocals);
 
     len += sizeof(U32); //serialized field: "code_length" 
 
-    for(const Instruction& instr : Code)
-      len += instr.GetLength();
+    len += GetCodeLength();
 
     len += sizeof(U16); //serialized field: "exception_table_length" 
     len += ExceptionTable.size() * sizeof(U16) * 4;
@@ -112,7 +344,506 @@ struct CodeAttribute : public AttributeInfo
 
     return len;
   }
+};
+
+
+struct StackMapTableAttribute : public LazyAttribute
+{
+  StackMapTableAttribute() : LazyAttribute(Type::StackMapTable) {}
+
+  struct VerificationType
+  {
+    enum class Item : U8
+    {
+      Top,
+      Integer,
+      Float,
+      Double,
+      Long,
+      Null,
+      UninitializedThis,
+      Object,
+      Uninitialized,
+    };
+
+    Item Tag;
+    U16 Data{0}; //cpool_index of Object, offset of Uninitialized
+
+    U32 GetLength() const 
+    { 
+      return Tag == Item::Object || Tag == Item::Uninitialized ? 3 : 1; 
+    }
+  };
+
+  struct Frame
+  {
+    enum class Kind
+    {
+      Same,
+      SameLocals1StackItem,
+      Chop,
+      Append,
+      Full,
+    };
+
+    //frame_type as parsed, picks the Kind and for Chop frames the number of
+    //chopped locals (251 - FrameType). Same & SameLocals1StackItem frames 
+    //are written in their compact form (OffsetDelta in frame_type) if 
+    //OffsetDelta fits and FrameType isn't one of the _extended forms, 
+    //Append frames append all of Locals.
+    U8 FrameType;
+    U16 OffsetDelta;
+
+    std::vector<VerificationType> Locals;
+    std::vector<VerificationType> Stack;
+
+    //Reserved frame types (128-246) are rejected by the Parser, they don't
+    //have a Kind
+    static bool IsReserved(U8 frameType) { return frameType >= 128 && frameType < 247; }
+
+    Kind GetKind() const;
+    U8 GetEncodedFrameType() const;
+    U32 GetLength() const;
+  };
+
+  std::vector<Frame> Entries;
+
+  U32 GetDecodedLength() const override
+  {
+    U32 len = sizeof(U16); //number_of_entries
+
+    for(const Frame& frame : Entries)
+      len += frame.GetLength();
+
+    return len;
+  }
+};
 
+//Attributes which are nothing but a table of constant pool indices
+struct IndexTableAttribute : public LazyAttribute
+{
+  std::vector<U16> Indices;
+
+  U32 GetDecodedLength() const override
+  {
+    return sizeof(U16) + static_cast<U32>(Indices.size() * sizeof(U16));
+  }
+
+  protected:
+  IndexTableAttribute(Type type) : LazyAttribute(type) {}
+};
+
+//Indices of the CONSTANT_Class_info of thrown exceptions
+struct ExceptionsAttribute : public IndexTableAttribute
+{
+  ExceptionsAttribute() : IndexTableAttribute(Type::Exceptions) {}
+};
+
+//Indices of CONSTANT_Class_info
+struct NestMembersAttribute : public IndexTableAttribute
+{
+  NestMembersAttribute() : IndexTableAttribute(Type::NestMembers) {}
+};
+
+//Indices of CONSTANT_Class_info
+struct PermittedSubclassesAttribute : public IndexTableAttribute
+{
+  PermittedSubclassesAttribute() : IndexTableAttribute(Type::PermittedSubclasses) {}
+};
+
+//Indices of CONSTANT_Package_info
+struct ModulePackagesAttribute : public IndexTableAttribute
+{
+  ModulePackagesAttribute() : IndexTableAttribute(Type::ModulePackages) {}
+};
+
+struct InnerClassesAttribute : public LazyAttribute
+{
+  InnerClassesAttribute() : LazyAttribute(Type::InnerClasses) {}
+
+  struct InnerClass
+  {
+    U16 InnerClassInfoIndex;
+    U16 OuterClassInfoIndex;
+    U16 InnerNameIndex;
+    U16 InnerClassAccessFlags;
+  };
+  static_assert(sizeof(InnerClass) == sizeof(U16) * 4, "read & written as an array of U16");
+  std::vector<InnerClass> Classes;
+
+  U32 GetDecodedLength() const override
+  {
+    return sizeof(U16) + static_cast<U32>(Classes.size() * sizeof(InnerClass));
+  }
+};
+
+struct LineNumberTableAttribute : public LazyAttribute
+{
+  LineNumberTableAttribute() : LazyAttribute(Type::LineNumberTable) {}
+
+  struct LineNumber
+  {
+    U16 StartPC;
+    U16 Line;
+  };
+  static_assert(sizeof(LineNumber) == sizeof(U16) * 2, "read & written as an array of U16");
+  std::vector<LineNumber> LineNumberTable;
+
+  U32 GetDecodedLength() const override
+  {
+    return sizeof(U16) + static_cast<U32>(LineNumberTable.size() * sizeof(LineNumber));
+  }
+};
+
+struct LocalVariableTableAttribute : public LazyAttribute
+{
+  LocalVariableTableAttribute() : LazyAttribute(Type::LocalVariableTable) {}
+
+  struct LocalVariable
+  {
+    U16 StartPC;
+    U16 Length;
+    U16 NameIndex;
+    U16 DescriptorIndex;
+    U16 Index;
+  };
+  static_assert(sizeof(LocalVariable) == sizeof(U16) * 5, "read & written as an array of U16");
+  std::vector<LocalVariable> LocalVariableTable;
+
+  U32 GetDecodedLength() const override
+  {
+    return sizeof(U16) + static_cast<U32>(LocalVariableTable.size() * sizeof(LocalVariable));
+  }
+};
+
+struct LocalVariableTypeTableAttribute : public LazyAttribute
+{
+  LocalVariableTypeTableAttribute() : LazyAttribute(Type::LocalVariableTypeTable) {}
+
+  struct LocalVariableType
+  {
+    U16 StartPC;
+    U16 Length;
+    U16 NameIndex;
+    U16 SignatureIndex;
+    U16 Index;
+  };
+  static_assert(sizeof(LocalVariableType) == sizeof(U16) * 5, "read & written as an array of U16");
+  std::vector<LocalVariableType> LocalVariableTypeTable;
+
+  U32 GetDecodedLength() const override
+  {
+    return sizeof(U16) + static_cast<U32>(LocalVariableTypeTable.size() * sizeof(LocalVariableType));
+  }
+};
+
+struct SourceDebugExtensionAttribute : public LazyAttribute
+{
+  SourceDebugExtensionAttribute() : LazyAttribute(Type::SourceDebugExtension) {}
+
+  //modified UTF-8, not length prefixed
+  std::string DebugExtension;
+
+  U32 GetDecodedLength() const override { return static_cast<U32>(DebugExtension.size()); }
+};
+
+struct BootstrapMethodsAttribute : public LazyAttribute
+{
+  BootstrapMethodsAttribute() : LazyAttribute(Type::BootstrapMethods) {}
+
+  struct BootstrapMethod
+  {
+    U16 BootstrapMethodRef;
+    std::vector<U16> BootstrapArguments;
+  };
+  std::vector<BootstrapMethod> BootstrapMethods;
+
+  U32 GetDecodedLength() const override
+  {
+    U32 len = sizeof(U16); //num_bootstrap_methods
+
+    //bootstrap_method_ref, num_bootstrap_arguments
+    for(const BootstrapMethod& method : BootstrapMethods)
+      len += sizeof(U16) * 2 + static_cast<U32>(method.BootstrapArguments.size() * sizeof(U16));
+
+    return len;
+  }
+};
+
+struct MethodParametersAttribute : public LazyAttribute
+{
+  MethodParametersAttribute() : LazyAttribute(Type::MethodParameters) {}
+
+  struct Parameter
+  {
+    U16 NameIndex;
+    U16 AccessFlags;
+  };
+  static_assert(sizeof(Parameter) == sizeof(U16) * 2, "read & written as an array of U16");
+  std::vector<Parameter> Parameters; //at most 255
+
+  U32 GetDecodedLength() const override
+  {
+    return sizeof(U8) + static_cast<U32>(Parameters.size() * sizeof(Parameter));
+  }
+};
+
+struct ModuleAttribute : public LazyAttribute
+{
+  ModuleAttribute() : LazyAttribute(Type::Module) {}
+
+  struct Require
+  {
+    U16 RequiresIndex;
+    U16 RequiresFlags;
+    U16 RequiresVersionIndex;
+  };
+  static_assert(sizeof(Require) == sizeof(U16) * 3, "read & written as an array of U16");
+
+  //an exports or opens entry
+  struct Package
+  {
+    U16 Index;
+    U16 Flags;
+    std::vector<U16> ToIndices;
+  };
+
+  struct Provide
+  {
+    U16 ProvidesIndex;
+    std::vector<U16> ProvidesWithIndices;
+  };
+
+  U16 ModuleNameIndex;
+  U16 ModuleFlags;
+  U16 ModuleVersionIndex;
+
+  std::vector<Require> Requires;
+  std::vector<Package> Exports;
+  std::vector<Package> Opens;
+  std::vector<U16> Uses;
+  std::vector<Provide> Provides;
+
+  U32 GetDecodedLength() const override;
+};
+
+struct RecordAttribute : public LazyAttribute
+{
+  RecordAttribute() : LazyAttribute(Type::Record) {}
+
+  struct Component
+  {
+    U16 NameIndex;
+    U16 DescriptorIndex;
+    std::vector< std::unique_ptr<AttributeInfo> > Attributes;
+  };
+  std::vector<Component> Components;
+
+  U32 GetDecodedLength() const override
+  {
+    U32 len = sizeof(U16); //components_count
+
+    for(const Component& component : Components)
+    {
+      //name_index, descriptor_index, attributes_count
+      len += sizeof(U16) * 3;
+
+      for(const auto& attr : component.Attributes)
+      {
+        len += AttributeInfo::GetHeaderLength();
+        len += attr->GetLength();
+      }
+    }
+
+    return len;
+  }
+};
+
+struct Annotation;
+
+//element_value of an annotation, which of the members is used depends on Tag
+struct ElementValue
+{
+  U8 Tag;
+
+  //const_value_index for B C D F I J S Z s, class_info_index for c and 
+  //type_name_index for e
+  U16 Index{0};
+
+  U16 ConstNameIndex{0}; //e
+  std::unique_ptr<Annotation> AnnotationValue; //@
+  std::vector<ElementValue> ArrayValue; //[
+
+  U32 GetLength() const;
+};
+
+struct Annotation
+{
+  struct ElementValuePair
+  {
+    U16 ElementNameIndex;
+    ElementValue Value;
+  };
+
+  U16 TypeIndex;
+  std::vector<ElementValuePair> ElementValuePairs;
+
+  U32 GetLength() const;
+};
+
+struct TypeAnnotation : public Annotation
+{
+  enum class TargetKind
+  {
+    TypeParameter,
+    Supertype,
+    TypeParameterBound,
+    Empty,
+    FormalParameter,
+    Throws,
+    LocalVar,
+    Catch,
+    Offset,
+    TypeArgument,
+  };
+
+  //Fails for unknown target types
+  static ErrorOr<TargetKind> GetTargetKind(U8 targetType);
+
+  U8 TargetType;
+
+  //target_info, which of these are used depends on the TargetKind:
+  //type_parameter_index, supertype_index, formal_parameter_index, 
+  //throws_type_index, exception_table_index or offset
+  U16 TargetIndex{0};
+  //bound_index of TypeParameterBound, type_argument_index of TypeArgument
+  U8 TargetArgument{0};
+
+  struct LocalVarTarget
+  {
+    U16 StartPC;
+    U16 Length;
+    U16 Index;
+  };
+  static_assert(sizeof(LocalVarTarget) == sizeof(U16) * 3, "read & written as an array of U16");
+  std::vector<LocalVarTarget> LocalVarTable;
+
+  struct PathEntry
+  {
+    U8 TypePathKind;
+    U8 TypeArgumentIndex;
+  };
+  std::vector<PathEntry> TargetPath;
+
+  //Unknown target types count as having no target_info, they fail to 
+  //serialize
+  U32 GetLength() const;
+};
+
+//RuntimeVisibleAnnotations & RuntimeInvisibleAnnotations
+struct AnnotationsAttribute : public LazyAttribute
+{
+  std::vector<Annotation> Annotations;
+
+  U32 GetDecodedLength() const override
+  {
+    U32 len = sizeof(U16); //num_annotations
+
+    for(const Annotation& annotation : Annotations)
+      len += annotation.GetLength();
+
+    return len;
+  }
+
+  protected:
+  AnnotationsAttribute(Type type) : LazyAttribute(type) {}
+};
+
+struct RuntimeVisibleAnnotationsAttribute : public AnnotationsAttribute
+{
+  RuntimeVisibleAnnotationsAttribute() : AnnotationsAttribute(Type::RuntimeVisibleAnnotations) {}
+};
+
+struct RuntimeInvisibleAnnotationsAttribute : public AnnotationsAttribute
+{
+  RuntimeInvisibleAnnotationsAttribute() : AnnotationsAttribute(Type::RuntimeInvisibleAnnotations) {}
+};
+
+//RuntimeVisibleParameterAnnotations & RuntimeInvisibleParameterAnnotations
+struct ParameterAnnotationsAttribute : public LazyAttribute
+{
+  //annotations of every parameter, at most 255 parameters
+  std::vector< std::vector<Annotation> > ParameterAnnotations;
+
+  U32 GetDecodedLength() const override
+  {
+    U32 len = sizeof(U8); //num_parameters
+
+    for(const auto& annotations : ParameterAnnotations)
+    {
+      len += sizeof(U16); //num_annotations
+
+      for(const Annotation& annotation : annotations)
+        len += annotation.GetLength();
+    }
+
+    return len;
+  }
+
+  protected:
+  ParameterAnnotationsAttribute(Type type) : LazyAttribute(type) {}
+};
+
+struct RuntimeVisibleParameterAnnotationsAttribute : public ParameterAnnotationsAttribute
+{
+  RuntimeVisibleParameterAnnotationsAttribute() 
+    : ParameterAnnotationsAttribute(Type::RuntimeVisibleParameterAnnotations) {}
+};
+
+struct RuntimeInvisibleParameterAnnotationsAttribute : public ParameterAnnotationsAttribute
+{
+  RuntimeInvisibleParameterAnnotationsAttribute() 
+    : ParameterAnnotationsAttribute(Type::RuntimeInvisibleParameterAnnotations) {}
+};
+
+//RuntimeVisibleTypeAnnotations & RuntimeInvisibleTypeAnnotations
+struct TypeAnnotationsAttribute : public LazyAttribute
+{
+  std::vector<TypeAnnotation> Annotations;
+
+  U32 GetDecodedLength() const override
+  {
+    U32 len = sizeof(U16); //num_annotations
+
+    for(const TypeAnnotation& annotation : Annotations)
+      len += annotation.GetLength();
+
+    return len;
+  }
+
+  protected:
+  TypeAnnotationsAttribute(Type type) : LazyAttribute(type) {}
+};
+
+struct RuntimeVisibleTypeAnnotationsAttribute : public TypeAnnotationsAttribute
+{
+  RuntimeVisibleTypeAnnotationsAttribute() 
+    : TypeAnnotationsAttribute(Type::RuntimeVisibleTypeAnnotations) {}
+};
+
+struct RuntimeInvisibleTypeAnnotationsAttribute : public TypeAnnotationsAttribute
+{
+  RuntimeInvisibleTypeAnnotationsAttribute() 
+    : TypeAnnotationsAttribute(Type::RuntimeInvisibleTypeAnnotations) {}
+};
+
+struct AnnotationDefaultAttribute : public LazyAttribute
+{
+  AnnotationDefaultAttribute() : LazyAttribute(Type::AnnotationDefault) {}
+
+  ElementValue DefaultValue;
+
+  U32 GetDecodedLength() const override { return DefaultValue.GetLength(); }
 };
 
 
@@ -120,9 +851,37 @@ struct CodeAttribute : public AttributeInfo
 struct RawAttribute : public AttributeInfo
 {
   RawAttribute() : AttributeInfo(Type::Raw) {}
-  U32 GetLength() const override { return static_cast<U32>(Bytes.size());  }
+  U32 GetLength() const override { return static_cast<U32>(GetBytes().Size);  }
+
+  //Returns the borrowed bytes if the attribute references the buffer it was
+  //parsed from, otherwise the owned Bytes
+  ByteView GetBytes() const
+  {
+    if(m_borrowed.Data)
+      return m_borrowed;
+
+    return {Bytes.data(), Bytes.size()};
+  }
+
+  //The viewed bytes must outlive this RawAttribute (or until Own is called)
+  void Borrow(ByteView bytes) { m_borrowed = bytes; }
+  bool IsBorrowed() const { return m_borrowed.Data != nullptr; }
+
+  //Copies borrowed bytes into Bytes so the attribute can be modified
+  void Own()
+  {
+    if(!m_borrowed.Data)
+      return;
+
+    Bytes.assign(m_borrowed.begin(), m_borrowed.end());
+    m_borrowed = {};
+  }
 
+  //NOTE: empty while IsBorrowed(), use GetBytes() for reading
   std::vector<U8> Bytes;
+
+  private:
+  ByteView m_borrowed;
 };
 
 } //namespace ClassFile
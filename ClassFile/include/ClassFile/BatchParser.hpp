@@ -0,0 +1,99 @@
+#pragma once
+
+#include "ClassFile.hpp"
+#include "Parser.hpp"
+#include "MappedClassFile.hpp"
+#include "ZipArchive.hpp"
+#include "Error.hpp"
+
+#include <memory>
+#include <memory_resource>
+#include <string>
+#include <string_view>
+#include <vector>
+
+class ThreadPool;
+
+namespace ClassFile
+{
+
+struct BatchOptions
+{
+  //Number of worker threads, 0 for std::thread::hardware_concurrency()
+  unsigned Threads = 0;
+
+  //Give every worker its own std::pmr::monotonic_buffer_resource to parse
+  //into, which replaces ParseOptions::Resource. The arenas are owned by the
+  //returned BatchResult, so nodes are bump allocated without any contention
+  //between workers and are all freed at once together with the results.
+  bool PerThreadArena = true;
+
+  //Applied to every input
+  ParseOptions Parse;
+};
+
+//A class file parsed out of a ZipArchive entry
+struct ArchivedClassFile
+{
+  //borrows from the archive
+  std::string_view Name;
+  ClassFile Class;
+};
+
+//Per-input results of a BatchParser run, in input order. Owns the arenas the
+//results were allocated from, so individual results must not outlive it.
+template <typename T>
+class BatchResult
+{
+  public:
+    size_t GetSize() const { return m_results.size(); }
+
+    ErrorOr<T>& operator[](size_t index) { return m_results[index]; }
+
+    auto begin() { return m_results.begin(); }
+    auto end() { return m_results.end(); }
+
+  private:
+    friend class BatchParser;
+
+    //declared before m_results so the arenas are released after the results
+    std::vector< std::unique_ptr<std::pmr::memory_resource> > m_arenas;
+    std::vector< ErrorOr<T> > m_results;
+};
+
+//Parses many class files on a pool of worker threads that is kept alive for
+//the lifetime of the BatchParser, errors are reported per input and don't
+//stop the rest of the batch.
+class BatchParser
+{
+  public:
+    explicit BatchParser(const BatchOptions& = {});
+    ~BatchParser();
+
+    BatchParser(const BatchParser&) = delete;
+    BatchParser& operator=(const BatchParser&) = delete;
+
+    unsigned GetThreadCount() const;
+
+    //With ParseOptions::BorrowBuffer set the buffers must outlive the result
+    BatchResult<ClassFile> ParseBuffers(const std::vector<ByteView>& buffers);
+
+    //Loaded through MappedClassFile
+    BatchResult<MappedClassFile> ParseFiles(const std::vector<std::string>& paths);
+
+    //Every ".class" entry of the archive, each worker inflating and parsing 
+    //its own entries. Stored entries are parsed directly out of the archive
+    //and deflated ones are inflated into the worker's arena (see 
+    //BatchOptions::PerThreadArena), or copied out of a temporary buffer when
+    //there's none. The archive must outlive the result.
+    BatchResult<ArchivedClassFile> ParseArchive(const ZipArchive&);
+
+  private:
+    template <typename T, typename Func>
+    BatchResult<T> run(size_t count, Func&& parse);
+
+    BatchOptions m_options;
+    std::unique_ptr<ThreadPool> m_pool;
+};
+
+} //namespace ClassFile
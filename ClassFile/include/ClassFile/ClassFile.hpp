@@ -13,6 +13,16 @@ struct FieldMethodInfo
   U16 NameIndex;
   U16 DescriptorIndex;
   std::vector< std::unique_ptr<AttributeInfo> > Attributes;
+
+  //Same as AttributeInfo::GetSource(), modifying any of the attributes and
+  //marking it dirty is enough to have the field/method reserialized
+  ByteView GetSource() const { return m_source; }
+  void SetSource(ByteView source) { m_source = source; }
+  bool HasSource() const { return m_source.Data != nullptr; }
+  void MarkDirty() { m_source = {}; }
+
+  private:
+    ByteView m_source;
 };
 
 struct ClassFile 
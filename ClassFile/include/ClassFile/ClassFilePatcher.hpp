@@ -0,0 +1,72 @@
+#pragma once
+
+#include "Defs.hpp"
+#include "Error.hpp"
+#include "ConstantPool.hpp"
+
+#include <string_view>
+#include <vector>
+
+namespace ClassFile
+{
+
+//Applies small edits straight to the bytes of a class file instead of going
+//through a Parser/Serializer round trip. The buffer is indexed once (offsets
+//of every constant pool entry, method and Code array), after which constant
+//values, equal length UTF8 strings and instruction operands are patched with
+//a few stores. Edits that change the size of the class file are applied by
+//reparsing and reserializing, which also reindexes the buffer.
+class ClassFilePatcher
+{
+  public:
+    struct Method
+    {
+      U32 Offset;
+      U16 AccessFlags;
+      U16 NameIndex;
+      U16 DescriptorIndex;
+
+      //offset & length of the code array, 0 if the method has no Code
+      U32 CodeOffset;
+      U32 CodeLength;
+    };
+
+    static ErrorOr<ClassFilePatcher> Create(std::vector<U8> bytes);
+
+    const std::vector<U8>& GetBytes() const { return m_bytes; }
+    std::vector<U8> Release() { return std::move(m_bytes); }
+
+    //Offset of a constant's tag byte
+    ErrorOr<U32> GetConstantOffset(U16 index) const;
+    ErrorOr<CPInfo::Type> GetConstantType(U16 index) const;
+    ErrorOr<std::string_view> GetUTF8(U16 index) const;
+
+    const std::vector<Method>& GetMethods() const { return m_methods; }
+    ErrorOr<size_t> FindMethod(std::string_view name, std::string_view descriptor) const;
+
+    ErrorOr<void> SetInteger(U16 index, S32 value);
+    ErrorOr<void> SetFloat(U16 index, float value);
+    ErrorOr<void> SetLong(U16 index, S64 value);
+    ErrorOr<void> SetDouble(U16 index, double value);
+
+    //In place if the encoded length doesn't change, otherwise the class file
+    //is reserialized
+    ErrorOr<void> SetUTF8(U16 index, std::string_view value);
+
+    //Sets operand operandIndex of the instruction starting at codeOffset in
+    //the method's code array, the value has to fit the operand's type
+    ErrorOr<void> SetOperand(size_t method, U32 codeOffset, size_t operandIndex, S32 value);
+
+  private:
+    ClassFilePatcher() = default;
+    ErrorOr<void> index();
+    ErrorOr<U32> getConstant(U16 index, CPInfo::Type type) const;
+
+    std::vector<U8> m_bytes;
+
+    //indexed by constant pool index, 0 for unusable slots
+    std::vector<U32> m_constants;
+    std::vector<Method> m_methods;
+};
+
+} //namespace ClassFile
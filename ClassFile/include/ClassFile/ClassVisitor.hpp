@@ -0,0 +1,83 @@
+#pragma once
+
+#include "ConstantPool.hpp"
+#include "Attribute.hpp"
+#include "Instruction.hpp"
+#include "Defs.hpp"
+
+#include <string_view>
+
+namespace ClassFile
+{
+
+//Callbacks for Parser::Visit(), which walks a class file buffer and reports
+//its contents in file order without building a ClassFile. Objects passed to
+//callbacks only live for the duration of the call, string_views and
+//ByteViews point into the parsed buffer. Every callback defaults to
+//Continue, override the ones of interest.
+class ClassVisitor
+{
+  public:
+    enum class Action
+    {
+      Continue,
+
+      //Don't descend into what was just visited: the attributes of a field
+      //or method, the body of an attribute or the instructions of a Code
+      //attribute. Same as Continue for callbacks with nothing to skip.
+      Skip,
+
+      //End the walk successfully right away
+      Stop
+    };
+
+    //What an attribute belongs to
+    enum class Owner
+    {
+      Class,
+      Field,
+      Method,
+      Code
+    };
+
+    virtual ~ClassVisitor() = default;
+
+    virtual Action VisitHeader(U32 magic, U16 minorVersion, U16 majorVersion) { return Action::Continue; }
+
+    //Filler entries following Long and Double constants aren't reported
+    virtual Action VisitConstant(U16 index, const CPInfo&) { return Action::Continue; }
+
+    virtual Action VisitClass(U16 accessFlags, std::string_view thisClass,
+        std::string_view superClass) { return Action::Continue; }
+
+    virtual Action VisitInterface(std::string_view name) { return Action::Continue; }
+
+    virtual Action VisitField(U16 accessFlags, std::string_view name,
+        std::string_view descriptor) { return Action::Continue; }
+
+    virtual Action VisitMethod(U16 accessFlags, std::string_view name,
+        std::string_view descriptor) { return Action::Continue; }
+
+    //Every attribute, including Code, is visited here first with its raw
+    //body. Returning Skip for a Code attribute skips everything below.
+    virtual Action VisitAttribute(Owner, std::string_view name, ByteView body) { return Action::Continue; }
+
+    //Returning Skip avoids decoding any of the method's instructions, the
+    //exception table and nested attributes are still visited
+    virtual Action VisitCode(U16 maxStack, U16 maxLocals, ByteView code) { return Action::Continue; }
+
+    //offset is the instruction's offset into the code array, returning Skip
+    //stops decoding the remaining instructions
+    virtual Action VisitInstruction(U32 offset, const Instruction&) { return Action::Continue; }
+
+    //Follows VisitInstruction() for a tableswitch or lookupswitch, the table
+    //is only valid for the duration of the call
+    virtual Action VisitSwitch(U32 offset, const Instruction&, const SwitchTable&) { return Action::Continue; }
+
+    virtual Action VisitExceptionHandler(const CodeAttribute::ExceptionHandler&) { return Action::Continue; }
+
+    //Called once the whole class file was walked, not called after a Stop
+    virtual void VisitEnd() {}
+};
+
+} //namespace ClassFile
@@ -2,16 +2,19 @@
 
 #include "Defs.hpp"
 #include "Error.hpp"
+#include "Memory.hpp"
+#include "ModifiedUTF8.hpp"
 
 #include <vector>
 #include <memory>
 #include <string>
 #include <string_view>
+#include <type_traits>
 
 namespace ClassFile
 {
 
-struct CPInfo
+struct CPInfo : public ResourceAllocated
 {
   enum class Type : U8
   {
@@ -46,92 +49,152 @@ struct CPInfo
 
 struct ClassInfo : public CPInfo
 {
-  ClassInfo() : CPInfo(Type::Class) {}
+  static constexpr Type StaticType = Type::Class;
+  ClassInfo() : CPInfo(StaticType) {}
   U16 NameIndex;
 };
 
 struct FieldrefInfo : public CPInfo
 {
-  FieldrefInfo() : CPInfo(Type::Fieldref) {}
+  static constexpr Type StaticType = Type::Fieldref;
+  FieldrefInfo() : CPInfo(StaticType) {}
   U16 ClassIndex;
   U16 NameAndTypeIndex;
 };
 
 struct MethodrefInfo : public CPInfo
 {
-  MethodrefInfo() : CPInfo(Type::Methodref) {}
+  static constexpr Type StaticType = Type::Methodref;
+  MethodrefInfo() : CPInfo(StaticType) {}
   U16 ClassIndex;
   U16 NameAndTypeIndex;
 };
 
 struct InterfaceMethodrefInfo : public CPInfo
 {
-  InterfaceMethodrefInfo() : CPInfo(Type::InterfaceMethodref) {}
+  static constexpr Type StaticType = Type::InterfaceMethodref;
+  InterfaceMethodrefInfo() : CPInfo(StaticType) {}
   U16 ClassIndex;
   U16 NameAndTypeIndex;
 };
 
 struct StringInfo : public CPInfo
 {
-  StringInfo() : CPInfo(Type::String) {}
+  static constexpr Type StaticType = Type::String;
+  StringInfo() : CPInfo(StaticType) {}
   U16 StringIndex;
 };
 
 struct IntegerInfo : public CPInfo
 {
-  IntegerInfo() : CPInfo(Type::Integer) {}
+  static constexpr Type StaticType = Type::Integer;
+  IntegerInfo() : CPInfo(StaticType) {}
   U32 Bytes;
 };
 
 struct FloatInfo : public CPInfo
 {
-  FloatInfo() : CPInfo(Type::Float) {}
+  static constexpr Type StaticType = Type::Float;
+  FloatInfo() : CPInfo(StaticType) {}
   U32 Bytes;
 };
 
 struct LongInfo : public CPInfo
 {
-  LongInfo() : CPInfo(Type::Long) {}
+  static constexpr Type StaticType = Type::Long;
+  LongInfo() : CPInfo(StaticType) {}
   U32 HighBytes;
   U32 LowBytes;
 };
 
 struct DoubleInfo : public CPInfo
 {
-  DoubleInfo() : CPInfo(Type::Double) {}
+  static constexpr Type StaticType = Type::Double;
+  DoubleInfo() : CPInfo(StaticType) {}
   U32 HighBytes;
   U32 LowBytes;
 };
 
 struct NameAndTypeInfo : public CPInfo
 {
-  NameAndTypeInfo() : CPInfo(Type::NameAndType) {}
+  static constexpr Type StaticType = Type::NameAndType;
+  NameAndTypeInfo() : CPInfo(StaticType) {}
   U16 NameIndex;
   U16 DescriptorIndex;
 };
 
 struct UTF8Info : public CPInfo
 {
-  UTF8Info() : CPInfo(Type::UTF8) {}
+  static constexpr Type StaticType = Type::UTF8;
+  UTF8Info() : CPInfo(StaticType) {}
+
+  //Returns the borrowed bytes if the constant references the buffer it was
+  //parsed from, otherwise the owned String
+  std::string_view GetString() const
+  {
+    if(m_borrowed.Data)
+      return {reinterpret_cast<const char*>(m_borrowed.Data), m_borrowed.Size};
+
+    return String;
+  }
+
+  //Sets the owned String and drops any borrowed reference
+  void SetString(std::string str)
+  {
+    String = std::move(str);
+    m_borrowed = {};
+  }
+
+  //GetString() is modified UTF-8 as stored in the class file, see 
+  //ModifiedUTF8 for the conversions
+  bool IsASCII() const { return ModifiedUTF8::IsASCII(GetString()); }
+  ErrorOr<void> Validate() const { return ModifiedUTF8::Validate(GetString()); }
+  ErrorOr<std::string> ToUTF8() const { return ModifiedUTF8::ToUTF8(GetString()); }
+  ErrorOr<std::u16string> ToUTF16() const { return ModifiedUTF8::ToUTF16(GetString()); }
+
+  //Sets the owned String from standard UTF-8, fails on invalid input
+  ErrorOr<void> SetUTF8(std::string_view str)
+  {
+    auto errOrStr = ModifiedUTF8::FromUTF8(str);
+    if(errOrStr.IsError())
+      return errOrStr.GetError();
+
+    SetString(errOrStr.Release());
+    return {};
+  }
+
+  void SetUTF16(std::u16string_view str) { SetString(ModifiedUTF8::FromUTF16(str)); }
+
+  //The viewed bytes must outlive this UTF8Info (or until SetString is called)
+  void Borrow(ByteView bytes) { m_borrowed = bytes; }
+  bool IsBorrowed() const { return m_borrowed.Data != nullptr; }
+
+  //NOTE: empty while IsBorrowed(), use GetString() for reading
   std::string String;
+
+  private:
+  ByteView m_borrowed;
 };
 
 struct MethodHandleInfo : public CPInfo
 {
-  MethodHandleInfo() : CPInfo(Type::MethodHandle) {}
+  static constexpr Type StaticType = Type::MethodHandle;
+  MethodHandleInfo() : CPInfo(StaticType) {}
   U8 ReferenceKind;
   U16 ReferenceIndex;
 };
 
 struct MethodTypeInfo : public CPInfo
 {
-  MethodTypeInfo() : CPInfo(Type::MethodType) {}
+  static constexpr Type StaticType = Type::MethodType;
+  MethodTypeInfo() : CPInfo(StaticType) {}
   U16 DescriptorIndex;
 };
 
 struct InvokeDynamicInfo : public CPInfo
 {
-  InvokeDynamicInfo() : CPInfo(Type::InvokeDynamic) {}
+  static constexpr Type StaticType = Type::InvokeDynamic;
+  InvokeDynamicInfo() : CPInfo(StaticType) {}
   U16 BootstrapMethodAttrIndex;
   U16 NameAndTypeIndex;
 };
@@ -144,6 +207,10 @@ class ConstantPool
     void Add(std::unique_ptr<CPInfo>&& info);
     void Add(CPInfo* info);
 
+    //Takes the entry at index out of the pool, leaving an empty slot behind.
+    //nullptr if index is OOB or the slot is empty.
+    std::unique_ptr<CPInfo> Release(U16 index);
+
     //Succeeds if the index points to any CPInfo with a name or nameandtype index
     //OR is a UTF8Info or StringInfo itself
     ErrorOr<std::string_view> LookupString(U16 index) const;
@@ -151,6 +218,17 @@ class ConstantPool
     //Succeeds if the index points to any CPInfo with a descriptor or nameandtype index
     ErrorOr<std::string_view> LookupDescriptor(U16 index) const;
 
+    //Succeeds if the index points to a Fieldref, Methodref or InterfaceMethodref,
+    //returns the name of the class it belongs to
+    ErrorOr<std::string_view> LookupOwner(U16 index) const;
+
+    //Resolves the name, descriptor and owner of every entry once, so that 
+    //following Lookup* calls are a single array load. The cache is dropped by
+    //Add(), rebuild it after modifying entries in place.
+    void BuildResolutionCache();
+    void ClearResolutionCache();
+    bool HasResolutionCache() const;
+
     template <class T = CPInfo>
     ErrorOr<T*> Get(U16 index) const
     {
@@ -158,12 +236,17 @@ class ConstantPool
       if(err.IsError())
         return err.GetError();
 
-      T* cast_ptr = dynamic_cast<T*>( m_pool[index].get() );
+      CPInfo* ptr = m_pool[index-1].get();
 
-      if (!cast_ptr)
-        return failedCastError(index, typeid(T).name());
+      //tag check instead of a dynamic_cast, every concrete CPInfo carries 
+      //its Type as StaticType
+      if constexpr (!std::is_same_v<std::remove_const_t<T>, CPInfo>)
+      {
+        if (ptr->GetType() != T::StaticType)
+          return failedCastError(index, T::StaticType);
+      }
 
-      return cast_ptr;
+      return static_cast<T*>(ptr);
     }
 
     //if index is OOB then nullptr is returned
@@ -176,10 +259,26 @@ class ConstantPool
   private:
     ErrorOr<std::string_view> lookupStringOrUTF8(U16 index) const;
 
+    ErrorOr<std::string_view> resolveString(U16 index) const;
+    ErrorOr<std::string_view> resolveDescriptor(U16 index) const;
+    ErrorOr<std::string_view> resolveOwner(U16 index) const;
+    Error unresolvedError(U16, ErrorCode) const;
+
     ErrorOr<void> ensureValid(U16) const;
-    Error failedCastError(U16, std::string_view) const;
+    Error failedCastError(U16, CPInfo::Type) const;
 
     std::vector< std::unique_ptr<CPInfo> > m_pool;
+
+    //a view with a nullptr data() marks a lookup that doesn't resolve
+    struct ResolvedEntry
+    {
+      std::string_view Name;
+      std::string_view Descriptor;
+      std::string_view Owner;
+    };
+
+    //same indexing as m_pool, empty unless BuildResolutionCache() was called
+    std::vector<ResolvedEntry> m_resolved;
 };
 
 }  //namespace ClassFile
@@ -0,0 +1,91 @@
+#pragma once
+
+#include "Defs.hpp"
+#include "Error.hpp"
+#include "ConstantPool.hpp"
+
+#include <string_view>
+#include <unordered_map>
+
+namespace ClassFile
+{
+
+//Builds up a ConstantPool without duplicate entries. Every GetOrAdd* call 
+//hashes the requested constant and returns the index of an equal existing 
+//entry, or appends a new one (along with any UTF8, Class or NameAndType 
+//entries it refers to) and returns its index.
+class ConstantPoolBuilder
+{
+  public:
+    ConstantPoolBuilder() = default;
+
+    //Takes over an existing (e.g. parsed) pool, its entries are indexed so 
+    //they are reused by later GetOrAdd* calls
+    explicit ConstantPoolBuilder(ConstantPool&& pool);
+
+    ErrorOr<U16> GetOrAddUTF8(std::string_view);
+    ErrorOr<U16> GetOrAddString(std::string_view);
+    ErrorOr<U16> GetOrAddClass(std::string_view name);
+
+    ErrorOr<U16> GetOrAddInteger(S32);
+    ErrorOr<U16> GetOrAddFloat(float);
+    ErrorOr<U16> GetOrAddLong(S64);
+    ErrorOr<U16> GetOrAddDouble(double);
+
+    ErrorOr<U16> GetOrAddNameAndType(std::string_view name, std::string_view descriptor);
+    ErrorOr<U16> GetOrAddFieldref(std::string_view owner, std::string_view name, std::string_view descriptor);
+    ErrorOr<U16> GetOrAddMethodref(std::string_view owner, std::string_view name, std::string_view descriptor);
+    ErrorOr<U16> GetOrAddInterfaceMethodref(std::string_view owner, std::string_view name, std::string_view descriptor);
+
+    ErrorOr<U16> GetOrAddMethodType(std::string_view descriptor);
+    ErrorOr<U16> GetOrAddMethodHandle(U8 referenceKind, U16 referenceIndex);
+    ErrorOr<U16> GetOrAddInvokeDynamic(U16 bootstrapMethodAttrIndex, std::string_view name, std::string_view descriptor);
+
+    //Finds or adds an entry equal to the given one, any indices it holds are 
+    //taken as they are
+    ErrorOr<U16> GetOrAdd(const CPInfo&);
+
+    const ConstantPool& GetPool() const { return m_pool; }
+    ConstantPool Release();
+
+  private:
+    //Tag plus up to two index/value words, a UTF8 constant is keyed by its 
+    //text in a separate map
+    struct Key
+    {
+      CPInfo::Type Tag;
+      U8 Extra;
+      U32 First;
+      U32 Second;
+
+      bool operator==(const Key& other) const
+      {
+        return Tag == other.Tag && Extra == other.Extra && 
+               First == other.First && Second == other.Second;
+      }
+    };
+
+    struct KeyHash
+    {
+      size_t operator()(const Key& key) const
+      {
+        U64 h = (U64{key.First} << 32) | key.Second;
+        h ^= (U64{static_cast<U8>(key.Tag)} << 8 | key.Extra) * 0x9E3779B97F4A7C15ull;
+        h ^= h >> 29;
+        return static_cast<size_t>(h * 0xBF58476D1CE4E5B9ull);
+      }
+    };
+
+    static bool makeKey(const CPInfo&, Key&);
+
+    ErrorOr<U16> getOrAdd(const Key&, CPInfo* info);
+    void index(U16 index, const CPInfo&);
+
+    ConstantPool m_pool;
+
+    //keys view the strings of UTF8Info nodes owned by m_pool
+    std::unordered_map<std::string_view, U16> m_utf8;
+    std::unordered_map<Key, U16, KeyHash> m_entries;
+};
+
+} //namespace ClassFile
@@ -0,0 +1,37 @@
+#pragma once
+
+#include "Defs.hpp"
+#include "Error.hpp"
+#include "ClassFile.hpp"
+
+namespace ClassFile
+{
+
+//Passes over a whole ClassFile which move constant pool entries around and
+//rewrite every index referring to them: the class header, fields, methods,
+//instruction operands, the contents of every standard attribute and the
+//entries of the pool itself. Lazily parsed attributes (and Code) are decoded
+//first and everything is marked dirty, so the ClassFile has to be
+//reserialized afterwards. Attributes unknown to the Parser (RawAttribute)
+//may hold indices that can't be rewritten, these passes fail on them.
+class ConstantPoolRewriter
+{
+  public:
+    //Drops every entry that nothing in the class file refers to, directly or
+    //through other entries, and renumbers the remaining ones densely in
+    //their original order, so no index grows (an ldc stays an ldc). Long &
+    //Double entries keep taking two slots. Returns the number of slots
+    //removed, nothing is renumbered or marked dirty if that's 0.
+    static ErrorOr<U16> Compact(ClassFile&);
+
+    //ldc takes a one byte index, ldc_w two. Moves the constants loaded by
+    //ldc_w most often (behind the ones loaded by ldc) into the first 255 
+    //slots, if more loads fit there than before, then rewrites every ldc_w 
+    //whose index fits to ldc. Branches, switches, the exception table and 
+    //the offsets in StackMapTable, LineNumberTable, LocalVariable(Type)Table 
+    //and type annotations are relocated. A method whose branches would no 
+    //longer fit keeps its ldc_w. Returns the number of rewritten ldc_w.
+    static ErrorOr<size_t> PackLoadables(ClassFile&);
+};
+
+} //namespace ClassFile
@@ -0,0 +1,122 @@
+#pragma once
+
+#include "Defs.hpp"
+#include "Error.hpp"
+#include "Attribute.hpp"
+
+#include <vector>
+
+namespace ClassFile
+{
+
+//Basic blocks of a decoded CodeAttribute, the edges between them, the
+//dominator tree and the natural loops. Everything is stored in flat arrays
+//and refers to blocks, edges and loops by their U32 index into them: the
+//successors of a block are a range of Edges, its predecessors a range of
+//PredecessorEdges. Block 0 is the entry.
+//
+//Blocks end after branches, switches, returns, athrow and ret and start at
+//every branch target and at the bounds and handlers of ExceptionTable
+//entries, so a block is either entirely covered by an entry or not at all.
+class ControlFlowGraph
+{
+  public:
+    static constexpr U32 None = static_cast<U32>(-1);
+
+    struct Edge
+    {
+      enum class Kind : U8
+      {
+        //to the next block, also from jsr to its return site
+        Fallthrough,
+        //target of an if, goto or jsr
+        Jump,
+        //target of a tableswitch or lookupswitch
+        Switch,
+        //from a block covered by an ExceptionTable entry to its handler
+        Exception,
+      };
+
+      U32 From;
+      U32 To;
+      Kind Type;
+    };
+
+    struct Block
+    {
+      //Code[FirstInstruction, EndInstruction), at [StartPC, EndPC) in the
+      //code array
+      U32 FirstInstruction;
+      U32 EndInstruction;
+      U32 StartPC;
+      U32 EndPC;
+
+      //Edges[FirstSuccessor, FirstSuccessor + SuccessorCount), at most one
+      //edge per successor: the first branch, switch or handler leading there
+      U32 FirstSuccessor;
+      U32 SuccessorCount;
+
+      //PredecessorEdges[FirstPredecessor, FirstPredecessor + PredecessorCount)
+      U32 FirstPredecessor;
+      U32 PredecessorCount;
+
+      //Position in ReversePostOrder and the immediate dominator (the entry
+      //is its own), both None if the block can't be reached from the entry
+      U32 Order{None};
+      U32 ImmediateDominator{None};
+
+      //Innermost loop containing the block, None if there is none
+      U32 Loop{None};
+    };
+
+    //A header and the blocks which reach one of its back edges (edges to
+    //the header from a block it dominates) without passing the header. Back
+    //edges to the same header form one loop. Cycles without such a header
+    //(irreducible control flow) aren't loops.
+    struct Loop
+    {
+      U32 Header;
+
+      //Innermost loop containing this one, None for outermost loops
+      U32 Parent;
+
+      //1 for outermost loops
+      U32 Depth;
+
+      //LoopBlocks[FirstBlock, FirstBlock + BlockCount) in ascending order,
+      //including the blocks of nested loops
+      U32 FirstBlock;
+      U32 BlockCount;
+    };
+
+    //Code, Switches & ExceptionTable have to be decoded (see
+    //Parser::DecodeCode()), fails on branch targets and ExceptionTable
+    //offsets which don't start an instruction
+    static ErrorOr<ControlFlowGraph> Create(const CodeAttribute&);
+
+    //Block containing the instruction at pc, None if pc is past the code
+    U32 GetBlockAt(U32 pc) const;
+
+    bool IsReachable(U32 block) const { return Blocks[block].Order != None; }
+
+    //Every path from the entry to block passes dominator, a block dominates
+    //itself. Unreachable blocks neither dominate nor are dominated.
+    bool Dominates(U32 dominator, U32 block) const;
+
+    bool LoopContains(U32 loop, U32 block) const;
+
+    std::vector<Block> Blocks;
+    std::vector<Edge> Edges;
+
+    //Indices into Edges, grouped by Edge::To
+    std::vector<U32> PredecessorEdges;
+
+    //Reachable blocks only, the entry first
+    std::vector<U32> ReversePostOrder;
+
+    //Nested loops come before the loops containing them
+    std::vector<Loop> Loops;
+    std::vector<U32> LoopBlocks;
+};
+
+} //namespace ClassFile
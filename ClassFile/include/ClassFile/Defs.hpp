@@ -1,6 +1,7 @@
 #pragma once
 
 #include <cstdint>
+#include <cstddef>
 
 namespace ClassFile
 {
@@ -14,5 +15,15 @@ using S16 = std::int16_t;
 using S32 = std::int32_t;
 using S64 = std::int64_t;
 
+//Non-owning view over a contiguous range of bytes
+struct ByteView
+{
+  const U8* Data = nullptr;
+  std::size_t Size = 0;
+
+  const U8* begin() const { return Data; }
+  const U8* end() const { return Data + Size; }
+};
+
 } //namespace ClassFile
 
@@ -2,7 +2,9 @@
 
 #include "Defs.hpp"
 
+#include <array>
 #include <string>
+#include <string_view>
 #include <variant>
 #include <memory>
 
@@ -11,14 +13,119 @@
 namespace ClassFile
 {
 
-struct Error
+//What went wrong, the meaning of Error::Context is listed per code
+enum class ErrorCode : U8
 {
-  std::string What;
+  //Free-form, described by Error::What
+  Generic,
+
+  //{requested bytes, remaining bytes}
+  BufferOverrun,
+  //{requested bytes}
+  StreamFailure,
+
+  //{index, constant_pool_count}
+  InvalidConstantIndex,
+  //{index}
+  NullConstant,
+  //{index, expected CPInfo::Type}
+  ConstantTypeMismatch,
+  //{index}
+  UnresolvedName,
+  UnresolvedDescriptor,
+  UnresolvedOwner,
+  //{tag}
+  UnknownConstantTag,
+
+  //no context
+  UnknownAttribute,
+
+  //{index, operand count}
+  InvalidOperandIndex,
+  //{index, size of the requested type}
+  OperandTypeMismatch,
+  //{opcode}
+  ComplexInstruction,
+  //{opcode}
+  InvalidOpcode,
+  //{widened opcode}
+  InvalidWide,
+  //{entry count or table index, maximum that fits}
+  InvalidSwitch,
+
+  //{offset into the string, byte}
+  InvalidModifiedUTF8,
+  InvalidUTF8,
+  //{offset into the string, surrogate}
+  UnpairedSurrogate,
+
+  //{expected length, actual length}
+  LengthMismatch,
+  //{trailing bytes}
+  TrailingBytes,
+
+  //{tag, frame type or target type}
+  InvalidAttributeTag,
+  //{frame type, stack items of same_locals_1_stack_item or locals of append}
+  InvalidFrameItemCount,
+  //{depth, maximum depth}
+  NestingTooDeep,
+
+  //{offset, code_length}
+  InvalidCodeOffset,
 };
 
-struct ParseError : public Error
+//Errors are cheap to create and to pass up the stack: a code, the offset 
+//into the input it occurred at and two integers of context. Propagating 
+//through TRY/VERIFY only records the function (and a static note) in a 
+//fixed size trace, the human-readable text is built by Message() on demand.
+struct Error
 {
-  size_t pos;
+  static constexpr size_t NoOffset = static_cast<size_t>(-1);
+  static constexpr size_t MaxTrace = 6;
+
+  struct Frame
+  {
+    const char* Function;
+    const char* Note;
+
+    //the note was copied into Notes instead
+    bool CopiedNote;
+  };
+
+  Error() = default;
+  Error(std::string what) : What{std::move(what)} {}
+  Error(ErrorCode code, size_t offset = NoOffset, U64 first = 0, U64 second = 0)
+    : Code{code}, Offset{offset}, Context{first, second} {}
+
+  ErrorCode Code{ErrorCode::Generic};
+  size_t Offset{NoOffset};
+  std::array<U64, 2> Context{};
+
+  //Description of Generic errors, empty (and so not allocated) otherwise
+  std::string What;
+
+  //Innermost frame first, frames past MaxTrace are dropped
+  std::array<Frame, MaxTrace> Trace{};
+  U8 TraceSize{0};
+
+  //Notes which weren't string literals, in trace order and '\0' terminated
+  std::string Notes;
+
+  //note has to be a string literal (or otherwise outlive the Error), 
+  //nullptr or "" for none
+  void AddFrame(const char* function, const char* note)
+  {
+    if(TraceSize < MaxTrace)
+      Trace[TraceSize++] = {function, note, false};
+  }
+
+  //Copies the note into Notes
+  void AddFrame(const char* function, std::string_view note);
+
+  std::string Message() const;
+
+  static std::string_view GetCodeName(ErrorCode);
 };
 
 template <typename ValueT, typename ErrorT=Error>
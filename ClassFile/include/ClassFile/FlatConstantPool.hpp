@@ -0,0 +1,107 @@
+#pragma once
+
+#include "Defs.hpp"
+#include "Error.hpp"
+#include "ConstantPool.hpp"
+
+#include <vector>
+#include <string>
+#include <string_view>
+
+namespace ClassFile
+{
+
+//Contiguous, non-polymorphic representation of a ConstantPool: one fixed-size
+//tagged Entry per index plus a single side buffer holding the bytes of every 
+//UTF8 constant. Typed access is a tag compare and an array load, no virtual 
+//nodes or RTTI are involved. Mirrors the read API of ConstantPool.
+class FlatConstantPool
+{
+  public:
+    struct Entry
+    {
+      //Tag of unusable slots (index 0 & the slot following a Long or Double)
+      static constexpr CPInfo::Type Invalid = static_cast<CPInfo::Type>(0);
+
+      CPInfo::Type Tag = Invalid;
+      U8 ReferenceKind = 0; //MethodHandle only
+
+      //First:  ClassIndex, NameIndex, StringIndex, DescriptorIndex, 
+      //        BootstrapMethodAttrIndex, ReferenceIndex, Bytes, HighBytes or 
+      //        the offset of a UTF8 constant into the side buffer
+      //Second: NameAndTypeIndex, DescriptorIndex, LowBytes or the length of 
+      //        a UTF8 constant
+      U32 First = 0;
+      U32 Second = 0;
+    };
+
+    FlatConstantPool() = default;
+    explicit FlatConstantPool(const ConstantPool&);
+
+    //Same semantics as ConstantPool::LookupString
+    ErrorOr<std::string_view> LookupString(U16 index) const;
+
+    //Same semantics as ConstantPool::LookupDescriptor
+    ErrorOr<std::string_view> LookupDescriptor(U16 index) const;
+
+    //Returns a copy of the entry as its CPInfo struct, UTF8Infos borrow their
+    //string from this pool
+    template <class T>
+    ErrorOr<T> Get(U16 index) const
+    {
+      const Entry* entry = this->at(index);
+
+      if (!entry)
+        return invalidIndexError(index);
+
+      if (entry->Tag != T::StaticType)
+        return failedCastError(index, T::StaticType);
+
+      T info;
+      this->fill(*entry, info);
+      return info;
+    }
+
+    //if index is invalid or an unusable slot then nullptr is returned
+    const Entry* operator[](U16 index) const { return this->at(index); }
+
+    U16 GetSize() const;
+    U16 GetCount() const;
+
+  private:
+    const Entry* at(U16 index) const
+    {
+      if (index == 0 || index >= m_entries.size() || m_entries[index].Tag == Entry::Invalid)
+        return nullptr;
+
+      return &m_entries[index];
+    }
+
+    ErrorOr<std::string_view> lookupUTF8(U32 index) const;
+    ErrorOr<std::string_view> lookupNameAndType(U32 index, bool descriptor) const;
+
+    void fill(const Entry&, ClassInfo&) const;
+    void fill(const Entry&, FieldrefInfo&) const;
+    void fill(const Entry&, MethodrefInfo&) const;
+    void fill(const Entry&, InterfaceMethodrefInfo&) const;
+    void fill(const Entry&, StringInfo&) const;
+    void fill(const Entry&, IntegerInfo&) const;
+    void fill(const Entry&, FloatInfo&) const;
+    void fill(const Entry&, LongInfo&) const;
+    void fill(const Entry&, DoubleInfo&) const;
+    void fill(const Entry&, NameAndTypeInfo&) const;
+    void fill(const Entry&, UTF8Info&) const;
+    void fill(const Entry&, MethodHandleInfo&) const;
+    void fill(const Entry&, MethodTypeInfo&) const;
+    void fill(const Entry&, InvokeDynamicInfo&) const;
+
+    Error invalidIndexError(U16) const;
+    Error failedCastError(U16, CPInfo::Type) const;
+    Error lookupError(U16, ErrorCode) const;
+
+    //indexed by constant pool index, m_entries[0] is never valid
+    std::vector<Entry> m_entries;
+    std::string m_utf8;
+};
+
+} //namespace ClassFile
@@ -3,14 +3,32 @@
 #include "Defs.hpp"
 #include "Error.hpp"
 
+#include <array>
 #include <vector>
 #include <memory>
 #include <functional>
 #include <cassert>
+#include <type_traits>
 
 namespace ClassFile
 {
 
+//Operands of a tableswitch or lookupswitch, which don't fit inline. Owned by
+//CodeAttribute::Switches, the instruction only stores the table's index.
+struct SwitchTable
+{
+  S32 Default;
+
+  //tableswitch only, the match of Offsets[0], following offsets are for 
+  //consecutive matches
+  S32 Low;
+
+  //lookupswitch only, one match per offset in ascending order
+  std::vector<S32> Matches;
+
+  std::vector<S32> Offsets;
+};
+
 class Instruction
 {
   public:
@@ -233,19 +251,73 @@ class Instruction
 
   static ErrorOr<Instruction> MakeInstruction(Opcode);
 
+  //wide modifying op, which has to be IsWidenable()
+  static ErrorOr<Instruction> MakeWide(Opcode op);
+
+  //tableswitch or lookupswitch using CodeAttribute::Switches[switchIndex]
+  static ErrorOr<Instruction> MakeSwitch(Opcode op, U32 switchIndex);
+
+  //Decodes the instruction at code[offset], the code array being size bytes
+  //long. The table of a switch is appended to switches. length is set to the
+  //encoded length, including the padding of switches.
+  static ErrorOr<Instruction> Decode(const U8* code, size_t size, size_t offset,
+      std::vector<SwitchTable>& switches, size_t& length);
+
+  //Length of the encoded instruction at code[offset] without decoding it
+  static ErrorOr<size_t> GetEncodedLength(const U8* code, size_t size, size_t offset);
+
+  //Length of a switch at offset into the code array, which decides its 
+  //padding to a multiple of 4 bytes
+  static size_t GetSwitchLength(Opcode, size_t offset, const SwitchTable&);
+
   static std::string_view GetMnemonic(Opcode);
   static size_t GetNOperands(Opcode);
   static OperandType GetOperandType(Opcode, size_t index);
   static size_t GetOperandSize(Opcode, size_t index);
+  static size_t GetOperandOffset(Opcode, size_t index);
   static size_t GetLength(Opcode);
   static bool IsComplex(Opcode);
 
+  //Jumps, conditional branches (incl. jsr) and switches
+  static bool IsBranch(Opcode);
+  static bool IsInvoke(Opcode);
+  static bool IsSwitch(Opcode);
+
+  //ldc, ldc_w, ldc2_w, field accesses, invokes, new, anewarray, checkcast,
+  //instanceof & multianewarray, whose operand 0 is a constant pool index
+  static bool ReferencesConstant(Opcode);
+
+  //Loads, stores, ret & iinc, which may follow a wide
+  static bool IsWidenable(Opcode);
+
   std::string_view GetMnemonic() const;
   size_t GetNOperands() const;
   OperandType GetOperandType(size_t index) const;
   size_t GetOperandSize(size_t index) const;
+  size_t GetOperandOffset(size_t index) const;
+  //Not for switches, whose length depends on their offset and table
   size_t GetLength() const;
+
+  //offset is the instruction's offset into the code array and switches the
+  //CodeAttribute::Switches the instruction belongs to
+  size_t GetLength(size_t offset, const std::vector<SwitchTable>& switches) const;
+
+  //Encodes into dst, which has to hold GetLength(offset, switches) bytes
+  ErrorOr<void> Encode(U8* dst, size_t offset, const std::vector<SwitchTable>& switches) const;
+
   bool IsComplex() const;
+  bool IsBranch() const;
+  bool IsInvoke() const;
+  bool IsSwitch() const;
+  bool ReferencesConstant() const;
+
+  //wide only, the instruction the operands are widened for. Operand 0 is 
+  //the 16 bit local variable index, operand 1 iinc's 16 bit constant.
+  Opcode GetWidenedOpcode() const { return static_cast<Opcode>(m_widened); }
+
+  //switches only
+  U32 GetSwitchIndex() const;
+  void SetSwitchIndex(U32);
 
   template <typename T>
   ErrorOr< std::reference_wrapper<T> > Operand(size_t index)
@@ -274,8 +346,22 @@ class Instruction
   ErrorOr<S32> GetOperand(size_t index) const;
   ErrorOr<void> SetOperand(size_t index, S32 value);
 
+  //Largest total operand size of any instruction but switches (goto_w, 
+  //invokeinterface, invokedynamic, wide iinc)
+  static constexpr size_t MaxOperandBytes = 4;
+
+  //Longest encoding of anything but a switch (wide iinc)
+  static constexpr size_t MaxLength = 6;
+
   private:
-  std::vector<U8> operandBytes;
+  //wide only, lives in what would otherwise be padding between Op and 
+  //operandBytes
+  U8 m_widened{0};
+
+  //Stored inline so that Instruction is trivially copyable and a 
+  //std::vector<Instruction> is one dense allocation. Aligned so that a 
+  //multi-byte operand at offset 0 (the only place they occur) is aligned too.
+  alignas(4) std::array<U8, MaxOperandBytes> operandBytes{};
 
   Instruction() = default;
 
@@ -285,18 +371,18 @@ class Instruction
   {
     switch( this->GetOperandType(index) )
     {
-      case TypeS32: return {typeid(T) == typeid(S32)}; 
-      case TypeS16: return {typeid(T) == typeid(S16)}; 
-      case TypeS8:  return {typeid(T) == typeid(S8) }; 
-      case TypeU16: return {typeid(T) == typeid(U16)}; 
-      case TypeU8:  return {typeid(T) == typeid(U8) }; 
+      case TypeS32: return std::is_same_v<T, S32>; 
+      case TypeS16: return std::is_same_v<T, S16>; 
+      case TypeS8:  return std::is_same_v<T, S8 >; 
+      case TypeU16: return std::is_same_v<T, U16>; 
+      case TypeU8:  return std::is_same_v<T, U8 >; 
     }
 
     return false;
   }
 
   Error oobError(size_t) const;
-  Error castError(size_t, std::string_view) const;
+  Error castError(size_t, size_t) const;
 
 
   template <typename T>
@@ -306,11 +392,9 @@ class Instruction
       return oobError(index);
 
     if(!isValidType<T>(index))
-      return castError(index, typeid(T).name());
+      return castError(index, sizeof(T));
 
-    size_t offset{0};
-    for(size_t i{0}; i < index; ++i)
-      offset += this->GetOperandSize(i);
+    size_t offset = this->GetOperandOffset(index);
 
     assert(operandBytes.size() >= offset + this->GetOperandSize(index));
 
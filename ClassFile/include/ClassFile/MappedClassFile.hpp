@@ -0,0 +1,46 @@
+#pragma once
+
+#include "ClassFile.hpp"
+#include "Parser.hpp"
+#include "Error.hpp"
+
+#include <string>
+
+namespace ClassFile
+{
+
+//Owns a read-only memory mapping of a class file together with the ClassFile
+//parsed from it. UTF8Info, RawAttribute and undecoded attribute nodes borrow
+//from the mapping (see ParseOptions::BorrowBuffer), which is kept alive for as
+//long as this object.
+class MappedClassFile
+{
+  public:
+    static ErrorOr<MappedClassFile> Load(const std::string& path, const ParseOptions& = {});
+
+    MappedClassFile(MappedClassFile&&) noexcept;
+    MappedClassFile& operator=(MappedClassFile&&) noexcept;
+    ~MappedClassFile();
+
+    MappedClassFile(const MappedClassFile&) = delete;
+    MappedClassFile& operator=(const MappedClassFile&) = delete;
+
+    ClassFile& Get() { return m_classFile; }
+    const ClassFile& Get() const { return m_classFile; }
+
+    ClassFile* operator->() { return &m_classFile; }
+    const ClassFile* operator->() const { return &m_classFile; }
+
+    //The mapped file contents
+    ByteView GetBytes() const { return {m_data, m_size}; }
+
+  private:
+    MappedClassFile() = default;
+    void unmap();
+
+    const U8* m_data{nullptr};
+    size_t m_size{0};
+    ClassFile m_classFile;
+};
+
+} //namespace ClassFile
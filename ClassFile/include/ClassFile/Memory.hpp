@@ -0,0 +1,27 @@
+#pragma once
+
+#include <cstddef>
+#include <memory_resource>
+
+namespace ClassFile
+{
+
+//Base for node types (CPInfo, AttributeInfo) which may be allocated from a 
+//std::pmr::memory_resource, e.g. an arena passed to the Parser through 
+//ParseOptions::Resource. Every allocation is prefixed with the resource it 
+//came from, so plain delete (as done by std::unique_ptr) hands the memory 
+//back to that resource, which for a monotonic arena is a no-op until the 
+//arena itself is released.
+struct ResourceAllocated
+{
+  //allocates from std::pmr::new_delete_resource()
+  static void* operator new(std::size_t size);
+  static void* operator new(std::size_t size, std::pmr::memory_resource*);
+
+  static void operator delete(void* ptr);
+
+  //only called if a constructor throws after a resource allocation
+  static void operator delete(void* ptr, std::pmr::memory_resource*);
+};
+
+} //namespace ClassFile
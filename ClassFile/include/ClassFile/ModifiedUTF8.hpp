@@ -0,0 +1,36 @@
+#pragma once
+
+#include "Defs.hpp"
+#include "Error.hpp"
+
+#include <string>
+#include <string_view>
+
+namespace ClassFile
+{
+
+//The "modified UTF-8" of CONSTANT_Utf8_info: NUL is encoded as 0xC0 0x80 and
+//supplementary characters as a pair of 3 byte encoded surrogates, 4 byte
+//sequences don't occur. Runs of ASCII are scanned 16 (SSE2) or 32 (AVX2)
+//bytes at a time, strings that are pure ASCII are the same in every encoding
+//and are copied or widened without decoding.
+class ModifiedUTF8
+{
+  public:
+    //No NUL bytes and no bytes >= 0x80
+    static bool IsASCII(std::string_view);
+
+    //Length of the ASCII prefix as defined by IsASCII()
+    static size_t GetASCIILength(std::string_view);
+
+    static ErrorOr<void> Validate(std::string_view);
+
+    //Fails on unpaired surrogates, which standard UTF-8 can't encode
+    static ErrorOr<std::string> ToUTF8(std::string_view);
+    static ErrorOr<std::u16string> ToUTF16(std::string_view);
+
+    static ErrorOr<std::string> FromUTF8(std::string_view);
+    static std::string FromUTF16(std::u16string_view);
+};
+
+} //namespace ClassFile
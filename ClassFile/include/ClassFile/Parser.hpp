@@ -3,13 +3,91 @@
 #include "ClassFile.hpp"
 #include "Error.hpp"
 
+#include <memory_resource>
+#include <string>
+#include <string_view>
+#include <vector>
+
 namespace ClassFile
 {
 
+class ClassVisitor;
+
+//Selects the attributes the Parser keeps by name, at every level (class, 
+//field, method, nested in Code or Record). Attributes that aren't kept are 
+//skipped over without allocating anything, as if they weren't there, and 
+//serializing the ClassFile leaves them out.
+class AttributeFilter
+{
+  public:
+    //Keeps every attribute
+    AttributeFilter() = default;
+
+    //Keeps only the named attributes, nested ones included (allowing Code
+    //but not LineNumberTable keeps methods' code without line numbers)
+    static AttributeFilter Allow(std::vector<std::string> names);
+
+    //Keeps every attribute but the named ones
+    static AttributeFilter Deny(std::vector<std::string> names);
+
+    //Denies the debug information javac leaves out with -g:none (SourceFile,
+    //LineNumberTable, LocalVariableTable, LocalVariableTypeTable) as well as
+    //SourceDebugExtension
+    static AttributeFilter StripDebug();
+
+    bool Keeps(std::string_view name) const;
+    bool KeepsAll() const { return !m_allow && m_names.empty(); }
+
+  private:
+    AttributeFilter(bool allow, std::vector<std::string> names) 
+      : m_allow{allow}, m_names{std::move(names)} {}
+
+    bool m_allow{false};
+    std::vector<std::string> m_names;
+};
+
+struct ParseOptions
+{
+  //Only applies when parsing from an in-memory buffer. UTF8Info and 
+  //RawAttribute payloads, as well as the bodies of attributes that are yet 
+  //to be decoded (see Parser::DecodeAttribute()), reference the buffer 
+  //instead of being copied out of it, in which case the buffer must outlive 
+  //the returned ClassFile.
+  bool BorrowBuffer = true;
+
+  //Defer decoding of Code attributes (instructions, exception table and 
+  //nested attributes) until Parser::DecodeCode() is called on them. Useful 
+  //when only the class header, names and descriptors are of interest.
+  bool LazyCode = false;
+
+  //Only applies together with BorrowBuffer. Every FieldMethodInfo and 
+  //AttributeInfo remembers the range of the buffer it was parsed from and is
+  //copied verbatim from it when serialized, until marked dirty with 
+  //MarkDirty(). Rewriting a few methods then only reencodes those.
+  bool RetainSource = false;
+
+  //Reject UTF8 constants which aren't valid modified UTF-8, pure ASCII 
+  //strings are checked 16 or 32 bytes at a time
+  bool ValidateUTF8 = false;
+
+  //Resource CPInfo and AttributeInfo nodes are allocated from, nullptr for 
+  //the global heap. Passing an arena such as std::pmr::monotonic_buffer_resource
+  //turns the per-node allocations into bump allocations that are freed all at
+  //once with the arena, which then has to outlive the parsed ClassFile.
+  std::pmr::memory_resource* Resource = nullptr;
+
+  //Attributes to keep, see AttributeFilter. The nested attributes of a Code 
+  //attribute deferred by LazyCode are dropped from its undecoded body, a 
+  //Record is decoded while parsing unless this keeps every attribute.
+  AttributeFilter Filter;
+};
+
 class Parser
 {
   public:
     static ErrorOr<ClassFile> ParseClassFile(std::istream&);
+    static ErrorOr<ClassFile> ParseClassFile(const U8* data, size_t size, const ParseOptions& = {});
+
     static ErrorOr<ConstantPool> ParseConstantPool(std::istream&);
     static ErrorOr< std::unique_ptr<CPInfo> > ParseConstant(std::istream&);
 
@@ -17,6 +95,24 @@ class Parser
     static ErrorOr< std::unique_ptr<AttributeInfo> > ParseAttribute(std::istream&, const ConstantPool&);
 
     static ErrorOr<Instruction> ParseInstruction(std::istream&);
+
+    //Decodes a CodeAttribute parsed with ParseOptions::LazyCode, no-op if 
+    //it's already decoded. Nested attributes are filtered with filter.
+    static ErrorOr<void> DecodeCode(CodeAttribute&, const ConstantPool&, 
+        const AttributeFilter& filter = {});
+
+    //Decodes an attribute whose body was retained when parsed (see 
+    //AttributeInfo::IsLazy(), a Code attribute is passed on to DecodeCode()).
+    //No-op if it's already decoded or was never deferred, on failure it 
+    //stays undecoded.
+    static ErrorOr<void> DecodeAttribute(AttributeInfo&, const ConstantPool&, 
+        const AttributeFilter& filter = {});
+
+    //Walks a class file buffer and reports its contents to a ClassVisitor
+    //instead of building a ClassFile. Apart from what's passed to the 
+    //visitor, only the constant pool's strings (borrowed from the buffer) 
+    //and class name indices are kept around, to resolve names.
+    static ErrorOr<void> Visit(const U8* data, size_t size, ClassVisitor&);
 };
 
 
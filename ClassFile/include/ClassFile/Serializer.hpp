@@ -3,6 +3,8 @@
 #include "ClassFile.hpp"
 #include "Error.hpp"
 
+#include <vector>
+
 namespace ClassFile
 {
 
@@ -10,6 +12,16 @@ class Serializer
 {
   public:
     static ErrorOr<void> SerializeClassFile(std::ostream&, const ClassFile&);
+
+    //Buffer path: the exact serialized size is computed up front, then every 
+    //field is stored straight into one contiguous buffer with no per-field 
+    //stream calls. The pointer overload writes into a caller-provided buffer 
+    //of at least GetSerializedSize() bytes and returns the number of bytes 
+    //written.
+    static ErrorOr< std::vector<U8> > SerializeClassFile(const ClassFile&);
+    static ErrorOr<size_t> SerializeClassFile(const ClassFile&, U8* buffer, size_t size);
+    static ErrorOr<size_t> GetSerializedSize(const ClassFile&);
+
     static ErrorOr<void> SerializeConstantPool(std::ostream&, const ConstantPool&);
     static ErrorOr<void> SerializeConstant(std::ostream&, const CPInfo&);
 
@@ -0,0 +1,103 @@
+#pragma once
+
+#include "Defs.hpp"
+#include "Error.hpp"
+
+#include <string>
+#include <string_view>
+#include <vector>
+
+namespace ClassFile
+{
+
+//Read-only ZIP (and therefore JAR) archive, indexed through its central
+//directory. Entries may be stored or deflated, decompression is done by a
+//self-contained inflater so no temporary files or external libraries are
+//involved. ZIP64, multi-disk and encrypted archives aren't supported.
+class ZipArchive
+{
+  public:
+    enum CompressionMethod : U16
+    {
+      Stored   = 0,
+      Deflated = 8
+    };
+
+    //DEFLATE encodes a run of 258 bytes in 2 bits at best, which bounds how
+    //far an entry's data can inflate
+    static constexpr U32 MaxDeflateRatio = 1032;
+
+    //Default for SetMaxEntrySize()
+    static constexpr U32 DefaultMaxEntrySize = 256 << 20;
+
+    struct Entry
+    {
+      //borrows from the archive bytes
+      std::string_view Name;
+
+      U16 Method;
+      U16 Flags;
+      U32 CRC32;
+      U32 CompressedSize;
+      U32 UncompressedSize;
+      U32 LocalHeaderOffset;
+
+      bool IsDirectory() const { return !Name.empty() && Name.back() == '/'; }
+    };
+
+    //Maps the archive at path, which stays mapped for the lifetime of the
+    //returned ZipArchive
+    static ErrorOr<ZipArchive> Open(const std::string& path);
+
+    //The buffer must outlive the returned ZipArchive
+    static ErrorOr<ZipArchive> FromBuffer(const U8* data, size_t size);
+
+    ZipArchive(ZipArchive&&) noexcept;
+    ZipArchive& operator=(ZipArchive&&) noexcept;
+    ~ZipArchive();
+
+    ZipArchive(const ZipArchive&) = delete;
+    ZipArchive& operator=(const ZipArchive&) = delete;
+
+    const std::vector<Entry>& GetEntries() const { return m_entries; }
+
+    //The whole archive
+    ByteView GetBytes() const { return {m_data, m_size}; }
+
+    //The entry's data as it's stored in the archive, i.e. still compressed
+    //if the entry is deflated
+    ErrorOr<ByteView> GetData(const Entry&) const;
+
+    //The sizes in the central directory are untrusted, entries claiming an
+    //Entry::UncompressedSize above this are refused before anything is
+    //allocated for them
+    void SetMaxEntrySize(U32 size) { m_maxEntrySize = size; }
+    U32 GetMaxEntrySize() const { return m_maxEntrySize; }
+
+    //Fails if Entry::UncompressedSize exceeds GetMaxEntrySize() or more than
+    //its compressed data can possibly inflate to (MaxDeflateRatio)
+    ErrorOr<void> CheckSize(const Entry&) const;
+
+    //Decompresses an entry into dst, which must be at least
+    //Entry::UncompressedSize bytes, and verifies its CRC-32. Safe to call
+    //concurrently. Checks CheckSize() first.
+    ErrorOr<void> Extract(const Entry&, U8* dst) const;
+    ErrorOr< std::vector<U8> > Extract(const Entry&) const;
+
+    //Zero-copy access to the contents of a stored entry, after verifying its
+    //CRC-32. Fails for compressed entries.
+    ErrorOr<ByteView> View(const Entry&) const;
+
+  private:
+    ZipArchive() = default;
+    ErrorOr<void> readCentralDirectory();
+    void unmap();
+
+    const U8* m_data{nullptr};
+    size_t m_size{0};
+    bool m_mapped{false};
+    U32 m_maxEntrySize{DefaultMaxEntrySize};
+    std::vector<Entry> m_entries;
+};
+
+} //namespace ClassFile
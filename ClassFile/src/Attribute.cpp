@@ -1,8 +1,7 @@
 #include "ClassFile/Attribute.hpp"
 
-#include <fmt/core.h>
-
-#include <map>
+#include <array>
+#include <unordered_map>
 #include <cassert>
 
 namespace ClassFile
@@ -11,33 +10,95 @@ namespace ClassFile
 
 using namespace std::literals;
 
-static std::map<AttributeInfo::Type, std::string_view> typeNames =
+//indexed by AttributeInfo::Type
+static constexpr std::array typeNames =
 {
-  {AttributeInfo::Type::ConstantValue, "ConstantValue"sv},
-  {AttributeInfo::Type::Code,          "Code"sv},
-  {AttributeInfo::Type::SourceFile,    "SourceFile"sv},
+  "ConstantValue"sv,
+  "Code"sv,
+  "StackMapTable"sv,
+  "Exceptions"sv,
+  "InnerClasses"sv,
+  "EnclosingMethod"sv,
+  "Synthetic"sv,
+  "Signature"sv,
+  "SourceFile"sv,
+  "SourceDebugExtension"sv,
+  "LineNumberTable"sv,
+  "LocalVariableTable"sv,
+  "LocalVariableTypeTable"sv,
+  "Deprecated"sv,
+  "RuntimeVisibleAnnotations"sv,
+  "RuntimeInvisibleAnnotations"sv,
+  "RuntimeVisibleParameterAnnotations"sv,
+  "RuntimeInvisibleParameterAnnotations"sv,
+  "RuntimeVisibleTypeAnnotations"sv,
+  "RuntimeInvisibleTypeAnnotations"sv,
+  "AnnotationDefault"sv,
+  "BootstrapMethods"sv,
+  "MethodParameters"sv,
+  "Module"sv,
+  "ModulePackages"sv,
+  "ModuleMainClass"sv,
+  "NestHost"sv,
+  "NestMembers"sv,
+  "Record"sv,
+  "PermittedSubclasses"sv,
 
-  {AttributeInfo::Type::Raw, "_Raw"sv}
+  "_Raw"sv
 };
 
+static_assert(typeNames.size() == static_cast<size_t>(AttributeInfo::Type::Raw) + 1, 
+    "every AttributeInfo::Type needs a name");
+
 std::string_view AttributeInfo::GetTypeName(AttributeInfo::Type type) 
 {
-  auto itr = typeNames.find(type);
+  size_t index = static_cast<size_t>(type);
 
-  assert(itr != typeNames.end());
-  return std::get<1>(*itr);
+  assert(index < typeNames.size());
+  return typeNames[index];
 }
 
 ErrorOr<AttributeInfo::Type> AttributeInfo::GetType(std::string_view name) 
 {
-  for (auto itr : typeNames)
+  //looked up for every attribute parsed, Raw's name isn't a valid attribute 
+  //name
+  static const std::unordered_map<std::string_view, Type> types = []
   {
-    if (name == std::get<1>(itr))
-      return std::get<0>(itr);
-  }
+    std::unordered_map<std::string_view, Type> map;
+
+    for(size_t i = 0; i < typeNames.size() - 1; i++)
+      map.emplace(typeNames[i], static_cast<Type>(i));
+
+    return map;
+  }();
+
+  auto itr = types.find(name);
+
+  if(itr == types.end())
+    return Error{ErrorCode::UnknownAttribute};
+
+  return itr->second;
+}
+
+bool AttributeInfo::IsLazy(AttributeInfo::Type type)
+{
+  switch(type)
+  {
+    case Type::ConstantValue:
+    case Type::EnclosingMethod:
+    case Type::Synthetic:
+    case Type::Signature:
+    case Type::SourceFile:
+    case Type::Deprecated:
+    case Type::ModuleMainClass:
+    case Type::NestHost:
+    case Type::Raw:
+      return false;
 
-  return Error{ fmt::format("AttributeInfo::GetType(): requested type for "
-      "unknown type name: \"{}\"", name) };
+    //Code is only deferred with ParseOptions::LazyCode
+    default:
+      return true;
+  }
 }
 
 std::string_view AttributeInfo::GetName() const
@@ -50,5 +111,231 @@ AttributeInfo::Type AttributeInfo::GetType() const
   return m_type;
 }
 
+StackMapTableAttribute::Frame::Kind StackMapTableAttribute::Frame::GetKind() const
+{
+  assert(!IsReserved(FrameType));
+
+  if(FrameType < 64)
+    return Kind::Same;
+
+  if(FrameType < 128 || FrameType == 247)
+    return Kind::SameLocals1StackItem;
+
+  if(FrameType < 251)
+    return Kind::Chop;
+
+  if(FrameType == 251)
+    return Kind::Same;
+
+  if(FrameType < 255)
+    return Kind::Append;
+
+  return Kind::Full;
+}
+
+U8 StackMapTableAttribute::Frame::GetEncodedFrameType() const
+{
+  switch(GetKind())
+  {
+    case Kind::Same:
+      return FrameType != 251 && OffsetDelta < 64 ? static_cast<U8>(OffsetDelta) : 251;
+
+    case Kind::SameLocals1StackItem:
+      return FrameType != 247 && OffsetDelta < 64 ? static_cast<U8>(64 + OffsetDelta) : 247;
+
+    case Kind::Chop:
+      return FrameType;
+
+    case Kind::Append:
+      return static_cast<U8>(251 + Locals.size());
+
+    case Kind::Full:
+      return 255;
+  }
+
+  return FrameType;
+}
+
+static U32 getLength(const std::vector<StackMapTableAttribute::VerificationType>& types)
+{
+  U32 len{0};
+
+  for(const auto& type : types)
+    len += type.GetLength();
+
+  return len;
+}
+
+U32 StackMapTableAttribute::Frame::GetLength() const
+{
+  U8 encodedType = GetEncodedFrameType();
+
+  U32 len = sizeof(U8); //frame_type
+
+  //offset_delta, unless it's folded into frame_type
+  if(encodedType >= 128)
+    len += sizeof(U16);
+
+  switch(GetKind())
+  {
+    case Kind::Same:
+    case Kind::Chop:
+      break;
+
+    case Kind::SameLocals1StackItem:
+      len += getLength(Stack);
+      break;
+
+    case Kind::Append:
+      len += getLength(Locals);
+      break;
+
+    case Kind::Full:
+      len += sizeof(U16) + getLength(Locals);
+      len += sizeof(U16) + getLength(Stack);
+      break;
+  }
+
+  return len;
+}
+
+U32 ElementValue::GetLength() const
+{
+  U32 len = sizeof(Tag);
+
+  switch(Tag)
+  {
+    case 'B': case 'C': case 'D': case 'F': case 'I': case 'J': case 'S': case 'Z': 
+    case 's': case 'c':
+      len += sizeof(U16);
+      break;
+
+    case 'e':
+      len += sizeof(U16) * 2;
+      break;
+
+    case '@':
+      if(AnnotationValue)
+        len += AnnotationValue->GetLength();
+      break;
+
+    case '[':
+      len += sizeof(U16); //num_values
+
+      for(const ElementValue& value : ArrayValue)
+        len += value.GetLength();
+      break;
+  }
+
+  return len;
+}
+
+U32 Annotation::GetLength() const
+{
+  U32 len = sizeof(U16) * 2; //type_index, num_element_value_pairs
+
+  for(const ElementValuePair& pair : ElementValuePairs)
+    len += sizeof(pair.ElementNameIndex) + pair.Value.GetLength();
+
+  return len;
+}
+
+ErrorOr<TypeAnnotation::TargetKind> TypeAnnotation::GetTargetKind(U8 targetType)
+{
+  switch(targetType)
+  {
+    case 0x00: case 0x01: 
+      return TargetKind::TypeParameter;
+    case 0x10: 
+      return TargetKind::Supertype;
+    case 0x11: case 0x12: 
+      return TargetKind::TypeParameterBound;
+    case 0x13: case 0x14: case 0x15: 
+      return TargetKind::Empty;
+    case 0x16: 
+      return TargetKind::FormalParameter;
+    case 0x17: 
+      return TargetKind::Throws;
+    case 0x40: case 0x41: 
+      return TargetKind::LocalVar;
+    case 0x42: 
+      return TargetKind::Catch;
+    case 0x43: case 0x44: case 0x45: case 0x46: 
+      return TargetKind::Offset;
+    case 0x47: case 0x48: case 0x49: case 0x4A: case 0x4B: 
+      return TargetKind::TypeArgument;
+  }
+
+  return Error{ErrorCode::InvalidAttributeTag, Error::NoOffset, targetType};
+}
+
+U32 TypeAnnotation::GetLength() const
+{
+  U32 len = sizeof(TargetType);
+
+  auto errOrKind = GetTargetKind(TargetType);
+  TargetKind kind = errOrKind.IsError() ? TargetKind::Empty : errOrKind.Get();
+
+  switch(kind)
+  {
+    case TargetKind::TypeParameter:
+    case TargetKind::FormalParameter:
+      len += sizeof(U8);
+      break;
+
+    case TargetKind::Supertype:
+    case TargetKind::Throws:
+    case TargetKind::Catch:
+    case TargetKind::Offset:
+      len += sizeof(U16);
+      break;
+
+    case TargetKind::TypeParameterBound:
+      len += sizeof(U8) * 2;
+      break;
+
+    case TargetKind::TypeArgument:
+      len += sizeof(U16) + sizeof(U8);
+      break;
+
+    case TargetKind::LocalVar:
+      len += sizeof(U16) + static_cast<U32>(LocalVarTable.size() * sizeof(LocalVarTarget));
+      break;
+
+    case TargetKind::Empty:
+      break;
+  }
+
+  len += sizeof(U8) + static_cast<U32>(TargetPath.size() * sizeof(U8) * 2); //type_path
+
+  return len + Annotation::GetLength();
+}
+
+U32 ModuleAttribute::GetDecodedLength() const
+{
+  //module_name_index, module_flags, module_version_index
+  U32 len = sizeof(U16) * 3;
+
+  len += sizeof(U16) + static_cast<U32>(Requires.size() * sizeof(Require));
+
+  //index, flags, to_count
+  for(const Package& package : Exports)
+    len += sizeof(U16) * 3 + static_cast<U32>(package.ToIndices.size() * sizeof(U16));
+  len += sizeof(U16);
+
+  for(const Package& package : Opens)
+    len += sizeof(U16) * 3 + static_cast<U32>(package.ToIndices.size() * sizeof(U16));
+  len += sizeof(U16);
+
+  len += sizeof(U16) + static_cast<U32>(Uses.size() * sizeof(U16));
+
+  //provides_index, provides_with_count
+  for(const Provide& provide : Provides)
+    len += sizeof(U16) * 2 + static_cast<U32>(provide.ProvidesWithIndices.size() * sizeof(U16));
+  len += sizeof(U16);
+
+  return len;
+}
+
 
 } //namespace ClassFile
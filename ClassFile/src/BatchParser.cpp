@@ -0,0 +1,144 @@
+#include "ClassFile/BatchParser.hpp"
+
+#include "Util/ThreadPool.hpp"
+#include "Util/Error.hpp"
+
+#include <fmt/core.h>
+
+#include <algorithm>
+#include <thread>
+
+namespace ClassFile
+{
+
+static unsigned getThreadCount(const BatchOptions& opts)
+{
+  if(opts.Threads != 0)
+    return opts.Threads;
+
+  return std::max(1u, std::thread::hardware_concurrency());
+}
+
+BatchParser::BatchParser(const BatchOptions& opts)
+  : m_options{opts}, m_pool{std::make_unique<ThreadPool>(getThreadCount(opts))}
+{
+}
+
+BatchParser::~BatchParser() = default;
+
+unsigned BatchParser::GetThreadCount() const
+{
+  return m_pool->GetSize();
+}
+
+template <typename T, typename Func>
+BatchResult<T> BatchParser::run(size_t count, Func&& parse)
+{
+  BatchResult<T> result;
+
+  std::vector<ParseOptions> workerOpts(this->GetThreadCount(), m_options.Parse);
+
+  if(m_options.PerThreadArena)
+  {
+    result.m_arenas.reserve(workerOpts.size());
+
+    for(auto& opts : workerOpts)
+    {
+      result.m_arenas.emplace_back(std::make_unique<std::pmr::monotonic_buffer_resource>());
+      opts.Resource = result.m_arenas.back().get();
+    }
+  }
+
+  //every slot is overwritten by exactly one worker
+  result.m_results.reserve(count);
+  for(size_t i = 0; i < count; i++)
+    result.m_results.emplace_back(Error{"BatchParser: input was not parsed"});
+
+  m_pool->ForEach(count, [&](unsigned worker, size_t index)
+  {
+    result.m_results[index] = parse(index, workerOpts[worker]);
+  });
+
+  return result;
+}
+
+BatchResult<ClassFile> BatchParser::ParseBuffers(const std::vector<ByteView>& buffers)
+{
+  return run<ClassFile>(buffers.size(), [&](size_t index, const ParseOptions& opts)
+  {
+    return Parser::ParseClassFile(buffers[index].Data, buffers[index].Size, opts);
+  });
+}
+
+BatchResult<MappedClassFile> BatchParser::ParseFiles(const std::vector<std::string>& paths)
+{
+  return run<MappedClassFile>(paths.size(), [&](size_t index, const ParseOptions& opts)
+  {
+    return MappedClassFile::Load(paths[index], opts);
+  });
+}
+
+static bool isClassEntry(const ZipArchive::Entry& entry)
+{
+  constexpr std::string_view suffix = ".class";
+
+  return !entry.IsDirectory() 
+    && entry.Name.size() > suffix.size()
+    && entry.Name.compare(entry.Name.size() - suffix.size(), suffix.size(), suffix) == 0;
+}
+
+static ErrorOr<ArchivedClassFile> parseEntry(const ZipArchive& archive, 
+    const ZipArchive::Entry& entry, const ParseOptions& opts)
+{
+  if(entry.Method == ZipArchive::Stored)
+  {
+    auto errOrView = archive.View(entry);
+    VERIFY(errOrView);
+
+    auto errOrClass = Parser::ParseClassFile(errOrView.Get().Data, errOrView.Get().Size, opts);
+    VERIFY(errOrClass, fmt::format("failed to parse \"{}\"", entry.Name));
+
+    return ArchivedClassFile{entry.Name, errOrClass.Release()};
+  }
+
+  //inflated bytes live as long as the arena, so nodes may keep borrowing them
+  if(opts.Resource)
+  {
+    TRY(archive.CheckSize(entry));
+
+    U8* bytes = static_cast<U8*>(opts.Resource->allocate(entry.UncompressedSize, 1));
+    TRY(archive.Extract(entry, bytes));
+
+    auto errOrClass = Parser::ParseClassFile(bytes, entry.UncompressedSize, opts);
+    VERIFY(errOrClass, fmt::format("failed to parse \"{}\"", entry.Name));
+
+    return ArchivedClassFile{entry.Name, errOrClass.Release()};
+  }
+
+  auto errOrBytes = archive.Extract(entry);
+  VERIFY(errOrBytes);
+
+  ParseOptions owning = opts;
+  owning.BorrowBuffer = false;
+
+  auto errOrClass = Parser::ParseClassFile(errOrBytes.Get().data(), errOrBytes.Get().size(), owning);
+  VERIFY(errOrClass, fmt::format("failed to parse \"{}\"", entry.Name));
+
+  return ArchivedClassFile{entry.Name, errOrClass.Release()};
+}
+
+BatchResult<ArchivedClassFile> BatchParser::ParseArchive(const ZipArchive& archive)
+{
+  std::vector<const ZipArchive::Entry*> entries;
+
+  for(const auto& entry : archive.GetEntries())
+    if(isClassEntry(entry))
+      entries.push_back(&entry);
+
+  return run<ArchivedClassFile>(entries.size(), [&](size_t index, const ParseOptions& opts)
+  {
+    return parseEntry(archive, *entries[index], opts);
+  });
+}
+
+} //namespace ClassFile
@@ -0,0 +1,419 @@
+#include "ClassFile/ClassFilePatcher.hpp"
+
+#include "ClassFile/Parser.hpp"
+#include "ClassFile/Serializer.hpp"
+#include "ClassFile/Instruction.hpp"
+
+#include "Util/IO.hpp"
+#include "Util/Error.hpp"
+
+#include <fmt/core.h>
+
+#include <cstring>
+#include <limits>
+
+namespace ClassFile
+{
+
+//Size of a constant's body following its tag, 0 for unknown tags
+static size_t getConstantBodySize(const ByteReader& reader, U8 tag)
+{
+  switch(static_cast<CPInfo::Type>(tag))
+  {
+    case CPInfo::Type::Class:
+    case CPInfo::Type::String:
+    case CPInfo::Type::MethodType:
+      return 2;
+
+    case CPInfo::Type::MethodHandle:
+      return 3;
+
+    case CPInfo::Type::Fieldref:
+    case CPInfo::Type::Methodref:
+    case CPInfo::Type::InterfaceMethodref:
+    case CPInfo::Type::Integer:
+    case CPInfo::Type::Float:
+    case CPInfo::Type::NameAndType:
+    case CPInfo::Type::InvokeDynamic:
+      return 4;
+
+    case CPInfo::Type::Long:
+    case CPInfo::Type::Double:
+      return 8;
+
+    case CPInfo::Type::UTF8:
+    {
+      if(!reader.Has(sizeof(U16)))
+        return 0;
+
+      U16 length;
+      Load<BigEndian>(reader.Data() + reader.Tell(), length);
+      return sizeof(U16) + length;
+    }
+  }
+
+  return 0;
+}
+
+static ErrorOr<void> skip(ByteReader& reader, size_t n)
+{
+  auto errOrView = ReadView(reader, n);
+  VERIFY(errOrView);
+
+  return {};
+}
+
+//Moves past the attributes of a field, method or Code attribute, returns
+//the offset of the one named name if there's any, 0 otherwise
+static ErrorOr<U32> skipAttributes(ByteReader& reader, const ClassFilePatcher& patcher,
+    std::string_view name = {})
+{
+  U16 count;
+  TRY(Read<BigEndian>(reader, count));
+
+  U32 found{0};
+
+  for(U16 i = 0; i < count; i++)
+  {
+    U32 offset = static_cast<U32>(reader.Tell());
+
+    U16 nameIndex;
+    U32 length;
+    TRY(Read<BigEndian>(reader, nameIndex, length));
+    TRY(skip(reader, length));
+
+    if(name.empty() || found != 0)
+      continue;
+
+    auto errOrName = patcher.GetUTF8(nameIndex);
+    VERIFY(errOrName, "bad attribute name index");
+
+    if(errOrName.Get() == name)
+      found = offset;
+  }
+
+  return found;
+}
+
+ErrorOr<ClassFilePatcher> ClassFilePatcher::Create(std::vector<U8> bytes)
+{
+  ClassFilePatcher patcher;
+  patcher.m_bytes = std::move(bytes);
+
+  TRY(patcher.index());
+
+  return patcher;
+}
+
+ErrorOr<void> ClassFilePatcher::index()
+{
+  m_constants.clear();
+  m_methods.clear();
+
+  ByteReader reader{m_bytes.data(), m_bytes.size()};
+
+  U32 magic;
+  U16 minorVersion, majorVersion, constantCount;
+  TRY(Read<BigEndian>(reader, magic, minorVersion, majorVersion, constantCount));
+
+  if(magic != 0xCAFEBABE)
+    return Error{fmt::format("ClassFilePatcher: bad magic 0x{:x}", magic)};
+
+  m_constants.assign(constantCount, 0);
+
+  for(U16 i = 1; i < constantCount; i++)
+  {
+    U32 offset = static_cast<U32>(reader.Tell());
+
+    U8 tag;
+    TRY(Read<BigEndian>(reader, tag));
+
+    size_t size = getConstantBodySize(reader, tag);
+    if(size == 0)
+      return Error{fmt::format("ClassFilePatcher: unknown constant tag {} at 0x{:x}", tag, offset)};
+
+    TRY(skip(reader, size), fmt::format("truncated constant #{}", i));
+
+    m_constants[i] = offset;
+
+    //the slot following a Long or Double is unusable, but has to exist (i
+    //would wrap around otherwise)
+    auto type = static_cast<CPInfo::Type>(tag);
+    if(type == CPInfo::Type::Long || type == CPInfo::Type::Double)
+    {
+      if(i + 1 >= constantCount)
+        return Error{ErrorCode::InvalidConstantIndex, reader.Tell(), i + 1u, constantCount};
+
+      i++;
+    }
+  }
+
+  U16 accessFlags, thisClass, superClass, interfacesCount;
+  TRY(Read<BigEndian>(reader, accessFlags, thisClass, superClass, interfacesCount));
+  TRY(skip(reader, interfacesCount * sizeof(U16)));
+
+  U16 fieldsCount;
+  TRY(Read<BigEndian>(reader, fieldsCount));
+
+  for(U16 i = 0; i < fieldsCount; i++)
+  {
+    TRY(skip(reader, sizeof(U16) * 3));
+    TRY(skipAttributes(reader, *this));
+  }
+
+  U16 methodsCount;
+  TRY(Read<BigEndian>(reader, methodsCount));
+  m_methods.reserve(methodsCount);
+
+  for(U16 i = 0; i < methodsCount; i++)
+  {
+    Method method{};
+    method.Offset = static_cast<U32>(reader.Tell());
+
+    TRY(Read<BigEndian>(reader, method.AccessFlags, method.NameIndex, method.DescriptorIndex));
+
+    auto errOrCode = skipAttributes(reader, *this, "Code");
+    VERIFY(errOrCode, fmt::format("in method #{}", i));
+
+    if(U32 code = errOrCode.Get(); code != 0)
+    {
+      //attribute_name_index, attribute_length, max_stack, max_locals
+      ByteReader codeReader{m_bytes.data() + code, m_bytes.size() - code};
+      TRY(skip(codeReader, sizeof(U16) + sizeof(U32) + sizeof(U16) * 2));
+      TRY(Read<BigEndian>(codeReader, method.CodeLength));
+
+      if(!codeReader.Has(method.CodeLength))
+        return Error{fmt::format("ClassFilePatcher: code array of method #{} overruns its attribute", i)};
+
+      method.CodeOffset = code + static_cast<U32>(codeReader.Tell());
+    }
+
+    m_methods.push_back(method);
+  }
+
+  return {};
+}
+
+ErrorOr<U32> ClassFilePatcher::GetConstantOffset(U16 index) const
+{
+  if(index >= m_constants.size() || m_constants[index] == 0)
+    return Error{ErrorCode::InvalidConstantIndex, Error::NoOffset, index, m_constants.size()};
+
+  return m_constants[index];
+}
+
+ErrorOr<CPInfo::Type> ClassFilePatcher::GetConstantType(U16 index) const
+{
+  auto errOrOffset = this->GetConstantOffset(index);
+  VERIFY(errOrOffset);
+
+  return static_cast<CPInfo::Type>(m_bytes[errOrOffset.Get()]);
+}
+
+ErrorOr<U32> ClassFilePatcher::getConstant(U16 index, CPInfo::Type type) const
+{
+  auto errOrType = this->GetConstantType(index);
+  VERIFY(errOrType);
+
+  if(errOrType.Get() != type)
+    return Error{ErrorCode::ConstantTypeMismatch, m_constants[index], index, static_cast<U64>(type)};
+
+  //past the tag
+  return m_constants[index] + 1;
+}
+
+ErrorOr<std::string_view> ClassFilePatcher::GetUTF8(U16 index) const
+{
+  auto errOrOffset = this->getConstant(index, CPInfo::Type::UTF8);
+  VERIFY(errOrOffset);
+
+  const U8* ptr = m_bytes.data() + errOrOffset.Get();
+
+  U16 length;
+  Load<BigEndian>(ptr, length);
+
+  return std::string_view{reinterpret_cast<const char*>(ptr + sizeof(U16)), length};
+}
+
+ErrorOr<size_t> ClassFilePatcher::FindMethod(std::string_view name, std::string_view descriptor) const
+{
+  for(size_t i = 0; i < m_methods.size(); i++)
+  {
+    auto errOrName = this->GetUTF8(m_methods[i].NameIndex);
+    VERIFY(errOrName);
+
+    if(errOrName.Get() != name)
+      continue;
+
+    auto errOrDescriptor = this->GetUTF8(m_methods[i].DescriptorIndex);
+    VERIFY(errOrDescriptor);
+
+    if(errOrDescriptor.Get() == descriptor)
+      return i;
+  }
+
+  return Error{fmt::format("ClassFilePatcher: no method {}{}", name, descriptor)};
+}
+
+template <typename T, typename Bits>
+static ErrorOr<void> storeConstant(std::vector<U8>& bytes, ErrorOr<U32> errOrOffset, T value)
+{
+  VERIFY(errOrOffset);
+
+  Bits bits;
+  static_assert(sizeof(bits) == sizeof(value));
+  std::memcpy(&bits, &value, sizeof(bits));
+
+  Store<BigEndian>(bytes.data() + errOrOffset.Get(), bits);
+  return {};
+}
+
+ErrorOr<void> ClassFilePatcher::SetInteger(U16 index, S32 value)
+{
+  return storeConstant<S32, U32>(m_bytes, this->getConstant(index, CPInfo::Type::Integer), value);
+}
+
+ErrorOr<void> ClassFilePatcher::SetFloat(U16 index, float value)
+{
+  return storeConstant<float, U32>(m_bytes, this->getConstant(index, CPInfo::Type::Float), value);
+}
+
+ErrorOr<void> ClassFilePatcher::SetLong(U16 index, S64 value)
+{
+  return storeConstant<S64, U64>(m_bytes, this->getConstant(index, CPInfo::Type::Long), value);
+}
+
+ErrorOr<void> ClassFilePatcher::SetDouble(U16 index, double value)
+{
+  return storeConstant<double, U64>(m_bytes, this->getConstant(index, CPInfo::Type::Double), value);
+}
+
+ErrorOr<void> ClassFilePatcher::SetUTF8(U16 index, std::string_view value)
+{
+  if(value.size() > std::numeric_limits<U16>::max())
+    return Error{fmt::format("ClassFilePatcher: string of {} bytes is too long for a UTF8 constant", value.size())};
+
+  auto errOrCurrent = this->GetUTF8(index);
+  VERIFY(errOrCurrent);
+
+  if(errOrCurrent.Get().size() == value.size())
+  {
+    U8* dst = m_bytes.data() + m_constants[index] + 1 + sizeof(U16);
+    std::memcpy(dst, value.data(), value.size());
+    return {};
+  }
+
+  //Everything past the constant moves, reserialize. Unmodified fields,
+  //methods and attributes are copied verbatim from the current buffer.
+  ParseOptions opts;
+  opts.BorrowBuffer = true;
+  opts.RetainSource = true;
+  opts.LazyCode = true;
+
+  std::vector<U8> serialized;
+  {
+    auto errOrClass = Parser::ParseClassFile(m_bytes.data(), m_bytes.size(), opts);
+    VERIFY(errOrClass, "reparsing failed");
+    auto& cf = errOrClass.Get();
+
+    auto errOrUTF8 = cf.ConstPool.Get<UTF8Info>(index);
+    VERIFY(errOrUTF8);
+    errOrUTF8.Get()->SetString(std::string{value});
+
+    auto errOrBytes = Serializer::SerializeClassFile(cf);
+    VERIFY(errOrBytes, "reserializing failed");
+    serialized = errOrBytes.Release();
+  }
+
+  m_bytes = std::move(serialized);
+  return this->index();
+}
+
+ErrorOr<void> ClassFilePatcher::SetOperand(size_t methodIndex, U32 codeOffset, size_t operandIndex, S32 value)
+{
+  if(methodIndex >= m_methods.size())
+    return Error{fmt::format("ClassFilePatcher: invalid method index {}", methodIndex)};
+
+  const Method& method = m_methods[methodIndex];
+  if(method.CodeOffset == 0)
+    return Error{fmt::format("ClassFilePatcher: method #{} has no code", methodIndex)};
+
+  if(codeOffset >= method.CodeLength)
+    return Error{fmt::format("ClassFilePatcher: offset {} is past the code array of method #{}", codeOffset, methodIndex)};
+
+  const U8* code = m_bytes.data() + method.CodeOffset;
+
+  //Only the instruction itself is decoded, the walk up to it just checks
+  //that codeOffset is an instruction boundary
+  U32 pos{0};
+  while(pos < codeOffset)
+  {
+    auto errOrLength = Instruction::GetEncodedLength(code, method.CodeLength, pos);
+    VERIFY(errOrLength, fmt::format("failed to walk the code array of method #{}", methodIndex));
+
+    pos += static_cast<U32>(errOrLength.Get());
+  }
+
+  if(pos != codeOffset)
+    return Error{fmt::format("ClassFilePatcher: offset {} is not an instruction boundary", codeOffset)};
+
+  if(code[pos] >= Instruction::Opcode::_N)
+    return Error{fmt::format("ClassFilePatcher: invalid opcode 0x{:x} at {}", code[pos], pos)};
+
+  auto op = static_cast<Instruction::Opcode>(code[pos]);
+  if(Instruction::IsComplex(op))
+    return Error{fmt::format("ClassFilePatcher: can't patch {}", Instruction::GetMnemonic(op))};
+
+  if(operandIndex >= Instruction::GetNOperands(op))
+  {
+    return Error{fmt::format("ClassFilePatcher: {} has no operand #{}",
+        Instruction::GetMnemonic(op), operandIndex)};
+  }
+
+  if(pos + Instruction::GetLength(op) > method.CodeLength)
+    return Error{fmt::format("ClassFilePatcher: {} at {} overruns the code array", Instruction::GetMnemonic(op), pos)};
+
+  //operand offsets are relative to the end of the opcode
+  U8* dst = m_bytes.data() + method.CodeOffset + pos + 1 + Instruction::GetOperandOffset(op, operandIndex);
+
+  auto outOfRange = [&](auto min, auto max) -> ErrorOr<void>
+  {
+    return Error{fmt::format("ClassFilePatcher: {} doesn't fit operand #{} of {} ([{}, {}])",
+        value, operandIndex, Instruction::GetMnemonic(op), min, max)};
+  };
+
+  switch(Instruction::GetOperandType(op, operandIndex))
+  {
+    case Instruction::TypeS32:
+      Store<BigEndian>(dst, value);
+      break;
+
+    case Instruction::TypeS16:
+      if(value < std::numeric_limits<S16>::min() || value > std::numeric_limits<S16>::max())
+        return outOfRange(std::numeric_limits<S16>::min(), std::numeric_limits<S16>::max());
+      Store<BigEndian>(dst, static_cast<S16>(value));
+      break;
+
+    case Instruction::TypeS8:
+      if(value < std::numeric_limits<S8>::min() || value > std::numeric_limits<S8>::max())
+        return outOfRange(int{std::numeric_limits<S8>::min()}, int{std::numeric_limits<S8>::max()});
+      Store<BigEndian>(dst, static_cast<S8>(value));
+      break;
+
+    case Instruction::TypeU16:
+      if(value < 0 || value > std::numeric_limits<U16>::max())
+        return outOfRange(0, std::numeric_limits<U16>::max());
+      Store<BigEndian>(dst, static_cast<U16>(value));
+      break;
+
+    case Instruction::TypeU8:
+      if(value < 0 || value > std::numeric_limits<U8>::max())
+        return outOfRange(0, int{std::numeric_limits<U8>::max()});
+      Store<BigEndian>(dst, static_cast<U8>(value));
+      break;
+  }
+
+  return {};
+}
+
+} //namespace ClassFile
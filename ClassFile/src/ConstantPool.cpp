@@ -1,7 +1,6 @@
 #include "ClassFile/ConstantPool.hpp"
 #include "Util/Error.hpp"
 
-#include <fmt/core.h>
 
 #include <map>
 #include <cassert>
@@ -74,10 +73,25 @@ static ErrorOr<std::string_view> getNameByNameAndTypeIndex(U16 index, const Cons
 }
 
 ErrorOr<std::string_view> ConstantPool::LookupString(U16 index) const
+{
+  if(!m_resolved.empty() && index != 0 && index <= m_resolved.size())
+  {
+    std::string_view name = m_resolved[index-1].Name;
+
+    if(name.data() == nullptr)
+      return unresolvedError(index, ErrorCode::UnresolvedName);
+
+    return name;
+  }
+
+  return resolveString(index);
+}
+
+ErrorOr<std::string_view> ConstantPool::resolveString(U16 index) const
 {
   TRY(ensureValid(index));
 
-  switch(m_pool[index]->GetType())
+  switch(m_pool[index-1]->GetType())
   {
     case CPInfo::Type::String:
     case CPInfo::Type::UTF8:
@@ -101,9 +115,7 @@ ErrorOr<std::string_view> ConstantPool::LookupString(U16 index) const
       return getNameByNameAndTypeIndex<InvokeDynamicInfo>(index, *this);
   }
 
-  return Error{fmt::format("ConstantPool: Failed to lookup name "
-      "string for constant info entry and index {} (type: {})", 
-      index, m_pool[index]->GetName())};
+  return unresolvedError(index, ErrorCode::UnresolvedName);
 }
 
 template <typename T>
@@ -128,10 +140,25 @@ static ErrorOr<std::string_view> getDescriptorByNameAndTypeIndex(U16 index, cons
 }
 
 ErrorOr<std::string_view> ConstantPool::LookupDescriptor(U16 index) const
+{
+  if(!m_resolved.empty() && index != 0 && index <= m_resolved.size())
+  {
+    std::string_view descriptor = m_resolved[index-1].Descriptor;
+
+    if(descriptor.data() == nullptr)
+      return unresolvedError(index, ErrorCode::UnresolvedDescriptor);
+
+    return descriptor;
+  }
+
+  return resolveDescriptor(index);
+}
+
+ErrorOr<std::string_view> ConstantPool::resolveDescriptor(U16 index) const
 {
   TRY(ensureValid(index));
 
-  switch(m_pool[index]->GetType())
+  switch(m_pool[index-1]->GetType())
   {
     case CPInfo::Type::MethodType:
       return getDescriptor<MethodTypeInfo>(index, *this);
@@ -152,21 +179,117 @@ ErrorOr<std::string_view> ConstantPool::LookupDescriptor(U16 index) const
       return getDescriptorByNameAndTypeIndex<InvokeDynamicInfo>(index, *this);
   }
 
-  return Error{fmt::format("ConstantPool: Failed to lookup descriptor "
-      "string for constant info entry and index {} (type: {})", 
-      index, m_pool[index]->GetName())};
+  return unresolvedError(index, ErrorCode::UnresolvedDescriptor);
+}
+
+template <typename T>
+static ErrorOr<std::string_view> getOwner(U16 index, const ConstantPool& cp)
+{
+  auto errOrPtr = cp.Get<T>(index);
+  VERIFY(errOrPtr);
+
+  auto errOrSV = cp.LookupString(errOrPtr.Get()->ClassIndex);
+  VERIFY(errOrSV);
+
+  return errOrSV.Get();
+}
+
+ErrorOr<std::string_view> ConstantPool::LookupOwner(U16 index) const
+{
+  if(!m_resolved.empty() && index != 0 && index <= m_resolved.size())
+  {
+    std::string_view owner = m_resolved[index-1].Owner;
+
+    if(owner.data() == nullptr)
+      return unresolvedError(index, ErrorCode::UnresolvedOwner);
+
+    return owner;
+  }
+
+  return resolveOwner(index);
+}
+
+ErrorOr<std::string_view> ConstantPool::resolveOwner(U16 index) const
+{
+  TRY(ensureValid(index));
+
+  switch(m_pool[index-1]->GetType())
+  {
+    case CPInfo::Type::Fieldref:
+      return getOwner<FieldrefInfo>(index, *this);
+
+    case CPInfo::Type::Methodref:
+      return getOwner<MethodrefInfo>(index, *this);
+
+    case CPInfo::Type::InterfaceMethodref:
+      return getOwner<InterfaceMethodrefInfo>(index, *this);
+
+    default:
+      break;
+  }
+
+  return unresolvedError(index, ErrorCode::UnresolvedOwner);
+}
+
+void ConstantPool::BuildResolutionCache()
+{
+  //resolve against the pool itself, not a stale cache
+  m_resolved.clear();
+
+  std::vector<ResolvedEntry> resolved(m_pool.size());
+
+  for(size_t i = 0; i < m_pool.size(); i++)
+  {
+    if(m_pool[i] == nullptr)
+      continue;
+
+    U16 index = static_cast<U16>(i + 1);
+
+    if(auto errOrName = resolveString(index); !errOrName.IsError())
+      resolved[i].Name = errOrName.Get();
+
+    if(auto errOrDesc = resolveDescriptor(index); !errOrDesc.IsError())
+      resolved[i].Descriptor = errOrDesc.Get();
+
+    if(auto errOrOwner = resolveOwner(index); !errOrOwner.IsError())
+      resolved[i].Owner = errOrOwner.Get();
+  }
+
+  m_resolved = std::move(resolved);
+}
+
+void ConstantPool::ClearResolutionCache()
+{
+  m_resolved.clear();
+}
+
+bool ConstantPool::HasResolutionCache() const
+{
+  return !m_resolved.empty();
 }
 
 void ConstantPool::Add(std::unique_ptr<CPInfo>&& info) 
 {
+  m_resolved.clear();
   m_pool.emplace_back(std::move(info));
 }
 
 void ConstantPool::Add(CPInfo* info) 
 {
+  m_resolved.clear();
   m_pool.emplace_back( std::unique_ptr<CPInfo>{info} ); 
 }
 
+std::unique_ptr<CPInfo> ConstantPool::Release(U16 index)
+{
+  --index;
+  if(index >= this->GetSize())
+    return nullptr;
+
+  m_resolved.clear();
+  return std::move(m_pool[index]);
+}
+
 U16 ConstantPool::GetSize() const
 {
   return static_cast<U16>(m_pool.size());
@@ -180,7 +303,7 @@ U16 ConstantPool::GetCount() const
 CPInfo* ConstantPool::operator[](U16 index) 
 {
   --index;
-  if(index > this->GetSize())
+  if(index >= this->GetSize())
     return nullptr;
 
   return m_pool[index].get();
@@ -189,7 +312,7 @@ CPInfo* ConstantPool::operator[](U16 index)
 const CPInfo* ConstantPool::operator[](U16 index) const
 {
   --index;
-  if(index > this->GetSize())
+  if(index >= this->GetSize())
     return nullptr;
 
   return m_pool[index].get();
@@ -199,36 +322,36 @@ ErrorOr<std::string_view> ConstantPool::lookupStringOrUTF8(U16 index) const
 {
   TRY(ensureValid(index));
 
-  if(m_pool[index]->GetType() == CPInfo::Type::String)
+  if(m_pool[index-1]->GetType() == CPInfo::Type::String)
     return LookupString(this->Get<StringInfo>(index).Get()->StringIndex);
 
   auto errOrPtr = this->Get<UTF8Info>(index);
-  VERIFY(errOrPtr, fmt::format("ConstantPool: Failed to lookup string value for "
-        "constant info entry at index {} (type: {})", index, m_pool[index]->GetName()));
+  VERIFY(errOrPtr, "failed to lookup string value");
 
-  return std::string_view{errOrPtr.Get()->String};
+  return errOrPtr.Get()->GetString();
 }
 
 ErrorOr<void> ConstantPool::ensureValid(U16 index) const
 {
-  if(index >= m_pool.size() || index == 0)
+  if(index > m_pool.size() || index == 0)
   {
-    return Error{fmt::format("ConstantPool: "
-        "out-of-bounds access at index {}, valid index range for "
-        "pool is 1-{}", index, this->GetCount())};
+    return Error{ErrorCode::InvalidConstantIndex, Error::NoOffset, index, this->GetCount()};
   }
 
-  if(m_pool[index].get() == nullptr)
-    return Error{fmt::format("ConstantPool: pool[{}] is nullptr", index)};
+  if(m_pool[index-1].get() == nullptr)
+    return Error{ErrorCode::NullConstant, Error::NoOffset, index};
 
   return NoError{};
 }
 
-Error ConstantPool::failedCastError(U16 index, std::string_view castToName) const
+Error ConstantPool::unresolvedError(U16 index, ErrorCode code) const
+{
+  return Error{code, Error::NoOffset, index};
+}
+
+Error ConstantPool::failedCastError(U16 index, CPInfo::Type castTo) const
 {
-  return Error{fmt::format("ConstantPool: " 
-      "invalid type cast access at index {}"
-      ", failed to cast to type \"{}\"", index, castToName)};
+  return Error{ErrorCode::ConstantTypeMismatch, Error::NoOffset, index, static_cast<U64>(castTo)};
 }
 
 } //namespace ClassFile
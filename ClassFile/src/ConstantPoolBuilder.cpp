@@ -0,0 +1,350 @@
+#include "ClassFile/ConstantPoolBuilder.hpp"
+#include "Util/Error.hpp"
+
+#include <fmt/core.h>
+
+#include <cstring>
+
+namespace ClassFile
+{
+
+using Type = CPInfo::Type;
+
+//highest usable index, constant_pool_count is a U16 and counts one past the last entry
+static constexpr U32 maxIndex = 0xFFFF - 1;
+
+ConstantPoolBuilder::ConstantPoolBuilder(ConstantPool&& pool)
+: m_pool{std::move(pool)}
+{
+  for(U16 i = 1; i < m_pool.GetCount(); i++)
+  {
+    if(const CPInfo* info = m_pool[i])
+      this->index(i, *info);
+  }
+}
+
+ConstantPool ConstantPoolBuilder::Release()
+{
+  m_utf8.clear();
+  m_entries.clear();
+
+  return std::move(m_pool);
+}
+
+bool ConstantPoolBuilder::makeKey(const CPInfo& info, Key& key)
+{
+  key = Key{info.GetType(), 0, 0, 0};
+
+  switch(info.GetType())
+  {
+    case Type::Class:
+      key.First = static_cast<const ClassInfo&>(info).NameIndex;
+      return true;
+
+    case Type::Fieldref:
+      key.First = static_cast<const FieldrefInfo&>(info).ClassIndex;
+      key.Second = static_cast<const FieldrefInfo&>(info).NameAndTypeIndex;
+      return true;
+
+    case Type::Methodref:
+      key.First = static_cast<const MethodrefInfo&>(info).ClassIndex;
+      key.Second = static_cast<const MethodrefInfo&>(info).NameAndTypeIndex;
+      return true;
+
+    case Type::InterfaceMethodref:
+      key.First = static_cast<const InterfaceMethodrefInfo&>(info).ClassIndex;
+      key.Second = static_cast<const InterfaceMethodrefInfo&>(info).NameAndTypeIndex;
+      return true;
+
+    case Type::String:
+      key.First = static_cast<const StringInfo&>(info).StringIndex;
+      return true;
+
+    case Type::Integer:
+      key.First = static_cast<const IntegerInfo&>(info).Bytes;
+      return true;
+
+    case Type::Float:
+      key.First = static_cast<const FloatInfo&>(info).Bytes;
+      return true;
+
+    case Type::Long:
+      key.First = static_cast<const LongInfo&>(info).HighBytes;
+      key.Second = static_cast<const LongInfo&>(info).LowBytes;
+      return true;
+
+    case Type::Double:
+      key.First = static_cast<const DoubleInfo&>(info).HighBytes;
+      key.Second = static_cast<const DoubleInfo&>(info).LowBytes;
+      return true;
+
+    case Type::NameAndType:
+      key.First = static_cast<const NameAndTypeInfo&>(info).NameIndex;
+      key.Second = static_cast<const NameAndTypeInfo&>(info).DescriptorIndex;
+      return true;
+
+    case Type::MethodHandle:
+      key.Extra = static_cast<const MethodHandleInfo&>(info).ReferenceKind;
+      key.First = static_cast<const MethodHandleInfo&>(info).ReferenceIndex;
+      return true;
+
+    case Type::MethodType:
+      key.First = static_cast<const MethodTypeInfo&>(info).DescriptorIndex;
+      return true;
+
+    case Type::InvokeDynamic:
+      key.First = static_cast<const InvokeDynamicInfo&>(info).BootstrapMethodAttrIndex;
+      key.Second = static_cast<const InvokeDynamicInfo&>(info).NameAndTypeIndex;
+      return true;
+
+    case Type::UTF8:
+      break;
+  }
+
+  //UTF8 constants are keyed by their text instead
+  return false;
+}
+
+void ConstantPoolBuilder::index(U16 index, const CPInfo& info)
+{
+  //emplace keeps the first of any duplicates already in the pool
+  if(info.GetType() == Type::UTF8)
+  {
+    m_utf8.emplace(static_cast<const UTF8Info&>(info).GetString(), index);
+    return;
+  }
+
+  Key key;
+  if(makeKey(info, key))
+    m_entries.emplace(key, index);
+}
+
+template <typename T>
+static CPInfo* cloneT(const CPInfo& info)
+{
+  return new T(static_cast<const T&>(info));
+}
+
+static CPInfo* clone(const CPInfo& info)
+{
+  switch(info.GetType())
+  {
+    case Type::Class:              return cloneT<ClassInfo>(info);
+    case Type::Fieldref:           return cloneT<FieldrefInfo>(info);
+    case Type::Methodref:          return cloneT<MethodrefInfo>(info);
+    case Type::InterfaceMethodref: return cloneT<InterfaceMethodrefInfo>(info);
+    case Type::String:             return cloneT<StringInfo>(info);
+    case Type::Integer:            return cloneT<IntegerInfo>(info);
+    case Type::Float:              return cloneT<FloatInfo>(info);
+    case Type::Long:               return cloneT<LongInfo>(info);
+    case Type::Double:             return cloneT<DoubleInfo>(info);
+    case Type::NameAndType:        return cloneT<NameAndTypeInfo>(info);
+    case Type::UTF8:               return cloneT<UTF8Info>(info);
+    case Type::MethodHandle:       return cloneT<MethodHandleInfo>(info);
+    case Type::MethodType:         return cloneT<MethodTypeInfo>(info);
+    case Type::InvokeDynamic:      return cloneT<InvokeDynamicInfo>(info);
+  }
+
+  return nullptr;
+}
+
+ErrorOr<U16> ConstantPoolBuilder::getOrAdd(const Key& key, CPInfo* info)
+{
+  std::unique_ptr<CPInfo> owned{info};
+
+  //Long & Double constants take up two indices
+  bool wide = key.Tag == Type::Long || key.Tag == Type::Double;
+  U32 index = U32{m_pool.GetSize()} + 1;
+
+  if(index + (wide ? 1 : 0) > maxIndex)
+  {
+    return Error{fmt::format("ConstantPoolBuilder: unable to add {} constant, "
+        "pool is full ({} entries)", CPInfo::GetTypeName(key.Tag), m_pool.GetSize())};
+  }
+
+  m_pool.Add(std::move(owned));
+
+  if(wide)
+    m_pool.Add(nullptr);
+
+  m_entries.emplace(key, static_cast<U16>(index));
+  return static_cast<U16>(index);
+}
+
+ErrorOr<U16> ConstantPoolBuilder::GetOrAdd(const CPInfo& info)
+{
+  if(info.GetType() == Type::UTF8)
+    return GetOrAddUTF8(static_cast<const UTF8Info&>(info).GetString());
+
+  Key key;
+  makeKey(info, key);
+
+  if(auto itr = m_entries.find(key); itr != m_entries.end())
+    return itr->second;
+
+  return getOrAdd(key, clone(info));
+}
+
+ErrorOr<U16> ConstantPoolBuilder::GetOrAddUTF8(std::string_view str)
+{
+  if(auto itr = m_utf8.find(str); itr != m_utf8.end())
+    return itr->second;
+
+  if(str.size() > 0xFFFF)
+  {
+    return Error{fmt::format("ConstantPoolBuilder: UTF8 constant of {} bytes "
+        "exceeds the maximum length of 65535", str.size())};
+  }
+
+  U32 index = U32{m_pool.GetSize()} + 1;
+
+  if(index > maxIndex)
+  {
+    return Error{fmt::format("ConstantPoolBuilder: unable to add UTF8 constant, "
+        "pool is full ({} entries)", m_pool.GetSize())};
+  }
+
+  UTF8Info* info = new UTF8Info{};
+  info->SetString(std::string{str});
+  m_pool.Add(info);
+
+  //view the node's own copy, which stays put for as long as the pool does
+  m_utf8.emplace(info->GetString(), static_cast<U16>(index));
+  return static_cast<U16>(index);
+}
+
+ErrorOr<U16> ConstantPoolBuilder::GetOrAddString(std::string_view str)
+{
+  auto errOrUTF8 = GetOrAddUTF8(str);
+  VERIFY(errOrUTF8);
+
+  StringInfo info;
+  info.StringIndex = errOrUTF8.Get();
+  return GetOrAdd(info);
+}
+
+ErrorOr<U16> ConstantPoolBuilder::GetOrAddClass(std::string_view name)
+{
+  auto errOrName = GetOrAddUTF8(name);
+  VERIFY(errOrName);
+
+  ClassInfo info;
+  info.NameIndex = errOrName.Get();
+  return GetOrAdd(info);
+}
+
+ErrorOr<U16> ConstantPoolBuilder::GetOrAddInteger(S32 value)
+{
+  IntegerInfo info;
+  info.Bytes = static_cast<U32>(value);
+  return GetOrAdd(info);
+}
+
+ErrorOr<U16> ConstantPoolBuilder::GetOrAddFloat(float value)
+{
+  //keyed by bit pattern, so -0.0f and distinct NaNs stay distinct
+  FloatInfo info;
+  std::memcpy(&info.Bytes, &value, sizeof(info.Bytes));
+  return GetOrAdd(info);
+}
+
+ErrorOr<U16> ConstantPoolBuilder::GetOrAddLong(S64 value)
+{
+  U64 bits = static_cast<U64>(value);
+
+  LongInfo info;
+  info.HighBytes = static_cast<U32>(bits >> 32);
+  info.LowBytes = static_cast<U32>(bits);
+  return GetOrAdd(info);
+}
+
+ErrorOr<U16> ConstantPoolBuilder::GetOrAddDouble(double value)
+{
+  U64 bits;
+  std::memcpy(&bits, &value, sizeof(bits));
+
+  DoubleInfo info;
+  info.HighBytes = static_cast<U32>(bits >> 32);
+  info.LowBytes = static_cast<U32>(bits);
+  return GetOrAdd(info);
+}
+
+ErrorOr<U16> ConstantPoolBuilder::GetOrAddNameAndType(std::string_view name, std::string_view descriptor)
+{
+  auto errOrName = GetOrAddUTF8(name);
+  VERIFY(errOrName);
+
+  auto errOrDesc = GetOrAddUTF8(descriptor);
+  VERIFY(errOrDesc);
+
+  NameAndTypeInfo info;
+  info.NameIndex = errOrName.Get();
+  info.DescriptorIndex = errOrDesc.Get();
+  return GetOrAdd(info);
+}
+
+template <typename RefT>
+static ErrorOr<U16> getOrAddRef(ConstantPoolBuilder& builder, std::string_view owner, 
+    std::string_view name, std::string_view descriptor)
+{
+  auto errOrClass = builder.GetOrAddClass(owner);
+  VERIFY(errOrClass);
+
+  auto errOrNAT = builder.GetOrAddNameAndType(name, descriptor);
+  VERIFY(errOrNAT);
+
+  RefT info;
+  info.ClassIndex = errOrClass.Get();
+  info.NameAndTypeIndex = errOrNAT.Get();
+  return builder.GetOrAdd(info);
+}
+
+ErrorOr<U16> ConstantPoolBuilder::GetOrAddFieldref(std::string_view owner, 
+    std::string_view name, std::string_view descriptor)
+{
+  return getOrAddRef<FieldrefInfo>(*this, owner, name, descriptor);
+}
+
+ErrorOr<U16> ConstantPoolBuilder::GetOrAddMethodref(std::string_view owner, 
+    std::string_view name, std::string_view descriptor)
+{
+  return getOrAddRef<MethodrefInfo>(*this, owner, name, descriptor);
+}
+
+ErrorOr<U16> ConstantPoolBuilder::GetOrAddInterfaceMethodref(std::string_view owner, 
+    std::string_view name, std::string_view descriptor)
+{
+  return getOrAddRef<InterfaceMethodrefInfo>(*this, owner, name, descriptor);
+}
+
+ErrorOr<U16> ConstantPoolBuilder::GetOrAddMethodType(std::string_view descriptor)
+{
+  auto errOrDesc = GetOrAddUTF8(descriptor);
+  VERIFY(errOrDesc);
+
+  MethodTypeInfo info;
+  info.DescriptorIndex = errOrDesc.Get();
+  return GetOrAdd(info);
+}
+
+ErrorOr<U16> ConstantPoolBuilder::GetOrAddMethodHandle(U8 referenceKind, U16 referenceIndex)
+{
+  MethodHandleInfo info;
+  info.ReferenceKind = referenceKind;
+  info.ReferenceIndex = referenceIndex;
+  return GetOrAdd(info);
+}
+
+ErrorOr<U16> ConstantPoolBuilder::GetOrAddInvokeDynamic(U16 bootstrapMethodAttrIndex, 
+    std::string_view name, std::string_view descriptor)
+{
+  auto errOrNAT = GetOrAddNameAndType(name, descriptor);
+  VERIFY(errOrNAT);
+
+  InvokeDynamicInfo info;
+  info.BootstrapMethodAttrIndex = bootstrapMethodAttrIndex;
+  info.NameAndTypeIndex = errOrNAT.Get();
+  return GetOrAdd(info);
+}
+
+} //namespace ClassFile
@@ -0,0 +1,904 @@
+#include "ClassFile/ConstantPoolRewriter.hpp"
+#include "ClassFile/Parser.hpp"
+
+#include "Util/Error.hpp"
+
+#include <algorithm>
+#include <limits>
+#include <vector>
+
+namespace ClassFile
+{
+
+//Every index held anywhere is passed to visit as a U16&, which may change it.
+//0 is passed on as well, where it stands for "none" (e.g. the outer class of
+//an anonymous InnerClass).
+template <typename Visit>
+static ErrorOr<void> visitAttributes(std::vector< std::unique_ptr<AttributeInfo> >&, Visit&);
+
+template <typename Visit>
+static ErrorOr<void> visitConstant(CPInfo& info, Visit& visit)
+{
+  switch(info.GetType())
+  {
+    case CPInfo::Type::Class:
+      return visit(static_cast<ClassInfo&>(info).NameIndex);
+
+    case CPInfo::Type::Fieldref:
+      TRY(visit(static_cast<FieldrefInfo&>(info).ClassIndex));
+      return visit(static_cast<FieldrefInfo&>(info).NameAndTypeIndex);
+
+    case CPInfo::Type::Methodref:
+      TRY(visit(static_cast<MethodrefInfo&>(info).ClassIndex));
+      return visit(static_cast<MethodrefInfo&>(info).NameAndTypeIndex);
+
+    case CPInfo::Type::InterfaceMethodref:
+      TRY(visit(static_cast<InterfaceMethodrefInfo&>(info).ClassIndex));
+      return visit(static_cast<InterfaceMethodrefInfo&>(info).NameAndTypeIndex);
+
+    case CPInfo::Type::String:
+      return visit(static_cast<StringInfo&>(info).StringIndex);
+
+    case CPInfo::Type::NameAndType:
+      TRY(visit(static_cast<NameAndTypeInfo&>(info).NameIndex));
+      return visit(static_cast<NameAndTypeInfo&>(info).DescriptorIndex);
+
+    case CPInfo::Type::MethodHandle:
+      return visit(static_cast<MethodHandleInfo&>(info).ReferenceIndex);
+
+    case CPInfo::Type::MethodType:
+      return visit(static_cast<MethodTypeInfo&>(info).DescriptorIndex);
+
+    //BootstrapMethodAttrIndex indexes the BootstrapMethods attribute
+    case CPInfo::Type::InvokeDynamic:
+      return visit(static_cast<InvokeDynamicInfo&>(info).NameAndTypeIndex);
+
+    case CPInfo::Type::Integer:
+    case CPInfo::Type::Float:
+    case CPInfo::Type::Long:
+    case CPInfo::Type::Double:
+    case CPInfo::Type::UTF8:
+      break;
+  }
+
+  return {};
+}
+
+template <typename Visit>
+static ErrorOr<void> visitIndices(std::vector<U16>& indices, Visit& visit)
+{
+  for(U16& index : indices)
+    TRY(visit(index));
+
+  return {};
+}
+
+template <typename Visit>
+static ErrorOr<void> visitAnnotation(Annotation&, Visit&);
+
+template <typename Visit>
+static ErrorOr<void> visitElementValue(ElementValue& value, Visit& visit)
+{
+  //Index is unused (0) for nested annotations & arrays
+  TRY(visit(value.Index));
+  TRY(visit(value.ConstNameIndex));
+
+  if(value.AnnotationValue)
+    TRY(visitAnnotation(*value.AnnotationValue, visit));
+
+  for(ElementValue& element : value.ArrayValue)
+    TRY(visitElementValue(element, visit));
+
+  return {};
+}
+
+template <typename Visit>
+static ErrorOr<void> visitAnnotation(Annotation& annotation, Visit& visit)
+{
+  TRY(visit(annotation.TypeIndex));
+
+  for(auto& pair : annotation.ElementValuePairs)
+  {
+    TRY(visit(pair.ElementNameIndex));
+    TRY(visitElementValue(pair.Value, visit));
+  }
+
+  return {};
+}
+
+template <typename Visit>
+static ErrorOr<void> visitCode(CodeAttribute& attr, Visit& visit)
+{
+  for(Instruction& instr : attr.Code)
+  {
+    if(!instr.ReferencesConstant())
+      continue;
+
+    auto errOrIndex = instr.GetOperand(0);
+    VERIFY(errOrIndex);
+
+    U16 index = static_cast<U16>(errOrIndex.Get());
+    TRY(visit(index));
+    TRY(instr.SetOperand(0, index));
+  }
+
+  for(auto& handler : attr.ExceptionTable)
+    TRY(visit(handler.CatchType));
+
+  return visitAttributes(attr.Attributes, visit);
+}
+
+template <typename Visit>
+static ErrorOr<void> visitAttribute(AttributeInfo& info, Visit& visit)
+{
+  using Type = AttributeInfo::Type;
+
+  TRY(visit(info.NameIndex));
+
+  switch(info.GetType())
+  {
+    case Type::ConstantValue:
+      return visit(static_cast<ConstantValueAttribute&>(info).Index);
+
+    case Type::Code:
+      return visitCode(static_cast<CodeAttribute&>(info), visit);
+
+    case Type::StackMapTable:
+    {
+      auto visitTypes = [&](std::vector<StackMapTableAttribute::VerificationType>& types) -> ErrorOr<void>
+      {
+        for(auto& type : types)
+        {
+          if(type.Tag == StackMapTableAttribute::VerificationType::Item::Object)
+            TRY(visit(type.Data));
+        }
+
+        return {};
+      };
+
+      for(auto& frame : static_cast<StackMapTableAttribute&>(info).Entries)
+      {
+        TRY(visitTypes(frame.Locals));
+        TRY(visitTypes(frame.Stack));
+      }
+
+      return {};
+    }
+
+    case Type::Exceptions:
+    case Type::NestMembers:
+    case Type::PermittedSubclasses:
+    case Type::ModulePackages:
+      return visitIndices(static_cast<IndexTableAttribute&>(info).Indices, visit);
+
+    case Type::InnerClasses:
+    {
+      for(auto& inner : static_cast<InnerClassesAttribute&>(info).Classes)
+      {
+        TRY(visit(inner.InnerClassInfoIndex));
+        TRY(visit(inner.OuterClassInfoIndex));
+        TRY(visit(inner.InnerNameIndex));
+      }
+
+      return {};
+    }
+
+    case Type::EnclosingMethod:
+    {
+      auto& attr = static_cast<EnclosingMethodAttribute&>(info);
+      TRY(visit(attr.ClassIndex));
+      return visit(attr.MethodIndex);
+    }
+
+    case Type::Signature:
+      return visit(static_cast<SignatureAttribute&>(info).SignatureIndex);
+
+    case Type::SourceFile:
+      return visit(static_cast<SourceFileAttribute&>(info).SourceFileIndex);
+
+    case Type::LocalVariableTable:
+    {
+      for(auto& var : static_cast<LocalVariableTableAttribute&>(info).LocalVariableTable)
+      {
+        TRY(visit(var.NameIndex));
+        TRY(visit(var.DescriptorIndex));
+      }
+
+      return {};
+    }
+
+    case Type::LocalVariableTypeTable:
+    {
+      for(auto& var : static_cast<LocalVariableTypeTableAttribute&>(info).LocalVariableTypeTable)
+      {
+        TRY(visit(var.NameIndex));
+        TRY(visit(var.SignatureIndex));
+      }
+
+      return {};
+    }
+
+    case Type::RuntimeVisibleAnnotations:
+    case Type::RuntimeInvisibleAnnotations:
+    {
+      for(Annotation& annotation : static_cast<AnnotationsAttribute&>(info).Annotations)
+        TRY(visitAnnotation(annotation, visit));
+
+      return {};
+    }
+
+    case Type::RuntimeVisibleParameterAnnotations:
+    case Type::RuntimeInvisibleParameterAnnotations:
+    {
+      for(auto& annotations : static_cast<ParameterAnnotationsAttribute&>(info).ParameterAnnotations)
+      {
+        for(Annotation& annotation : annotations)
+          TRY(visitAnnotation(annotation, visit));
+      }
+
+      return {};
+    }
+
+    //target_info & type_path hold no indices
+    case Type::RuntimeVisibleTypeAnnotations:
+    case Type::RuntimeInvisibleTypeAnnotations:
+    {
+      for(TypeAnnotation& annotation : static_cast<TypeAnnotationsAttribute&>(info).Annotations)
+        TRY(visitAnnotation(annotation, visit));
+
+      return {};
+    }
+
+    case Type::AnnotationDefault:
+      return visitElementValue(static_cast<AnnotationDefaultAttribute&>(info).DefaultValue, visit);
+
+    case Type::BootstrapMethods:
+    {
+      for(auto& method : static_cast<BootstrapMethodsAttribute&>(info).BootstrapMethods)
+      {
+        TRY(visit(method.BootstrapMethodRef));
+        TRY(visitIndices(method.BootstrapArguments, visit));
+      }
+
+      return {};
+    }
+
+    case Type::MethodParameters:
+    {
+      for(auto& param : static_cast<MethodParametersAttribute&>(info).Parameters)
+        TRY(visit(param.NameIndex));
+
+      return {};
+    }
+
+    case Type::Module:
+    {
+      auto& attr = static_cast<ModuleAttribute&>(info);
+      TRY(visit(attr.ModuleNameIndex));
+      TRY(visit(attr.ModuleVersionIndex));
+
+      for(auto& require : attr.Requires)
+      {
+        TRY(visit(require.RequiresIndex));
+        TRY(visit(require.RequiresVersionIndex));
+      }
+
+      for(auto* packages : {&attr.Exports, &attr.Opens})
+      {
+        for(auto& package : *packages)
+        {
+          TRY(visit(package.Index));
+          TRY(visitIndices(package.ToIndices, visit));
+        }
+      }
+
+      TRY(visitIndices(attr.Uses, visit));
+
+      for(auto& provide : attr.Provides)
+      {
+        TRY(visit(provide.ProvidesIndex));
+        TRY(visitIndices(provide.ProvidesWithIndices, visit));
+      }
+
+      return {};
+    }
+
+    case Type::ModuleMainClass:
+      return visit(static_cast<ModuleMainClassAttribute&>(info).MainClassIndex);
+
+    case Type::NestHost:
+      return visit(static_cast<NestHostAttribute&>(info).HostClassIndex);
+
+    case Type::Record:
+    {
+      for(auto& component : static_cast<RecordAttribute&>(info).Components)
+      {
+        TRY(visit(component.NameIndex));
+        TRY(visit(component.DescriptorIndex));
+        TRY(visitAttributes(component.Attributes, visit));
+      }
+
+      return {};
+    }
+
+    case Type::Synthetic:
+    case Type::Deprecated:
+    case Type::LineNumberTable:
+    case Type::SourceDebugExtension:
+      return {};
+
+    //rejected by decodeAll()
+    case Type::Raw:
+      break;
+  }
+
+  return Error{ErrorCode::UnknownAttribute};
+}
+
+template <typename Visit>
+static ErrorOr<void> visitAttributes(std::vector< std::unique_ptr<AttributeInfo> >& attrs, Visit& visit)
+{
+  for(auto& attr : attrs)
+    TRY(visitAttribute(*attr, visit));
+
+  return {};
+}
+
+//Everything but the constant pool's own entries
+template <typename Visit>
+static ErrorOr<void> visitClassFile(ClassFile& cf, Visit& visit)
+{
+  TRY(visit(cf.ThisClass));
+  TRY(visit(cf.SuperClass));
+  TRY(visitIndices(cf.Interfaces, visit));
+
+  for(auto* members : {&cf.Fields, &cf.Methods})
+  {
+    for(FieldMethodInfo& member : *members)
+    {
+      TRY(visit(member.NameIndex));
+      TRY(visit(member.DescriptorIndex));
+      TRY(visitAttributes(member.Attributes, visit));
+    }
+  }
+
+  return visitAttributes(cf.Attributes, visit);
+}
+
+//Decodes every lazily parsed attribute, fails on the ones whose indices
+//can't be known
+static ErrorOr<void> decodeAll(std::vector< std::unique_ptr<AttributeInfo> >& attrs,
+    const ConstantPool& constPool)
+{
+  for(auto& attr : attrs)
+  {
+    if(attr->GetType() == AttributeInfo::Type::Raw)
+    {
+      Error err{ErrorCode::UnknownAttribute};
+
+      auto errOrName = constPool.LookupString(attr->NameIndex);
+      if(!errOrName.IsError())
+        err.AddFrame(__func__, errOrName.Get());
+
+      return err;
+    }
+
+    TRY(Parser::DecodeAttribute(*attr, constPool));
+
+    if(attr->GetType() == AttributeInfo::Type::Code)
+    {
+      TRY(decodeAll(static_cast<CodeAttribute&>(*attr).Attributes, constPool));
+    }
+    else if(attr->GetType() == AttributeInfo::Type::Record)
+    {
+      for(auto& component : static_cast<RecordAttribute&>(*attr).Components)
+        TRY(decodeAll(component.Attributes, constPool));
+    }
+  }
+
+  return {};
+}
+
+static ErrorOr<void> decodeAll(ClassFile& cf)
+{
+  for(auto* members : {&cf.Fields, &cf.Methods})
+  {
+    for(FieldMethodInfo& member : *members)
+      TRY(decodeAll(member.Attributes, cf.ConstPool));
+  }
+
+  return decodeAll(cf.Attributes, cf.ConstPool);
+}
+
+static void markDirty(std::vector< std::unique_ptr<AttributeInfo> >& attrs)
+{
+  for(auto& attr : attrs)
+  {
+    attr->MarkDirty();
+
+    if(attr->GetType() == AttributeInfo::Type::Code)
+    {
+      markDirty(static_cast<CodeAttribute&>(*attr).Attributes);
+    }
+    else if(attr->GetType() == AttributeInfo::Type::Record)
+    {
+      for(auto& component : static_cast<RecordAttribute&>(*attr).Components)
+        markDirty(component.Attributes);
+    }
+  }
+}
+
+static void markDirty(ClassFile& cf)
+{
+  for(auto* members : {&cf.Fields, &cf.Methods})
+  {
+    for(FieldMethodInfo& member : *members)
+    {
+      member.MarkDirty();
+      markDirty(member.Attributes);
+    }
+  }
+
+  markDirty(cf.Attributes);
+}
+
+static bool isWide(const CPInfo& info)
+{
+  return info.GetType() == CPInfo::Type::Long || info.GetType() == CPInfo::Type::Double;
+}
+
+//Moves every entry to newIndices[index] (0 drops it) and rewrites all
+//indices, newIndices has to map onto 1..count-1 without gaps but the
+//second slots of Long & Double entries
+static ErrorOr<void> renumber(ClassFile& cf, const std::vector<U16>& newIndices, U16 count)
+{
+  ConstantPool& oldPool = cf.ConstPool;
+
+  //0 stays 0 for optional indices, anything else has to name a kept entry
+  auto remap = [&](U16& index) -> ErrorOr<void>
+  {
+    if(index >= newIndices.size() || (index != 0 && newIndices[index] == 0))
+      return Error{ErrorCode::InvalidConstantIndex, Error::NoOffset, index, newIndices.size()};
+
+    index = newIndices[index];
+    return {};
+  };
+
+  TRY(visitClassFile(cf, remap));
+
+  std::vector< std::unique_ptr<CPInfo> > entries(count);
+
+  for(U16 i = 1; i < oldPool.GetCount(); i++)
+  {
+    if(newIndices[i] == 0)
+      continue;
+
+    entries[newIndices[i]] = oldPool.Release(i);
+    TRY(visitConstant(*entries[newIndices[i]], remap));
+  }
+
+  bool cached = oldPool.HasResolutionCache();
+
+  ConstantPool pool;
+  pool.Reserve(count - 1);
+
+  for(U16 i = 1; i < count; i++)
+    pool.Add(std::move(entries[i]));
+
+  if(cached)
+    pool.BuildResolutionCache();
+
+  cf.ConstPool = std::move(pool);
+  markDirty(cf);
+
+  return {};
+}
+
+ErrorOr<U16> ConstantPoolRewriter::Compact(ClassFile& cf)
+{
+  TRY(decodeAll(cf));
+
+  const ConstantPool& pool = cf.ConstPool;
+
+  std::vector<bool> live(pool.GetCount(), false);
+  std::vector<U16> pending;
+
+  auto mark = [&](U16& index) -> ErrorOr<void>
+  {
+    if(index == 0 || (index < live.size() && live[index]))
+      return {};
+
+    //rejects OOB indices & the second slot of a Long or Double
+    TRY(pool.Get(index));
+
+    live[index] = true;
+    pending.push_back(index);
+    return {};
+  };
+
+  TRY(visitClassFile(cf, mark));
+
+  while(!pending.empty())
+  {
+    U16 index = pending.back();
+    pending.pop_back();
+
+    TRY(visitConstant(*cf.ConstPool[index], mark));
+  }
+
+  std::vector<U16> newIndices(pool.GetCount(), 0);
+  U16 count = 1;
+
+  for(U16 i = 1; i < pool.GetCount(); i++)
+  {
+    if(!live[i])
+      continue;
+
+    newIndices[i] = count;
+    count += isWide(*pool[i]) ? 2 : 1;
+  }
+
+  U16 removed = pool.GetCount() - count;
+
+  if(removed != 0)
+    TRY(renumber(cf, newIndices, count));
+
+  return removed;
+}
+
+//Old to new offsets into a code array whose instructions changed length.
+//Offsets inside an instruction keep their distance to its start (up to its
+//new length), offsets past the end move with the end.
+class CodeRelocation
+{
+  public:
+    CodeRelocation(const std::vector<U32>& oldOffsets, const std::vector<U32>& newOffsets)
+      : m_map(oldOffsets.back() + 1), m_shrink{oldOffsets.back() - newOffsets.back()}
+    {
+      for(size_t i = 0; i + 1 < oldOffsets.size(); i++)
+      {
+        U32 newLength = newOffsets[i+1] - newOffsets[i];
+
+        for(U32 offset = oldOffsets[i]; offset < oldOffsets[i+1]; offset++)
+          m_map[offset] = newOffsets[i] + std::min(offset - oldOffsets[i], newLength - 1);
+      }
+
+      m_map.back() = newOffsets.back();
+    }
+
+    U32 operator()(U32 offset) const
+    {
+      if(offset >= m_map.size())
+        return offset - m_shrink;
+
+      return m_map[offset];
+    }
+
+    U16 operator()(U16 offset) const { return static_cast<U16>((*this)(U32{offset})); }
+
+    //Relocates an offset relative to an instruction at oldBase, now at newBase
+    S64 Relative(U32 oldBase, U32 newBase, S32 relative) const
+    {
+      S64 target = S64{oldBase} + relative;
+
+      if(target < 0)
+        return relative;
+
+      return S64{(*this)(static_cast<U32>(target))} - newBase;
+    }
+
+  private:
+    std::vector<U32> m_map;
+    U32 m_shrink;
+};
+
+//Local variable ranges are a start and a length
+template <typename Range>
+static void relocateRange(const CodeRelocation& relocate, Range& range)
+{
+  U16 end = relocate(static_cast<U16>(range.StartPC + range.Length));
+  range.StartPC = relocate(range.StartPC);
+  range.Length = end - range.StartPC;
+}
+
+static void relocateTypeAnnotations(const CodeRelocation& relocate, TypeAnnotationsAttribute& attr)
+{
+  for(TypeAnnotation& annotation : attr.Annotations)
+  {
+    auto errOrKind = TypeAnnotation::GetTargetKind(annotation.TargetType);
+    if(errOrKind.IsError())
+      continue;
+
+    switch(errOrKind.Get())
+    {
+      case TypeAnnotation::TargetKind::LocalVar:
+        for(auto& var : annotation.LocalVarTable)
+          relocateRange(relocate, var);
+        break;
+
+      case TypeAnnotation::TargetKind::Offset:
+      case TypeAnnotation::TargetKind::TypeArgument:
+        annotation.TargetIndex = relocate(annotation.TargetIndex);
+        break;
+
+      default:
+        break;
+    }
+  }
+}
+
+static void relocateStackMapTable(const CodeRelocation& relocate, StackMapTableAttribute& attr)
+{
+  //the first frame's offset is its offset_delta, every following one is 
+  //offset_delta + 1 past the previous one
+  U32 oldOffset{0}, newOffset{0};
+
+  for(size_t i = 0; i < attr.Entries.size(); i++)
+  {
+    auto& frame = attr.Entries[i];
+
+    oldOffset = i == 0 ? frame.OffsetDelta : oldOffset + frame.OffsetDelta + 1;
+    U32 relocated = relocate(oldOffset);
+
+    frame.OffsetDelta = static_cast<U16>(i == 0 ? relocated : relocated - newOffset - 1);
+    newOffset = relocated;
+
+    for(auto* types : {&frame.Locals, &frame.Stack})
+    {
+      for(auto& type : *types)
+      {
+        if(type.Tag == StackMapTableAttribute::VerificationType::Item::Uninitialized)
+          type.Data = relocate(type.Data);
+      }
+    }
+  }
+}
+
+//Rewrites the ldc_w instructions of attr whose index fits into a byte to ldc
+//and moves everything referring to an offset into the code array along.
+//Returns the number of rewritten instructions, 0 if a branch would no longer
+//fit its 16 bit offset, in which case nothing is changed.
+static ErrorOr<size_t> shortenLoads(CodeAttribute& attr)
+{
+  std::vector<Instruction> code = attr.Code;
+  size_t shortened{0};
+
+  for(Instruction& instr : code)
+  {
+    if(instr.Op != Instruction::Opcode::LDC_W)
+      continue;
+
+    auto errOrIndex = instr.GetOperand(0);
+    VERIFY(errOrIndex);
+
+    if(errOrIndex.Get() > std::numeric_limits<U8>::max())
+      continue;
+
+    auto errOrLdc = Instruction::MakeInstruction(Instruction::Opcode::LDC);
+    VERIFY(errOrLdc);
+
+    instr = errOrLdc.Get();
+    TRY(instr.SetOperand(0, errOrIndex.Get()));
+    shortened++;
+  }
+
+  if(shortened == 0)
+    return shortened;
+
+  //one past the last instruction as well, switch padding depends on the offset
+  std::vector<U32> oldOffsets(code.size() + 1), newOffsets(code.size() + 1);
+
+  for(size_t i = 0; i < code.size(); i++)
+  {
+    oldOffsets[i+1] = oldOffsets[i] + static_cast<U32>(attr.Code[i].GetLength(oldOffsets[i], attr.Switches));
+    newOffsets[i+1] = newOffsets[i] + static_cast<U32>(code[i].GetLength(newOffsets[i], attr.Switches));
+  }
+
+  CodeRelocation relocate{oldOffsets, newOffsets};
+  std::vector<SwitchTable> switches = attr.Switches;
+
+  for(size_t i = 0; i < code.size(); i++)
+  {
+    Instruction& instr = code[i];
+
+    if(instr.IsSwitch())
+    {
+      if(instr.GetSwitchIndex() >= switches.size())
+        continue;
+
+      SwitchTable& table = switches[instr.GetSwitchIndex()];
+      table.Default = static_cast<S32>(relocate.Relative(oldOffsets[i], newOffsets[i], table.Default));
+
+      for(S32& offset : table.Offsets)
+        offset = static_cast<S32>(relocate.Relative(oldOffsets[i], newOffsets[i], offset));
+
+      continue;
+    }
+
+    if(!instr.IsBranch())
+      continue;
+
+    auto errOrOffset = instr.GetOperand(0);
+    VERIFY(errOrOffset);
+
+    S64 offset = relocate.Relative(oldOffsets[i], newOffsets[i], errOrOffset.Get());
+
+    if(instr.GetOperandType(0) == Instruction::TypeS16 &&
+        (offset < std::numeric_limits<S16>::min() || offset > std::numeric_limits<S16>::max()))
+    {
+      return size_t{0};
+    }
+
+    TRY(instr.SetOperand(0, static_cast<S32>(offset)));
+  }
+
+  attr.Code = std::move(code);
+  attr.Switches = std::move(switches);
+
+  for(auto& handler : attr.ExceptionTable)
+  {
+    handler.StartPC = relocate(handler.StartPC);
+    handler.EndPC = relocate(handler.EndPC);
+    handler.HandlerPC = relocate(handler.HandlerPC);
+  }
+
+  for(auto& pAttr : attr.Attributes)
+  {
+    using Type = AttributeInfo::Type;
+
+    switch(pAttr->GetType())
+    {
+      case Type::StackMapTable:
+        relocateStackMapTable(relocate, static_cast<StackMapTableAttribute&>(*pAttr));
+        break;
+
+      case Type::LineNumberTable:
+        for(auto& line : static_cast<LineNumberTableAttribute&>(*pAttr).LineNumberTable)
+          line.StartPC = relocate(line.StartPC);
+        break;
+
+      case Type::LocalVariableTable:
+        for(auto& var : static_cast<LocalVariableTableAttribute&>(*pAttr).LocalVariableTable)
+          relocateRange(relocate, var);
+        break;
+
+      case Type::LocalVariableTypeTable:
+        for(auto& var : static_cast<LocalVariableTypeTableAttribute&>(*pAttr).LocalVariableTypeTable)
+          relocateRange(relocate, var);
+        break;
+
+      case Type::RuntimeVisibleTypeAnnotations:
+      case Type::RuntimeInvisibleTypeAnnotations:
+        relocateTypeAnnotations(relocate, static_cast<TypeAnnotationsAttribute&>(*pAttr));
+        break;
+
+      default:
+        break;
+    }
+  }
+
+  return shortened;
+}
+
+template <typename Func>
+static ErrorOr<void> forEachCode(ClassFile& cf, Func&& func)
+{
+  for(FieldMethodInfo& method : cf.Methods)
+  {
+    for(auto& attr : method.Attributes)
+    {
+      if(attr->GetType() == AttributeInfo::Type::Code)
+        TRY(func(static_cast<CodeAttribute&>(*attr)));
+    }
+  }
+
+  return {};
+}
+
+ErrorOr<size_t> ConstantPoolRewriter::PackLoadables(ClassFile& cf)
+{
+  TRY(decodeAll(cf));
+
+  const ConstantPool& pool = cf.ConstPool;
+  U16 count = pool.GetCount();
+
+  //load sites of every constant, ldc's (which have to stay below 256) and 
+  //ldc_w's
+  std::vector<U32> ldcLoads(count, 0), wideLoads(count, 0);
+
+  TRY(forEachCode(cf, [&](CodeAttribute& attr) -> ErrorOr<void>
+  {
+    for(const Instruction& instr : attr.Code)
+    {
+      if(instr.Op != Instruction::Opcode::LDC && instr.Op != Instruction::Opcode::LDC_W)
+        continue;
+
+      auto errOrIndex = instr.GetOperand(0);
+      VERIFY(errOrIndex);
+
+      U16 index = static_cast<U16>(errOrIndex.Get());
+      TRY(pool.Get(index));
+
+      (instr.Op == Instruction::Opcode::LDC ? ldcLoads : wideLoads)[index]++;
+    }
+
+    return {};
+  }));
+
+  //constants loaded by ldc first, then by the number of ldc_w loads
+  std::vector<U16> loaded;
+  for(U16 i = 1; i < count; i++)
+  {
+    if((ldcLoads[i] != 0 || wideLoads[i] != 0) && !isWide(*pool[i]))
+      loaded.push_back(i);
+  }
+
+  std::stable_sort(loaded.begin(), loaded.end(), [&](U16 a, U16 b)
+  {
+    if((ldcLoads[a] != 0) != (ldcLoads[b] != 0))
+      return ldcLoads[a] != 0;
+
+    return wideLoads[a] > wideLoads[b];
+  });
+
+  constexpr size_t maxLdcIndex = std::numeric_limits<U8>::max();
+
+  if(loaded.size() > maxLdcIndex)
+    loaded.resize(maxLdcIndex);
+
+  //worth it if more ldc_w loads end up below 256 than already are
+  U32 loadsBefore{0}, loadsAfter{0};
+
+  for(U16 i = 1; i < count && i <= maxLdcIndex; i++)
+    loadsBefore += wideLoads[i];
+
+  for(U16 index : loaded)
+    loadsAfter += wideLoads[index];
+
+  bool reordered = loadsAfter > loadsBefore;
+
+  if(reordered)
+  {
+    //the chosen constants move to the front, everything keeps its order 
+    //otherwise
+    std::vector<bool> front(count, false);
+    for(U16 index : loaded)
+      front[index] = true;
+
+    std::vector<U16> newIndices(count, 0);
+    U16 next = 1;
+
+    for(bool chosen : {true, false})
+    {
+      for(U16 i = 1; i < count; i++)
+      {
+        if(front[i] != chosen || pool[i] == nullptr)
+          continue;
+
+        newIndices[i] = next;
+        next += isWide(*pool[i]) ? 2 : 1;
+      }
+    }
+
+    TRY(renumber(cf, newIndices, count));
+  }
+
+  size_t shortened{0};
+
+  TRY(forEachCode(cf, [&](CodeAttribute& attr) -> ErrorOr<void>
+  {
+    auto errOrShortened = shortenLoads(attr);
+    VERIFY(errOrShortened);
+
+    shortened += errOrShortened.Get();
+    return {};
+  }));
+
+  //renumber() marked everything dirty already
+  if(shortened != 0 && !reordered)
+    markDirty(cf);
+
+  return shortened;
+}
+
+} //namespace ClassFile
@@ -0,0 +1,547 @@
+#include "ClassFile/ControlFlowGraph.hpp"
+#include "ClassFile/Instruction.hpp"
+
+#include "Util/Error.hpp"
+
+#include <algorithm>
+#include <utility>
+
+namespace ClassFile
+{
+
+using Opcode = Instruction::Opcode;
+using Block = ControlFlowGraph::Block;
+using Edge = ControlFlowGraph::Edge;
+using Loop = ControlFlowGraph::Loop;
+
+static constexpr U32 None = ControlFlowGraph::None;
+
+//Offsets of the instructions (and of the end of the code array) and the
+//instruction starting at every offset, None inside of instructions
+struct CodeLayout
+{
+  std::vector<U32> Offsets;
+  std::vector<U32> InstructionAt;
+
+  //Index of the instruction at offset, with allowEnd the end of the code
+  //array is Offsets.size() - 1
+  ErrorOr<U32> Find(S64 offset, bool allowEnd = false) const
+  {
+    U32 end = static_cast<U32>(Offsets.size() - 1);
+
+    if(offset < 0 || offset >= static_cast<S64>(InstructionAt.size()) ||
+        InstructionAt[offset] == None || (InstructionAt[offset] == end && !allowEnd))
+    {
+      return Error{ErrorCode::InvalidCodeOffset, Error::NoOffset, static_cast<U64>(offset), Offsets.back()};
+    }
+
+    return InstructionAt[offset];
+  }
+};
+
+//Instructions after which execution doesn't continue with the next one
+static bool endsFlow(const Instruction& instr)
+{
+  switch(instr.Op)
+  {
+    case Opcode::GOTO:
+    case Opcode::GOTO_W:
+    case Opcode::TABLESWITCH:
+    case Opcode::LOOKUPSWITCH:
+    case Opcode::IRETURN:
+    case Opcode::LRETURN:
+    case Opcode::FRETURN:
+    case Opcode::DRETURN:
+    case Opcode::ARETURN:
+    case Opcode::RETURN:
+    case Opcode::ATHROW:
+    case Opcode::RET:
+      return true;
+
+    case Opcode::WIDE:
+      return instr.GetWidenedOpcode() == Opcode::RET;
+
+    default:
+      return false;
+  }
+}
+
+//Calls func(instruction index, Edge::Kind) for the targets of the branch or
+//switch at index, switch targets in table order and possibly repeated
+template <typename Func>
+static ErrorOr<void> forEachTarget(const CodeAttribute& attr, const CodeLayout& layout, U32 index, Func&& func)
+{
+  const Instruction& instr = attr.Code[index];
+  S64 base = layout.Offsets[index];
+
+  if(instr.IsSwitch())
+  {
+    U32 switchIndex = instr.GetSwitchIndex();
+
+    if(switchIndex >= attr.Switches.size())
+      return Error{ErrorCode::InvalidSwitch, Error::NoOffset, switchIndex, attr.Switches.size()};
+
+    const SwitchTable& table = attr.Switches[switchIndex];
+
+    auto errOrDefault = layout.Find(base + table.Default);
+    VERIFY(errOrDefault, "switch default");
+
+    func(errOrDefault.Get(), Edge::Kind::Switch);
+
+    for(S32 offset : table.Offsets)
+    {
+      auto errOrTarget = layout.Find(base + offset);
+      VERIFY(errOrTarget, "switch offset");
+
+      func(errOrTarget.Get(), Edge::Kind::Switch);
+    }
+
+    return {};
+  }
+
+  if(instr.IsBranch())
+  {
+    auto errOrOffset = instr.GetOperand(0);
+    VERIFY(errOrOffset);
+
+    auto errOrTarget = layout.Find(base + errOrOffset.Get());
+    VERIFY(errOrTarget, "branch target");
+
+    func(errOrTarget.Get(), Edge::Kind::Jump);
+  }
+
+  return {};
+}
+
+//Reverse postorder of a depth-first search from the entry, which also
+//numbers the blocks
+static void computeOrder(ControlFlowGraph& cfg)
+{
+  std::vector<bool> visited(cfg.Blocks.size(), false);
+  std::vector<U32>& order = cfg.ReversePostOrder;
+
+  //(block, index of its next successor)
+  std::vector< std::pair<U32, U32> > stack;
+  stack.emplace_back(0, 0);
+  visited[0] = true;
+
+  while(!stack.empty())
+  {
+    auto& [index, next] = stack.back();
+    const Block& block = cfg.Blocks[index];
+
+    if(next < block.SuccessorCount)
+    {
+      U32 to = cfg.Edges[block.FirstSuccessor + next++].To;
+
+      if(!visited[to])
+      {
+        visited[to] = true;
+        stack.emplace_back(to, 0);
+      }
+
+      continue;
+    }
+
+    order.push_back(index);
+    stack.pop_back();
+  }
+
+  std::reverse(order.begin(), order.end());
+
+  for(size_t i = 0; i < order.size(); i++)
+    cfg.Blocks[order[i]].Order = static_cast<U32>(i);
+}
+
+//The iterative algorithm of Cooper, Harvey & Kennedy: visits the blocks in
+//reverse postorder, setting the immediate dominator of each to the nearest
+//common dominator of its already visited predecessors, until nothing changes.
+//Usually settles after two or three passes. Blocks are identified by their
+//position in ReversePostOrder meanwhile, where dominators come before the
+//blocks they dominate, so finding a common dominator only compares positions.
+static void computeDominators(ControlFlowGraph& cfg)
+{
+  std::vector<Block>& blocks = cfg.Blocks;
+  const std::vector<U32>& order = cfg.ReversePostOrder;
+  U32 count = static_cast<U32>(order.size());
+
+  //reachable predecessors of every position
+  std::vector<U32> firstPredecessor(count + 1), predecessors;
+  predecessors.reserve(cfg.Edges.size());
+
+  for(U32 i = 0; i < count; i++)
+  {
+    const Block& block = blocks[order[i]];
+    firstPredecessor[i] = static_cast<U32>(predecessors.size());
+
+    for(U32 p = block.FirstPredecessor; p < block.FirstPredecessor + block.PredecessorCount; p++)
+    {
+      U32 pred = blocks[cfg.Edges[cfg.PredecessorEdges[p]].From].Order;
+
+      if(pred != None)
+        predecessors.push_back(pred);
+    }
+  }
+
+  firstPredecessor[count] = static_cast<U32>(predecessors.size());
+
+  std::vector<U32> dominators(count, None);
+  dominators[0] = 0;
+
+  auto intersect = [&](U32 a, U32 b)
+  {
+    while(a != b)
+    {
+      while(a > b)
+        a = dominators[a];
+
+      while(b > a)
+        b = dominators[b];
+    }
+
+    return a;
+  };
+
+  bool changed = true;
+
+  while(changed)
+  {
+    changed = false;
+
+    for(U32 i = 1; i < count; i++)
+    {
+      U32 dominator = None;
+
+      for(U32 p = firstPredecessor[i]; p < firstPredecessor[i+1]; p++)
+      {
+        U32 pred = predecessors[p];
+
+        //not visited yet
+        if(dominators[pred] == None)
+          continue;
+
+        dominator = dominator == None ? pred : intersect(pred, dominator);
+      }
+
+      if(dominator != dominators[i])
+      {
+        dominators[i] = dominator;
+        changed = true;
+      }
+    }
+  }
+
+  for(U32 i = 0; i < count; i++)
+    blocks[order[i]].ImmediateDominator = order[dominators[i]];
+}
+
+//Headers are visited in postorder, so a loop nested in another one is found
+//first: its header is dominated by (and so comes after) the outer header.
+//The body of a loop is collected walking backwards from its back edges. On
+//reaching a block of an already found loop, that loop (or the outermost loop
+//containing it found so far) becomes nested in the current one and the walk
+//continues from its header.
+static void computeLoops(ControlFlowGraph& cfg)
+{
+  std::vector<Block>& blocks = cfg.Blocks;
+  std::vector<Loop>& loops = cfg.Loops;
+
+  //outermost loop found so far containing each loop, path compressed
+  std::vector<U32> outermost;
+
+  auto findOutermost = [&](U32 loop)
+  {
+    while(outermost[loop] != loop)
+    {
+      outermost[loop] = outermost[outermost[loop]];
+      loop = outermost[loop];
+    }
+
+    return loop;
+  };
+
+  std::vector<U32> worklist;
+
+  auto pushPredecessors = [&](const Block& block)
+  {
+    for(U32 p = block.FirstPredecessor; p < block.FirstPredecessor + block.PredecessorCount; p++)
+    {
+      U32 pred = cfg.Edges[cfg.PredecessorEdges[p]].From;
+
+      if(cfg.IsReachable(pred))
+        worklist.push_back(pred);
+    }
+  };
+
+  for(size_t i = cfg.ReversePostOrder.size(); i-- > 0;)
+  {
+    U32 header = cfg.ReversePostOrder[i];
+    const Block& headerBlock = blocks[header];
+
+    worklist.clear();
+
+    for(U32 p = headerBlock.FirstPredecessor; p < headerBlock.FirstPredecessor + headerBlock.PredecessorCount; p++)
+    {
+      U32 pred = cfg.Edges[cfg.PredecessorEdges[p]].From;
+
+      if(cfg.Dominates(header, pred))
+        worklist.push_back(pred);
+    }
+
+    if(worklist.empty())
+      continue;
+
+    U32 loop = static_cast<U32>(loops.size());
+    loops.push_back(Loop{header, None, 0, 0, 0});
+    outermost.push_back(loop);
+    blocks[header].Loop = loop;
+
+    while(!worklist.empty())
+    {
+      U32 index = worklist.back();
+      worklist.pop_back();
+
+      if(blocks[index].Loop == None)
+      {
+        blocks[index].Loop = loop;
+        pushPredecessors(blocks[index]);
+        continue;
+      }
+
+      U32 inner = findOutermost(blocks[index].Loop);
+      if(inner == loop)
+        continue;
+
+      loops[inner].Parent = loop;
+      outermost[inner] = loop;
+      pushPredecessors(blocks[loops[inner].Header]);
+    }
+  }
+
+  //parents are found after the loops they contain
+  for(size_t i = loops.size(); i-- > 0;)
+    loops[i].Depth = loops[i].Parent == None ? 1 : loops[loops[i].Parent].Depth + 1;
+
+  //every block belongs to its innermost loop and all loops containing that
+  for(const Block& block : blocks)
+  {
+    for(U32 loop = block.Loop; loop != None; loop = loops[loop].Parent)
+      loops[loop].BlockCount++;
+  }
+
+  U32 first{0};
+  for(Loop& loop : loops)
+  {
+    loop.FirstBlock = first;
+    first += loop.BlockCount;
+    loop.BlockCount = 0;
+  }
+
+  cfg.LoopBlocks.resize(first);
+
+  for(U32 index = 0; index < blocks.size(); index++)
+  {
+    for(U32 loop = blocks[index].Loop; loop != None; loop = loops[loop].Parent)
+      cfg.LoopBlocks[loops[loop].FirstBlock + loops[loop].BlockCount++] = index;
+  }
+}
+
+ErrorOr<ControlFlowGraph> ControlFlowGraph::Create(const CodeAttribute& attr)
+{
+  ControlFlowGraph cfg;
+  const std::vector<Instruction>& code = attr.Code;
+
+  if(code.empty())
+    return cfg;
+
+  U32 count = static_cast<U32>(code.size());
+
+  CodeLayout layout;
+  layout.Offsets.resize(count + 1);
+
+  for(U32 i = 0; i < count; i++)
+    layout.Offsets[i+1] = layout.Offsets[i] + static_cast<U32>(code[i].GetLength(layout.Offsets[i], attr.Switches));
+
+  layout.InstructionAt.assign(layout.Offsets.back() + 1, None);
+
+  for(U32 i = 0; i <= count; i++)
+    layout.InstructionAt[layout.Offsets[i]] = i;
+
+  //instructions starting a block, the end of the code array ends the last
+  std::vector<bool> leaders(count + 1, false);
+  leaders[0] = true;
+
+  for(U32 i = 0; i < count; i++)
+  {
+    if(!code[i].IsBranch() && !endsFlow(code[i]))
+      continue;
+
+    leaders[i+1] = true;
+    TRY(forEachTarget(attr, layout, i, [&](U32 target, Edge::Kind) { leaders[target] = true; }));
+  }
+
+  //instruction indices of [StartPC, EndPC) and HandlerPC
+  struct Handler
+  {
+    U32 Start;
+    U32 End;
+    U32 Target;
+  };
+
+  std::vector<Handler> handlers;
+  handlers.reserve(attr.ExceptionTable.size());
+
+  for(const auto& entry : attr.ExceptionTable)
+  {
+    auto errOrStart = layout.Find(entry.StartPC, true);
+    VERIFY(errOrStart, "exception handler start_pc");
+
+    auto errOrEnd = layout.Find(entry.EndPC, true);
+    VERIFY(errOrEnd, "exception handler end_pc");
+
+    auto errOrTarget = layout.Find(entry.HandlerPC);
+    VERIFY(errOrTarget, "exception handler handler_pc");
+
+    handlers.push_back({errOrStart.Get(), errOrEnd.Get(), errOrTarget.Get()});
+
+    leaders[errOrStart.Get()] = true;
+    leaders[errOrEnd.Get()] = true;
+    leaders[errOrTarget.Get()] = true;
+  }
+
+  //block of every instruction and of the end of the code array
+  std::vector<U32> blockAt(count + 1);
+
+  for(U32 i = 0; i < count; i++)
+  {
+    if(leaders[i])
+    {
+      Block block{};
+      block.FirstInstruction = i;
+      block.StartPC = layout.Offsets[i];
+
+      cfg.Blocks.push_back(block);
+    }
+
+    blockAt[i] = static_cast<U32>(cfg.Blocks.size() - 1);
+  }
+
+  U32 blockCount = static_cast<U32>(cfg.Blocks.size());
+  blockAt[count] = blockCount;
+
+  for(U32 b = 0; b < blockCount; b++)
+  {
+    Block& block = cfg.Blocks[b];
+    block.EndInstruction = b + 1 < blockCount ? cfg.Blocks[b+1].FirstInstruction : count;
+    block.EndPC = layout.Offsets[block.EndInstruction];
+  }
+
+  //(covered block, handler block), in ExceptionTable order within a block
+  std::vector< std::pair<U32, U32> > covered;
+
+  for(const Handler& handler : handlers)
+  {
+    for(U32 b = blockAt[handler.Start]; b < blockAt[handler.End]; b++)
+      covered.emplace_back(b, blockAt[handler.Target]);
+  }
+
+  std::stable_sort(covered.begin(), covered.end(), [](const auto& a, const auto& b)
+  {
+    return a.first < b.first;
+  });
+
+  //the last block an edge to each block was added from, to add one at most
+  std::vector<U32> linkedFrom(blockCount, None);
+  size_t nextCovered{0};
+
+  for(U32 b = 0; b < blockCount; b++)
+  {
+    Block& block = cfg.Blocks[b];
+    block.FirstSuccessor = static_cast<U32>(cfg.Edges.size());
+
+    auto addEdge = [&](U32 to, Edge::Kind kind)
+    {
+      if(linkedFrom[to] == b)
+        return;
+
+      linkedFrom[to] = b;
+      cfg.Edges.push_back(Edge{b, to, kind});
+    };
+
+    U32 last = block.EndInstruction - 1;
+
+    TRY(forEachTarget(attr, layout, last, [&](U32 target, Edge::Kind kind) { addEdge(blockAt[target], kind); }));
+
+    //falling off the end of the code array is left to the verifier
+    if(!endsFlow(code[last]) && b + 1 < blockCount)
+      addEdge(b + 1, Edge::Kind::Fallthrough);
+
+    for(; nextCovered < covered.size() && covered[nextCovered].first == b; nextCovered++)
+      addEdge(covered[nextCovered].second, Edge::Kind::Exception);
+
+    block.SuccessorCount = static_cast<U32>(cfg.Edges.size()) - block.FirstSuccessor;
+  }
+
+  for(const Edge& edge : cfg.Edges)
+    cfg.Blocks[edge.To].PredecessorCount++;
+
+  U32 first{0};
+  for(Block& block : cfg.Blocks)
+  {
+    block.FirstPredecessor = first;
+    first += block.PredecessorCount;
+    block.PredecessorCount = 0;
+  }
+
+  cfg.PredecessorEdges.resize(cfg.Edges.size());
+
+  for(U32 e = 0; e < cfg.Edges.size(); e++)
+  {
+    Block& to = cfg.Blocks[cfg.Edges[e].To];
+    cfg.PredecessorEdges[to.FirstPredecessor + to.PredecessorCount++] = e;
+  }
+
+  computeOrder(cfg);
+  computeDominators(cfg);
+  computeLoops(cfg);
+
+  return cfg;
+}
+
+U32 ControlFlowGraph::GetBlockAt(U32 pc) const
+{
+  if(Blocks.empty() || pc >= Blocks.back().EndPC)
+    return None;
+
+  auto it = std::upper_bound(Blocks.begin(), Blocks.end(), pc, [](U32 offset, const Block& block)
+  {
+    return offset < block.StartPC;
+  });
+
+  return static_cast<U32>(it - Blocks.begin()) - 1;
+}
+
+bool ControlFlowGraph::Dominates(U32 dominator, U32 block) const
+{
+  if(!IsReachable(dominator) || !IsReachable(block))
+    return false;
+
+  //dominators come first in ReversePostOrder
+  while(Blocks[block].Order > Blocks[dominator].Order)
+    block = Blocks[block].ImmediateDominator;
+
+  return block == dominator;
+}
+
+bool ControlFlowGraph::LoopContains(U32 loop, U32 block) const
+{
+  for(U32 inner = Blocks[block].Loop; inner != None; inner = Loops[inner].Parent)
+  {
+    if(inner == loop)
+      return true;
+  }
+
+  return false;
+}
+
+} //namespace ClassFile
@@ -0,0 +1,182 @@
+#include "ClassFile/Error.hpp"
+#include "ClassFile/ConstantPool.hpp"
+
+#include <fmt/core.h>
+
+namespace ClassFile
+{
+
+std::string_view Error::GetCodeName(ErrorCode code)
+{
+  switch(code)
+  {
+    case ErrorCode::Generic:              return "Generic";
+    case ErrorCode::BufferOverrun:        return "BufferOverrun";
+    case ErrorCode::StreamFailure:        return "StreamFailure";
+    case ErrorCode::InvalidConstantIndex: return "InvalidConstantIndex";
+    case ErrorCode::NullConstant:         return "NullConstant";
+    case ErrorCode::ConstantTypeMismatch: return "ConstantTypeMismatch";
+    case ErrorCode::UnresolvedName:       return "UnresolvedName";
+    case ErrorCode::UnresolvedDescriptor: return "UnresolvedDescriptor";
+    case ErrorCode::UnresolvedOwner:      return "UnresolvedOwner";
+    case ErrorCode::UnknownConstantTag:   return "UnknownConstantTag";
+    case ErrorCode::UnknownAttribute:     return "UnknownAttribute";
+    case ErrorCode::InvalidOperandIndex:  return "InvalidOperandIndex";
+    case ErrorCode::OperandTypeMismatch:  return "OperandTypeMismatch";
+    case ErrorCode::ComplexInstruction:   return "ComplexInstruction";
+    case ErrorCode::InvalidOpcode:        return "InvalidOpcode";
+    case ErrorCode::InvalidWide:          return "InvalidWide";
+    case ErrorCode::InvalidSwitch:        return "InvalidSwitch";
+    case ErrorCode::InvalidModifiedUTF8:  return "InvalidModifiedUTF8";
+    case ErrorCode::InvalidUTF8:          return "InvalidUTF8";
+    case ErrorCode::UnpairedSurrogate:    return "UnpairedSurrogate";
+    case ErrorCode::LengthMismatch:       return "LengthMismatch";
+    case ErrorCode::TrailingBytes:        return "TrailingBytes";
+    case ErrorCode::InvalidAttributeTag:  return "InvalidAttributeTag";
+    case ErrorCode::InvalidFrameItemCount: return "InvalidFrameItemCount";
+    case ErrorCode::NestingTooDeep:       return "NestingTooDeep";
+    case ErrorCode::InvalidCodeOffset:    return "InvalidCodeOffset";
+  }
+
+  return "Unknown";
+}
+
+static std::string describe(const Error& err)
+{
+  U64 first = err.Context[0];
+  U64 second = err.Context[1];
+
+  switch(err.Code)
+  {
+    case ErrorCode::Generic:
+      return {};
+
+    case ErrorCode::BufferOverrun:
+      return fmt::format("buffer overrun after trying to access {} bytes ({} remaining)", first, second);
+
+    case ErrorCode::StreamFailure:
+      return fmt::format("stream went bad after trying to access {} bytes", first);
+
+    case ErrorCode::InvalidConstantIndex:
+      return fmt::format("out-of-bounds constant pool access at index {}, "
+          "constant_pool_count is {}", first, second);
+
+    case ErrorCode::NullConstant:
+      return fmt::format("constant pool entry {} is empty", first);
+
+    case ErrorCode::ConstantTypeMismatch:
+      return fmt::format("invalid type cast access at constant pool index {}, entry "
+          "is not of type \"{}\"", first, CPInfo::GetTypeName(static_cast<CPInfo::Type>(second)));
+
+    case ErrorCode::UnresolvedName:
+      return fmt::format("failed to lookup name string for constant pool entry {}", first);
+
+    case ErrorCode::UnresolvedDescriptor:
+      return fmt::format("failed to lookup descriptor string for constant pool entry {}", first);
+
+    case ErrorCode::UnresolvedOwner:
+      return fmt::format("failed to lookup owner class for constant pool entry {}", first);
+
+    case ErrorCode::UnknownConstantTag:
+      return fmt::format("encountered unknown constant tag {}", first);
+
+    case ErrorCode::UnknownAttribute:
+      return "unknown attribute name";
+
+    case ErrorCode::InvalidOperandIndex:
+      return fmt::format("out-of-bounds operand access at index {}, instruction has "
+          "{} operand(s)", first, second);
+
+    case ErrorCode::OperandTypeMismatch:
+      return fmt::format("invalid operand type cast at index {}, failed to cast "
+          "to the {} byte type requested", first, second);
+
+    case ErrorCode::ComplexInstruction:
+      return fmt::format("encountered complex instruction with opcode 0x{:x}, which "
+          "isn't supported here", first);
+
+    case ErrorCode::InvalidOpcode:
+      return fmt::format("invalid opcode 0x{:x}", first);
+
+    case ErrorCode::InvalidWide:
+      return fmt::format("opcode 0x{:x} can't be modified by wide", first);
+
+    case ErrorCode::InvalidSwitch:
+      return fmt::format("invalid switch table, entry count or table index {} "
+          "exceeds the limit of {}", first, second);
+
+    case ErrorCode::InvalidModifiedUTF8:
+      return fmt::format("invalid modified UTF-8 sequence at offset {} (byte 0x{:x})", first, second);
+
+    case ErrorCode::InvalidUTF8:
+      return fmt::format("invalid UTF-8 sequence at offset {} (byte 0x{:x})", first, second);
+
+    case ErrorCode::UnpairedSurrogate:
+      return fmt::format("unpaired surrogate 0x{:x} at offset {} can't be converted to "
+          "UTF-8", second, first);
+
+    case ErrorCode::LengthMismatch:
+      return fmt::format("length field indicates {} bytes, but {} were processed", first, second);
+
+    case ErrorCode::TrailingBytes:
+      return fmt::format("{} trailing bytes", first);
+
+    case ErrorCode::InvalidAttributeTag:
+      return fmt::format("invalid tag or type 0x{:x} in attribute", first);
+
+    case ErrorCode::InvalidFrameItemCount:
+      return fmt::format("stack map frame of type {} can't hold {} items", first, second);
+
+    case ErrorCode::NestingTooDeep:
+      return fmt::format("nested {} levels deep, the maximum is {}", first, second);
+
+    case ErrorCode::InvalidCodeOffset:
+      return fmt::format("code offset {} doesn't start an instruction, code_length "
+          "is {}", static_cast<S64>(first), second);
+  }
+
+  return fmt::format("unknown error code {}", static_cast<int>(err.Code));
+}
+
+void Error::AddFrame(const char* function, std::string_view note)
+{
+  if(TraceSize == MaxTrace)
+    return;
+
+  Trace[TraceSize++] = {function, nullptr, true};
+
+  Notes.append(note);
+  Notes.push_back('\0');
+}
+
+std::string Error::Message() const
+{
+  std::string msg = describe(*this);
+  msg += What;
+
+  if(Offset != NoOffset)
+    msg += fmt::format(" (at 0x{:x})", Offset);
+
+  size_t notePos{0};
+
+  for(U8 i = 0; i < TraceSize; i++)
+  {
+    const Frame& frame = Trace[i];
+    std::string_view note = frame.Note ? frame.Note : "";
+
+    if(frame.CopiedNote)
+    {
+      note = std::string_view{Notes.c_str() + notePos};
+      notePos += note.size() + 1;
+    }
+
+    if(note.empty())
+      msg += fmt::format("\n  in {}", frame.Function);
+    else
+      msg += fmt::format("\n  in {}: {}", frame.Function, note);
+  }
+
+  return msg;
+}
+
+} //namespace ClassFile
@@ -0,0 +1,317 @@
+#include "ClassFile/FlatConstantPool.hpp"
+
+namespace ClassFile
+{
+
+using Type = CPInfo::Type;
+using Entry = FlatConstantPool::Entry;
+
+static Entry flatten(const CPInfo& info, std::string& utf8)
+{
+  Entry entry;
+  entry.Tag = info.GetType();
+
+  switch(info.GetType())
+  {
+    case Type::Class:
+      entry.First = static_cast<const ClassInfo&>(info).NameIndex;
+      break;
+
+    case Type::Fieldref:
+    {
+      const auto& ref = static_cast<const FieldrefInfo&>(info);
+      entry.First = ref.ClassIndex;
+      entry.Second = ref.NameAndTypeIndex;
+      break;
+    }
+
+    case Type::Methodref:
+    {
+      const auto& ref = static_cast<const MethodrefInfo&>(info);
+      entry.First = ref.ClassIndex;
+      entry.Second = ref.NameAndTypeIndex;
+      break;
+    }
+
+    case Type::InterfaceMethodref:
+    {
+      const auto& ref = static_cast<const InterfaceMethodrefInfo&>(info);
+      entry.First = ref.ClassIndex;
+      entry.Second = ref.NameAndTypeIndex;
+      break;
+    }
+
+    case Type::String:
+      entry.First = static_cast<const StringInfo&>(info).StringIndex;
+      break;
+
+    case Type::Integer:
+      entry.First = static_cast<const IntegerInfo&>(info).Bytes;
+      break;
+
+    case Type::Float:
+      entry.First = static_cast<const FloatInfo&>(info).Bytes;
+      break;
+
+    case Type::Long:
+    {
+      const auto& num = static_cast<const LongInfo&>(info);
+      entry.First = num.HighBytes;
+      entry.Second = num.LowBytes;
+      break;
+    }
+
+    case Type::Double:
+    {
+      const auto& num = static_cast<const DoubleInfo&>(info);
+      entry.First = num.HighBytes;
+      entry.Second = num.LowBytes;
+      break;
+    }
+
+    case Type::NameAndType:
+    {
+      const auto& nat = static_cast<const NameAndTypeInfo&>(info);
+      entry.First = nat.NameIndex;
+      entry.Second = nat.DescriptorIndex;
+      break;
+    }
+
+    case Type::UTF8:
+    {
+      std::string_view str = static_cast<const UTF8Info&>(info).GetString();
+      entry.First = static_cast<U32>(utf8.size());
+      entry.Second = static_cast<U32>(str.size());
+      utf8.append(str);
+      break;
+    }
+
+    case Type::MethodHandle:
+    {
+      const auto& handle = static_cast<const MethodHandleInfo&>(info);
+      entry.ReferenceKind = handle.ReferenceKind;
+      entry.First = handle.ReferenceIndex;
+      break;
+    }
+
+    case Type::MethodType:
+      entry.First = static_cast<const MethodTypeInfo&>(info).DescriptorIndex;
+      break;
+
+    case Type::InvokeDynamic:
+    {
+      const auto& indy = static_cast<const InvokeDynamicInfo&>(info);
+      entry.First = indy.BootstrapMethodAttrIndex;
+      entry.Second = indy.NameAndTypeIndex;
+      break;
+    }
+  }
+
+  return entry;
+}
+
+FlatConstantPool::FlatConstantPool(const ConstantPool& cp)
+{
+  size_t utf8Size{0};
+  for(U16 i = 1; i < cp.GetCount(); i++)
+  {
+    const CPInfo* info = cp[i];
+
+    if(info && info->GetType() == Type::UTF8)
+      utf8Size += static_cast<const UTF8Info*>(info)->GetString().size();
+  }
+
+  m_utf8.reserve(utf8Size);
+  m_entries.resize(cp.GetCount());
+
+  for(U16 i = 1; i < cp.GetCount(); i++)
+  {
+    const CPInfo* info = cp[i];
+
+    if(info)
+      m_entries[i] = flatten(*info, m_utf8);
+  }
+}
+
+ErrorOr<std::string_view> FlatConstantPool::lookupUTF8(U32 index) const
+{
+  const Entry* entry = index <= 0xFFFF ? this->at(static_cast<U16>(index)) : nullptr;
+
+  if(!entry || entry->Tag != Type::UTF8)
+    return failedCastError(static_cast<U16>(index), Type::UTF8);
+
+  return std::string_view{m_utf8}.substr(entry->First, entry->Second);
+}
+
+ErrorOr<std::string_view> FlatConstantPool::lookupNameAndType(U32 index, bool descriptor) const
+{
+  const Entry* entry = index <= 0xFFFF ? this->at(static_cast<U16>(index)) : nullptr;
+
+  if(!entry || entry->Tag != Type::NameAndType)
+    return failedCastError(static_cast<U16>(index), Type::NameAndType);
+
+  return lookupUTF8(descriptor ? entry->Second : entry->First);
+}
+
+ErrorOr<std::string_view> FlatConstantPool::LookupString(U16 index) const
+{
+  const Entry* entry = this->at(index);
+
+  if(!entry)
+    return invalidIndexError(index);
+
+  switch(entry->Tag)
+  {
+    case Type::UTF8:
+      return std::string_view{m_utf8}.substr(entry->First, entry->Second);
+
+    case Type::String:
+    case Type::Class:
+    case Type::NameAndType:
+      return lookupUTF8(entry->First);
+
+    case Type::Fieldref:
+    case Type::Methodref:
+    case Type::InterfaceMethodref:
+    case Type::InvokeDynamic:
+      return lookupNameAndType(entry->Second, false);
+
+    default:
+      break;
+  }
+
+  return lookupError(index, ErrorCode::UnresolvedName);
+}
+
+ErrorOr<std::string_view> FlatConstantPool::LookupDescriptor(U16 index) const
+{
+  const Entry* entry = this->at(index);
+
+  if(!entry)
+    return invalidIndexError(index);
+
+  switch(entry->Tag)
+  {
+    case Type::MethodType:
+      return lookupUTF8(entry->First);
+
+    case Type::NameAndType:
+      return lookupUTF8(entry->Second);
+
+    case Type::Fieldref:
+    case Type::Methodref:
+    case Type::InterfaceMethodref:
+    case Type::InvokeDynamic:
+      return lookupNameAndType(entry->Second, true);
+
+    default:
+      break;
+  }
+
+  return lookupError(index, ErrorCode::UnresolvedDescriptor);
+}
+
+U16 FlatConstantPool::GetSize() const
+{
+  return m_entries.empty() ? 0 : static_cast<U16>(m_entries.size() - 1);
+}
+
+U16 FlatConstantPool::GetCount() const
+{
+  return this->GetSize() + 1;
+}
+
+void FlatConstantPool::fill(const Entry& e, ClassInfo& info) const
+{
+  info.NameIndex = static_cast<U16>(e.First);
+}
+
+void FlatConstantPool::fill(const Entry& e, FieldrefInfo& info) const
+{
+  info.ClassIndex = static_cast<U16>(e.First);
+  info.NameAndTypeIndex = static_cast<U16>(e.Second);
+}
+
+void FlatConstantPool::fill(const Entry& e, MethodrefInfo& info) const
+{
+  info.ClassIndex = static_cast<U16>(e.First);
+  info.NameAndTypeIndex = static_cast<U16>(e.Second);
+}
+
+void FlatConstantPool::fill(const Entry& e, InterfaceMethodrefInfo& info) const
+{
+  info.ClassIndex = static_cast<U16>(e.First);
+  info.NameAndTypeIndex = static_cast<U16>(e.Second);
+}
+
+void FlatConstantPool::fill(const Entry& e, StringInfo& info) const
+{
+  info.StringIndex = static_cast<U16>(e.First);
+}
+
+void FlatConstantPool::fill(const Entry& e, IntegerInfo& info) const
+{
+  info.Bytes = e.First;
+}
+
+void FlatConstantPool::fill(const Entry& e, FloatInfo& info) const
+{
+  info.Bytes = e.First;
+}
+
+void FlatConstantPool::fill(const Entry& e, LongInfo& info) const
+{
+  info.HighBytes = e.First;
+  info.LowBytes = e.Second;
+}
+
+void FlatConstantPool::fill(const Entry& e, DoubleInfo& info) const
+{
+  info.HighBytes = e.First;
+  info.LowBytes = e.Second;
+}
+
+void FlatConstantPool::fill(const Entry& e, NameAndTypeInfo& info) const
+{
+  info.NameIndex = static_cast<U16>(e.First);
+  info.DescriptorIndex = static_cast<U16>(e.Second);
+}
+
+void FlatConstantPool::fill(const Entry& e, UTF8Info& info) const
+{
+  info.Borrow({reinterpret_cast<const U8*>(m_utf8.data()) + e.First, e.Second});
+}
+
+void FlatConstantPool::fill(const Entry& e, MethodHandleInfo& info) const
+{
+  info.ReferenceKind = e.ReferenceKind;
+  info.ReferenceIndex = static_cast<U16>(e.First);
+}
+
+void FlatConstantPool::fill(const Entry& e, MethodTypeInfo& info) const
+{
+  info.DescriptorIndex = static_cast<U16>(e.First);
+}
+
+void FlatConstantPool::fill(const Entry& e, InvokeDynamicInfo& info) const
+{
+  info.BootstrapMethodAttrIndex = static_cast<U16>(e.First);
+  info.NameAndTypeIndex = static_cast<U16>(e.Second);
+}
+
+Error FlatConstantPool::invalidIndexError(U16 index) const
+{
+  return Error{ErrorCode::InvalidConstantIndex, Error::NoOffset, index, this->GetCount()};
+}
+
+Error FlatConstantPool::failedCastError(U16 index, CPInfo::Type castTo) const
+{
+  return Error{ErrorCode::ConstantTypeMismatch, Error::NoOffset, index, static_cast<U64>(castTo)};
+}
+
+Error FlatConstantPool::lookupError(U16 index, ErrorCode code) const
+{
+  return Error{code, Error::NoOffset, index};
+}
+
+} //namespace ClassFile
@@ -6,6 +6,10 @@
 #include "Util/IO.hpp"
 #include "Util/Error.hpp"
 
+#include <algorithm>
+#include <array>
+#include <cstring>
+
 using namespace ClassFile;
 
 //                                    mnemonic           format
@@ -144,7 +148,7 @@ constexpr std::array<instrInfo, ClassFile::Instruction::Opcode::_N> infoTable =
   {"lor",            ""},
   {"ixor",           ""},
   {"lxor",           ""},
-  {"iinc",           "sS"},
+  {"iinc",           "bB"},
   {"i2l",            ""},
   {"i2f",            ""},
   {"i2d",            ""},
@@ -182,8 +186,8 @@ constexpr std::array<instrInfo, ClassFile::Instruction::Opcode::_N> infoTable =
   {"goto",           "S"},
   {"jsr",            "S"},
   {"ret",            "b"},
-  {"tableswitch",    "c"}, //complex
-  {"lookupswitch",   "c"}, //complex
+  {"tableswitch",    "c"},
+  {"lookupswitch",   "c"},
   {"ireturn",        ""},
   {"lreturn",        ""},
   {"freturn",        ""},
@@ -208,10 +212,10 @@ constexpr std::array<instrInfo, ClassFile::Instruction::Opcode::_N> infoTable =
   {"instanceof",     "s"},
   {"monitorenter",   ""},
   {"monitorexit",    ""},
-  {"wide",           "c"}, //TODO
+  {"wide",           "c"},
   {"multianewarray", "sb"},
-  {"ifnull",         "s"},
-  {"ifnonnull",      "s"},
+  {"ifnull",         "S"},
+  {"ifnonnull",      "S"},
   {"goto_w",         "I"},
   {"jsr_w",          "I"},
   {"breakpoint",     ""},
@@ -223,89 +227,616 @@ static constexpr std::string_view mnemonic(Instruction::Opcode op)
   return std::get<0>(infoTable[op]);
 }
 
-static constexpr std::string_view format(Instruction::Opcode op)
+//Per-opcode metadata derived from the format strings of infoTable at compile 
+//time, so that queries are a table load instead of a format string scan
+struct OpcodeInfo
+{
+  enum Flag : U8
+  {
+    Complex = 1 << 0,
+    Branch  = 1 << 1,
+    Invoke  = 1 << 2,
+    Constant = 1 << 3,
+  };
+
+  //How the operands are encoded, picks the decoder & encoder
+  enum Layout : U8
+  {
+    Plain,   //single byte operands only, copied as is
+    Swap16,  //a 16 bit operand at offset 0, followed by single byte ones
+    Swap32,  //a 32 bit operand
+    Wide,
+    TableSwitch,
+    LookupSwitch,
+  };
+
+  static constexpr size_t MaxOperands = 3;
+
+  U8 Length;    //opcode byte + operands, 0 for complex instructions
+  U8 NOperands; //0 for complex instructions
+  U8 Flags;
+  Layout Encoding;
+  std::array<U8, MaxOperands> Offsets; //into the operand bytes
+  std::array<U8, MaxOperands> Sizes;
+  std::array<Instruction::OperandType, MaxOperands> Types;
+};
+
+static constexpr U8 operandSize(char type)
+{
+  switch(type)
+  {
+    case 'I': return sizeof(S32);
+    case 'S': return sizeof(S16);
+    case 'B': return sizeof(S8);
+    case 's': return sizeof(U16);
+    case 'b': return sizeof(U8);
+  }
+
+  return 0;
+}
+
+static constexpr OpcodeInfo makeOpcodeInfo(Instruction::Opcode op, std::string_view format)
+{
+  using Op = Instruction::Opcode;
+
+  OpcodeInfo info{};
+
+  if((op >= Op::IFEQ && op <= Op::JSR) || op == Op::TABLESWITCH || op == Op::LOOKUPSWITCH ||
+      op == Op::IFNULL || op == Op::IFNONNULL || op == Op::GOTO_W || op == Op::JSR_W)
+    info.Flags |= OpcodeInfo::Branch;
+
+  if(op >= Op::INVOKEVIRTUAL && op <= Op::INVOKEDYNAMIC)
+    info.Flags |= OpcodeInfo::Invoke;
+
+  if((op >= Op::LDC && op <= Op::LDC2_W) || (op >= Op::GETSTATIC && op <= Op::INVOKEDYNAMIC) ||
+      op == Op::NEW || op == Op::ANEWARRAY || op == Op::CHECKCAST || op == Op::INSTANCEOF || 
+      op == Op::MULTIANEWARRAY)
+    info.Flags |= OpcodeInfo::Constant;
+
+  if(!format.empty() && format[0] == 'c')
+  {
+    info.Flags |= OpcodeInfo::Complex;
+
+    info.Encoding = op == Op::WIDE ? OpcodeInfo::Wide 
+      : op == Op::TABLESWITCH ? OpcodeInfo::TableSwitch : OpcodeInfo::LookupSwitch;
+
+    return info;
+  }
+
+  U8 offset{0};
+  for(size_t i{0}; i < format.size(); ++i)
+  {
+    info.Types[i] = static_cast<Instruction::OperandType>(format[i]);
+    info.Sizes[i] = operandSize(format[i]);
+    info.Offsets[i] = offset;
+    offset += info.Sizes[i];
+  }
+
+  info.NOperands = static_cast<U8>(format.size());
+  info.Length = 1 + offset;
+
+  info.Encoding = OpcodeInfo::Plain;
+  if(info.NOperands > 0 && info.Sizes[0] == sizeof(U16))
+    info.Encoding = OpcodeInfo::Swap16;
+  if(info.NOperands > 0 && info.Sizes[0] == sizeof(U32))
+    info.Encoding = OpcodeInfo::Swap32;
+
+  return info;
+}
+
+//Operands of wide instructions, laid out like a regular instruction's 
+//with a 16 bit index (and constant for iinc). Length includes the widened
+//opcode.
+static constexpr OpcodeInfo makeWideInfo(Instruction::Opcode widened)
+{
+  OpcodeInfo info = makeOpcodeInfo(widened, widened == Instruction::Opcode::IINC ? "sS" : "s");
+  info.Flags = 0;
+  info.Encoding = OpcodeInfo::Wide;
+  info.Length += 1;
+
+  return info;
+}
+
+static constexpr OpcodeInfo wideInfo = makeWideInfo(Instruction::Opcode::ILOAD);
+static constexpr OpcodeInfo wideIincInfo = makeWideInfo(Instruction::Opcode::IINC);
+
+static_assert(wideInfo.Length == 4 && wideIincInfo.Length == 6);
+static_assert(wideIincInfo.Length == Instruction::MaxLength);
+
+static constexpr std::array<OpcodeInfo, Instruction::Opcode::_N> opcodeInfoTable = []()
+{
+  std::array<OpcodeInfo, Instruction::Opcode::_N> table{};
+
+  for(size_t op{0}; op < table.size(); ++op)
+  {
+    auto opcode = static_cast<Instruction::Opcode>(op);
+    table[op] = makeOpcodeInfo(opcode, std::get<1>(infoTable[op]));
+  }
+
+  return table;
+}();
+
+static_assert(opcodeInfoTable[Instruction::Opcode::INVOKEINTERFACE].Length == 5);
+static_assert(opcodeInfoTable[Instruction::Opcode::INVOKEINTERFACE].Offsets[2] == 3);
+static_assert(opcodeInfoTable[Instruction::Opcode::IINC].Length == 3);
+
+static constexpr const OpcodeInfo& info(Instruction::Opcode op)
 {
   assert(static_cast<int>(op) < Instruction::Opcode::_N);
-  return std::get<1>(infoTable[op]);
+  return opcodeInfoTable[op];
 }
 
+static_assert(std::is_trivially_copyable_v<Instruction>);
+
+static_assert([]()
+{
+  for(const auto& info : opcodeInfoTable)
+  {
+    if(info.Length > Instruction::MaxOperandBytes + 1)
+      return false;
+  }
+
+  return true;
+}(), "Instruction::MaxOperandBytes is too small to hold all operands inline");
+
+//Per-instance metadata, wide instructions depend on the widened opcode
+static const OpcodeInfo& info(const Instruction& instr)
+{
+  if(instr.Op == Instruction::Opcode::WIDE)
+    return instr.GetWidenedOpcode() == Instruction::Opcode::IINC ? wideIincInfo : wideInfo;
+
+  return info(instr.Op);
+}
+
+static_assert(sizeof(Instruction) == 8, "Instruction grew past opcode + padding + operands");
+
 ErrorOr<Instruction> Instruction::MakeInstruction(Opcode op)
 {
+  if(op >= Opcode::_N)
+    return Error{ErrorCode::InvalidOpcode, Error::NoOffset, op};
+
   Instruction instr;
   instr.Op = op;
 
-  size_t totalOperandSize{0};
-  for(size_t i{0}; i < Instruction::GetNOperands(op); ++i)
-    totalOperandSize += Instruction::GetOperandSize(op, i);
+  return instr;
+}
 
-  instr.operandBytes.resize(totalOperandSize);
+ErrorOr<Instruction> Instruction::MakeWide(Opcode op)
+{
+  if(op >= Opcode::_N || !Instruction::IsWidenable(op))
+    return Error{ErrorCode::InvalidWide, Error::NoOffset, op};
+
+  Instruction instr;
+  instr.Op = Opcode::WIDE;
+  instr.m_widened = op;
 
   return instr;
 }
 
-std::string_view Instruction::GetMnemonic(Instruction::Opcode op)
+ErrorOr<Instruction> Instruction::MakeSwitch(Opcode op, U32 switchIndex)
 {
-  return mnemonic(op);
+  if(op != Opcode::TABLESWITCH && op != Opcode::LOOKUPSWITCH)
+    return Error{ErrorCode::InvalidOpcode, Error::NoOffset, op};
+
+  Instruction instr;
+  instr.Op = op;
+  instr.SetSwitchIndex(switchIndex);
+
+  return instr;
 }
 
-size_t Instruction::GetNOperands(Instruction::Opcode op)
+//Padding following a switch opcode at offset, so that its operands start at
+//a multiple of 4 from the start of the code array
+static size_t switchPadding(size_t offset)
 {
-  return format(op).size();
+  return (4 - (offset + 1) % 4) % 4;
 }
 
-Instruction::OperandType Instruction::GetOperandType(Instruction::Opcode op, size_t index) 
+size_t Instruction::GetSwitchLength(Opcode op, size_t offset, const SwitchTable& table)
 {
-  assert( format(op).empty()       ||
-          format(op)[index] == 'I' ||
-          format(op)[index] == 'S' ||
-          format(op)[index] == 'B' ||
-          format(op)[index] == 's' ||
-          format(op)[index] == 'b'   );
+  assert(Instruction::IsSwitch(op));
 
-  return static_cast<Instruction::OperandType>(format(op)[index]);
+  size_t len = 1 + switchPadding(offset);
+
+  if(op == Opcode::TABLESWITCH)
+    return len + sizeof(S32) * 3 + sizeof(S32) * table.Offsets.size();
+
+  return len + sizeof(S32) * 2 + sizeof(S32) * 2 * table.Offsets.size();
 }
 
-size_t Instruction::GetOperandSize(Instruction::Opcode op, size_t index) 
+//Reads the switch at code[offset] into table, returns its length
+static ErrorOr<size_t> decodeSwitch(const U8* code, size_t size, size_t offset, 
+    Instruction::Opcode op, SwitchTable* table)
 {
-  size_t size;
+  size_t pos = offset + 1 + switchPadding(offset);
+
+  //default + low + high, default + npairs
+  size_t header = op == Instruction::Opcode::TABLESWITCH ? sizeof(S32) * 3 : sizeof(S32) * 2;
+
+  if(pos > size || size - pos < header)
+    return Error{ErrorCode::BufferOverrun, offset, pos + header - offset, size - offset};
+
+  S32 def, first, second{0};
+  Load<BigEndian>(code + pos, def);
+  Load<BigEndian>(code + pos + 4, first);
+
+  S64 count;
+  size_t entrySize;
 
-  switch( Instruction::GetOperandType(op, index) )
+  if(op == Instruction::Opcode::TABLESWITCH)
   {
-    case 'I': size = sizeof(S32); break;
-    case 'S': size = sizeof(S16); break;
-    case 'B': size = sizeof(S8);  break;
-    case 's': size = sizeof(U16); break;
-    case 'b': size = sizeof(U8);  break;
+    Load<BigEndian>(code + pos + 8, second);
+    count = S64{second} - S64{first} + 1;
+    entrySize = sizeof(S32);
   }
+  else
+  {
+    count = first;
+    entrySize = sizeof(S32) * 2;
+  }
+
+  pos += header;
+  size_t remaining = size - pos;
+
+  bool emptyTable = op == Instruction::Opcode::TABLESWITCH ? count < 1 : count < 0;
+  if(emptyTable || static_cast<U64>(count) > remaining / entrySize)
+    return Error{ErrorCode::InvalidSwitch, offset, static_cast<U64>(std::max<S64>(count, 0)), remaining / entrySize};
 
-  return size;
+  size_t end = pos + static_cast<size_t>(count) * entrySize;
+
+  if(!table)
+    return end - offset;
+
+  table->Default = def;
+  table->Offsets.resize(static_cast<size_t>(count));
+
+  if(op == Instruction::Opcode::TABLESWITCH)
+  {
+    table->Low = first;
+
+    for(auto& target : table->Offsets)
+    {
+      Load<BigEndian>(code + pos, target);
+      pos += sizeof(S32);
+    }
+  }
+  else
+  {
+    table->Low = 0;
+    table->Matches.resize(static_cast<size_t>(count));
+
+    for(size_t i = 0; i < table->Offsets.size(); i++)
+    {
+      Load<BigEndian>(code + pos, table->Matches[i]);
+      Load<BigEndian>(code + pos + 4, table->Offsets[i]);
+      pos += sizeof(S32) * 2;
+    }
+  }
+
+  return end - offset;
 }
 
-size_t Instruction::GetLength(Instruction::Opcode op)
+ErrorOr<Instruction> Instruction::Decode(const U8* code, size_t size, size_t offset,
+    std::vector<SwitchTable>& switches, size_t& length)
 {
-  assert(!Instruction::IsComplex(op));
+  assert(offset < size);
+
+  U8 byte = code[offset];
+  if(byte >= Opcode::_N)
+    return Error{ErrorCode::InvalidOpcode, offset, byte};
+
+  Instruction instr;
+  instr.Op = static_cast<Opcode>(byte);
 
-  //opcode is 1 byte
-  size_t len{1};
+  const OpcodeInfo& opInfo = opcodeInfoTable[byte];
+  const U8* src = code + offset + 1;
+  size_t remaining = size - offset - 1;
 
-  for(size_t i{0}; i < Instruction::GetNOperands(op); ++i)
+  switch(opInfo.Encoding)
   {
-    switch( Instruction::GetOperandType(op, i) )
+    //operand bytes are laid out as encoded, at most one of them (at offset
+    //0) needs its byte order fixed
+    case OpcodeInfo::Plain:
+    case OpcodeInfo::Swap16:
+    case OpcodeInfo::Swap32:
     {
-      case 'I': len+=sizeof(S32); break;
-      case 'S': len+=sizeof(S16); break;
-      case 'B': len+=sizeof(S8);  break;
-      case 's': len+=sizeof(U16); break;
-      case 'b': len+=sizeof(U8);  break;
+      size_t n = opInfo.Length - 1u;
+      if(remaining < n)
+        return Error{ErrorCode::BufferOverrun, offset, opInfo.Length, remaining + 1};
+
+      std::memcpy(instr.operandBytes.data(), src, n);
+
+      if(opInfo.Encoding == OpcodeInfo::Swap16)
+      {
+        U16 value;
+        Load<BigEndian>(src, value);
+        std::memcpy(instr.operandBytes.data(), &value, sizeof(value));
+      }
+      else if(opInfo.Encoding == OpcodeInfo::Swap32)
+      {
+        U32 value;
+        Load<BigEndian>(src, value);
+        std::memcpy(instr.operandBytes.data(), &value, sizeof(value));
+      }
+
+      length = opInfo.Length;
+      return instr;
+    }
+
+    case OpcodeInfo::Wide:
+    {
+      if(remaining < 1)
+        return Error{ErrorCode::BufferOverrun, offset, 2, remaining + 1};
+
+      U8 widened = src[0];
+      if(widened >= Opcode::_N || !Instruction::IsWidenable(static_cast<Opcode>(widened)))
+        return Error{ErrorCode::InvalidWide, offset, widened};
+
+      instr.m_widened = widened;
+
+      const OpcodeInfo& widenedInfo = info(instr);
+      if(remaining + 1 < widenedInfo.Length)
+        return Error{ErrorCode::BufferOverrun, offset, widenedInfo.Length, remaining + 1};
+
+      U16 index;
+      Load<BigEndian>(src + 1, index);
+      std::memcpy(instr.operandBytes.data(), &index, sizeof(index));
+
+      if(widened == Opcode::IINC)
+      {
+        S16 constant;
+        Load<BigEndian>(src + 3, constant);
+        std::memcpy(instr.operandBytes.data() + sizeof(index), &constant, sizeof(constant));
+      }
+
+      length = widenedInfo.Length;
+      return instr;
+    }
+
+    case OpcodeInfo::TableSwitch:
+    case OpcodeInfo::LookupSwitch:
+    {
+      SwitchTable table;
+
+      auto errOrLength = decodeSwitch(code, size, offset, instr.Op, &table);
+      if(errOrLength.IsError())
+        return errOrLength.GetError();
+
+      instr.SetSwitchIndex(static_cast<U32>(switches.size()));
+      switches.emplace_back(std::move(table));
+
+      length = errOrLength.Get();
+      return instr;
     }
   }
 
-  return len;
+  return Error{ErrorCode::InvalidOpcode, offset, byte};
+}
+
+ErrorOr<size_t> Instruction::GetEncodedLength(const U8* code, size_t size, size_t offset)
+{
+  assert(offset < size);
+
+  U8 byte = code[offset];
+  if(byte >= Opcode::_N)
+    return Error{ErrorCode::InvalidOpcode, offset, byte};
+
+  const OpcodeInfo& opInfo = opcodeInfoTable[byte];
+  size_t remaining = size - offset;
+
+  switch(opInfo.Encoding)
+  {
+    case OpcodeInfo::Plain:
+    case OpcodeInfo::Swap16:
+    case OpcodeInfo::Swap32:
+      if(remaining < opInfo.Length)
+        return Error{ErrorCode::BufferOverrun, offset, opInfo.Length, remaining};
+
+      return size_t{opInfo.Length};
+
+    case OpcodeInfo::Wide:
+    {
+      if(remaining < 2)
+        return Error{ErrorCode::BufferOverrun, offset, 2, remaining};
+
+      U8 widened = code[offset + 1];
+      if(widened >= Opcode::_N || !Instruction::IsWidenable(static_cast<Opcode>(widened)))
+        return Error{ErrorCode::InvalidWide, offset, widened};
+
+      size_t len = widened == Opcode::IINC ? wideIincInfo.Length : wideInfo.Length;
+      if(remaining < len)
+        return Error{ErrorCode::BufferOverrun, offset, len, remaining};
+
+      return len;
+    }
+
+    case OpcodeInfo::TableSwitch:
+    case OpcodeInfo::LookupSwitch:
+      return decodeSwitch(code, size, offset, static_cast<Opcode>(byte), nullptr);
+  }
+
+  return Error{ErrorCode::InvalidOpcode, offset, byte};
+}
+
+size_t Instruction::GetLength(size_t offset, const std::vector<SwitchTable>& switches) const
+{
+  if(!this->IsSwitch())
+    return this->GetLength();
+
+  //an invalid index is reported by Encode(), size it as an empty table
+  static const SwitchTable empty{};
+  U32 index = this->GetSwitchIndex();
+
+  return Instruction::GetSwitchLength(this->Op, offset, index < switches.size() ? switches[index] : empty);
+}
+
+ErrorOr<void> Instruction::Encode(U8* dst, size_t offset, const std::vector<SwitchTable>& switches) const
+{
+  const OpcodeInfo& opInfo = info(*this);
+  dst[0] = this->Op;
+
+  switch(opInfo.Encoding)
+  {
+    case OpcodeInfo::Plain:
+      std::memcpy(dst + 1, operandBytes.data(), opInfo.Length - 1u);
+      return {};
+
+    case OpcodeInfo::Swap16:
+    {
+      std::memcpy(dst + 1, operandBytes.data(), opInfo.Length - 1u);
+
+      U16 value;
+      std::memcpy(&value, operandBytes.data(), sizeof(value));
+      Store<BigEndian>(dst + 1, value);
+      return {};
+    }
+
+    case OpcodeInfo::Swap32:
+    {
+      U32 value;
+      std::memcpy(&value, operandBytes.data(), sizeof(value));
+      Store<BigEndian>(dst + 1, value);
+      return {};
+    }
+
+    case OpcodeInfo::Wide:
+    {
+      dst[1] = m_widened;
+
+      U16 index;
+      std::memcpy(&index, operandBytes.data(), sizeof(index));
+      Store<BigEndian>(dst + 2, index);
+
+      if(m_widened == Opcode::IINC)
+      {
+        S16 constant;
+        std::memcpy(&constant, operandBytes.data() + sizeof(index), sizeof(constant));
+        Store<BigEndian>(dst + 4, constant);
+      }
+
+      return {};
+    }
+
+    case OpcodeInfo::TableSwitch:
+    case OpcodeInfo::LookupSwitch:
+      break;
+  }
+
+  U32 index = this->GetSwitchIndex();
+  if(index >= switches.size())
+    return Error{ErrorCode::InvalidSwitch, Error::NoOffset, index, switches.size()};
+
+  const SwitchTable& table = switches[index];
+  bool lookup = this->Op == Opcode::LOOKUPSWITCH;
+
+  //a tableswitch needs at least one entry, a lookupswitch one match per entry
+  if(table.Offsets.empty() && !lookup)
+    return Error{ErrorCode::InvalidSwitch, Error::NoOffset, 0, 0};
+
+  if(lookup && table.Matches.size() != table.Offsets.size())
+    return Error{ErrorCode::InvalidSwitch, Error::NoOffset, table.Offsets.size(), table.Matches.size()};
+
+  size_t padding = switchPadding(offset);
+  std::memset(dst + 1, 0, padding);
+
+  U8* pos = dst + 1 + padding;
+  Store<BigEndian>(pos, table.Default);
+  pos += sizeof(S32);
+
+  if(!lookup)
+  {
+    S32 high = static_cast<S32>(S64{table.Low} + static_cast<S64>(table.Offsets.size()) - 1);
+
+    Store<BigEndian>(pos, table.Low);
+    Store<BigEndian>(pos + 4, high);
+    pos += sizeof(S32) * 2;
+
+    for(S32 target : table.Offsets)
+    {
+      Store<BigEndian>(pos, target);
+      pos += sizeof(S32);
+    }
+
+    return {};
+  }
+
+  Store<BigEndian>(pos, static_cast<S32>(table.Offsets.size()));
+  pos += sizeof(S32);
+
+  for(size_t i = 0; i < table.Offsets.size(); i++)
+  {
+    Store<BigEndian>(pos, table.Matches[i]);
+    Store<BigEndian>(pos + 4, table.Offsets[i]);
+    pos += sizeof(S32) * 2;
+  }
+
+  return {};
+}
+
+std::string_view Instruction::GetMnemonic(Instruction::Opcode op)
+{
+  return mnemonic(op);
+}
+
+size_t Instruction::GetNOperands(Instruction::Opcode op)
+{
+  return info(op).NOperands;
+}
+
+Instruction::OperandType Instruction::GetOperandType(Instruction::Opcode op, size_t index) 
+{
+  assert(index < info(op).NOperands);
+  return info(op).Types[index];
+}
+
+size_t Instruction::GetOperandSize(Instruction::Opcode op, size_t index) 
+{
+  assert(index < info(op).NOperands);
+  return info(op).Sizes[index];
+}
+
+size_t Instruction::GetOperandOffset(Instruction::Opcode op, size_t index) 
+{
+  assert(index < info(op).NOperands);
+  return info(op).Offsets[index];
+}
+
+size_t Instruction::GetLength(Instruction::Opcode op)
+{
+  assert(!Instruction::IsComplex(op));
+  return info(op).Length;
 }
 
 bool Instruction::IsComplex(Instruction::Opcode op) 
 {
-  return format(op)[0] == 'c';
+  return info(op).Flags & OpcodeInfo::Complex;
+}
+
+bool Instruction::IsBranch(Instruction::Opcode op) 
+{
+  return info(op).Flags & OpcodeInfo::Branch;
+}
+
+bool Instruction::IsInvoke(Instruction::Opcode op) 
+{
+  return info(op).Flags & OpcodeInfo::Invoke;
+}
+
+bool Instruction::ReferencesConstant(Instruction::Opcode op) 
+{
+  return info(op).Flags & OpcodeInfo::Constant;
+}
+
+bool Instruction::IsSwitch(Instruction::Opcode op) 
+{
+  return op == Opcode::TABLESWITCH || op == Opcode::LOOKUPSWITCH;
+}
+
+bool Instruction::IsWidenable(Instruction::Opcode op) 
+{
+  return (op >= Opcode::ILOAD && op <= Opcode::ALOAD) 
+    || (op >= Opcode::ISTORE && op <= Opcode::ASTORE)
+    || op == Opcode::RET || op == Opcode::IINC;
 }
 
 std::string_view Instruction::GetMnemonic() const
@@ -315,22 +846,31 @@ std::string_view Instruction::GetMnemonic() const
 
 size_t Instruction::GetNOperands() const
 {
-  return Instruction::GetNOperands(this->Op);
+  return info(*this).NOperands;
 }
 
 Instruction::OperandType Instruction::GetOperandType(size_t index) const
 {
-  return Instruction::GetOperandType(this->Op, index);
+  assert(index < info(*this).NOperands);
+  return info(*this).Types[index];
 }
 
 size_t Instruction::GetOperandSize(size_t index) const
 {
-  return Instruction::GetOperandSize(this->Op, index);
+  assert(index < info(*this).NOperands);
+  return info(*this).Sizes[index];
+}
+
+size_t Instruction::GetOperandOffset(size_t index) const
+{
+  assert(index < info(*this).NOperands);
+  return info(*this).Offsets[index];
 }
 
 size_t Instruction::GetLength() const
 {
-  return Instruction::GetLength(this->Op);
+  assert(!this->IsSwitch());
+  return info(*this).Length;
 }
 
 bool Instruction::IsComplex() const
@@ -338,6 +878,41 @@ bool Instruction::IsComplex() const
   return Instruction::IsComplex(this->Op);
 }
 
+bool Instruction::IsBranch() const
+{
+  return Instruction::IsBranch(this->Op);
+}
+
+bool Instruction::IsInvoke() const
+{
+  return Instruction::IsInvoke(this->Op);
+}
+
+bool Instruction::IsSwitch() const
+{
+  return Instruction::IsSwitch(this->Op);
+}
+
+bool Instruction::ReferencesConstant() const
+{
+  return Instruction::ReferencesConstant(this->Op);
+}
+
+U32 Instruction::GetSwitchIndex() const
+{
+  assert(this->IsSwitch());
+
+  U32 index;
+  std::memcpy(&index, operandBytes.data(), sizeof(index));
+  return index;
+}
+
+void Instruction::SetSwitchIndex(U32 index)
+{
+  assert(this->IsSwitch());
+  std::memcpy(operandBytes.data(), &index, sizeof(index));
+}
+
 template <typename T>
 static ErrorOr<S32> verifyGetOpr(size_t index, const Instruction* instr)
 {
@@ -389,13 +964,11 @@ ErrorOr<void> Instruction::SetOperand(size_t index, S32 value)
 
 Error Instruction::oobError(size_t index) const
 {
-  return Error{ fmt::format("Instruction: out-of-bounds operand access "
-      "at index {}, instruction has {} operand(s).", index, this->GetNOperands())};
+  return Error{ErrorCode::InvalidOperandIndex, Error::NoOffset, index, this->GetNOperands()};
 }
 
-Error Instruction::castError(size_t index, std::string_view type) const
+Error Instruction::castError(size_t index, size_t size) const
 {
-  return Error{ fmt::format("Instruction: invalid operand type cast at index {}, "
-      "failed to cast to \"{}\"", index, type)};
+  return Error{ErrorCode::OperandTypeMismatch, Error::NoOffset, index, size};
 }
 
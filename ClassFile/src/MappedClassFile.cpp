@@ -0,0 +1,69 @@
+#include "ClassFile/MappedClassFile.hpp"
+#include "Util/Error.hpp"
+#include "Util/MappedFile.hpp"
+
+#include <fmt/core.h>
+
+#include <utility>
+
+namespace ClassFile
+{
+
+ErrorOr<MappedClassFile> MappedClassFile::Load(const std::string& path, const ParseOptions& opts)
+{
+  //the parser makes a single front-to-back pass, so let the kernel read ahead
+  auto errOrView = MapFile(path, "MappedClassFile::Load()", true);
+  VERIFY(errOrView);
+
+  ByteView view = errOrView.Get();
+
+  MappedClassFile mapped;
+  mapped.m_data = view.Data;
+  mapped.m_size = view.Size;
+
+  auto errOrClass = Parser::ParseClassFile(mapped.m_data, mapped.m_size, opts);
+  VERIFY(errOrClass, fmt::format("failed to parse \"{}\"", path));
+
+  mapped.m_classFile = errOrClass.Release();
+
+  return mapped;
+}
+
+MappedClassFile::MappedClassFile(MappedClassFile&& other) noexcept
+: m_data{std::exchange(other.m_data, nullptr)}
+, m_size{std::exchange(other.m_size, 0)}
+, m_classFile{std::move(other.m_classFile)}
+{
+}
+
+MappedClassFile& MappedClassFile::operator=(MappedClassFile&& other) noexcept
+{
+  if(this == &other)
+    return *this;
+
+  //drop the nodes borrowing from the current mapping before unmapping it
+  m_classFile = std::move(other.m_classFile);
+  this->unmap();
+
+  m_data = std::exchange(other.m_data, nullptr);
+  m_size = std::exchange(other.m_size, 0);
+
+  return *this;
+}
+
+MappedClassFile::~MappedClassFile()
+{
+  this->unmap();
+}
+
+void MappedClassFile::unmap()
+{
+  if(m_data == nullptr)
+    return;
+
+  UnmapFile({m_data, m_size});
+  m_data = nullptr;
+  m_size = 0;
+}
+
+} //namespace ClassFile
@@ -0,0 +1,55 @@
+#include "ClassFile/Memory.hpp"
+
+namespace ClassFile
+{
+
+namespace
+{
+
+struct AllocationHeader
+{
+  std::pmr::memory_resource* Resource;
+  std::size_t Size;
+};
+
+//keeps the object following the header suitably aligned
+constexpr std::size_t headerSize = 
+  (sizeof(AllocationHeader) + alignof(std::max_align_t) - 1) & ~(alignof(std::max_align_t) - 1);
+
+AllocationHeader* getHeader(void* ptr)
+{
+  return reinterpret_cast<AllocationHeader*>(static_cast<std::byte*>(ptr) - headerSize);
+}
+
+} //namespace
+
+void* ResourceAllocated::operator new(std::size_t size)
+{
+  return ResourceAllocated::operator new(size, std::pmr::new_delete_resource());
+}
+
+void* ResourceAllocated::operator new(std::size_t size, std::pmr::memory_resource* resource)
+{
+  std::size_t total = headerSize + size;
+  void* block = resource->allocate(total, alignof(std::max_align_t));
+
+  new (block) AllocationHeader{resource, total};
+
+  return static_cast<std::byte*>(block) + headerSize;
+}
+
+void ResourceAllocated::operator delete(void* ptr)
+{
+  if(ptr == nullptr)
+    return;
+
+  AllocationHeader* header = getHeader(ptr);
+  header->Resource->deallocate(header, header->Size, alignof(std::max_align_t));
+}
+
+void ResourceAllocated::operator delete(void* ptr, std::pmr::memory_resource*)
+{
+  ResourceAllocated::operator delete(ptr);
+}
+
+} //namespace ClassFile
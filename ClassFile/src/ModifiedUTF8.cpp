@@ -0,0 +1,541 @@
+#include "ClassFile/ModifiedUTF8.hpp"
+
+#include "Util/Error.hpp"
+
+#include <cstring>
+
+//Define CLASSFILE_NO_SIMD to build the scalar fallback only
+#if !defined(CLASSFILE_NO_SIMD) && defined(__SSE2__)
+  #define CLASSFILE_SSE2
+  #include <immintrin.h>
+
+  //AVX2 is compiled in with a target attribute and picked at runtime
+  #if defined(__GNUC__)
+    #define CLASSFILE_AVX2
+  #endif
+#endif
+
+namespace ClassFile
+{
+
+static bool isASCII(U8 byte)
+{
+  return byte != 0 && byte < 0x80;
+}
+
+[[maybe_unused]] static unsigned firstSetBit(U32 mask)
+{
+#if defined(__GNUC__)
+  return static_cast<unsigned>(__builtin_ctz(mask));
+#else
+  unsigned i{0};
+  for(; !(mask & 1); mask >>= 1)
+    i++;
+
+  return i;
+#endif
+}
+
+//8 bytes at a time, a word is skipped if none of its bytes has the high bit
+//set or is zero
+static size_t asciiLengthScalar(const U8* s, size_t n)
+{
+  constexpr U64 ones  = 0x0101010101010101;
+  constexpr U64 highs = 0x8080808080808080;
+
+  size_t i{0};
+  for(; i + sizeof(U64) <= n; i += sizeof(U64))
+  {
+    U64 word;
+    std::memcpy(&word, s + i, sizeof(word));
+
+    if((word | ((word - ones) & ~word)) & highs)
+      break;
+  }
+
+  while(i < n && isASCII(s[i]))
+    i++;
+
+  return i;
+}
+
+#if defined(CLASSFILE_SSE2)
+static size_t asciiLengthSSE2(const U8* s, size_t n)
+{
+  const __m128i zero = _mm_setzero_si128();
+
+  size_t i{0};
+  for(; i + 16 <= n; i += 16)
+  {
+    __m128i v = _mm_loadu_si128(reinterpret_cast<const __m128i*>(s + i));
+    U32 mask = static_cast<U32>(_mm_movemask_epi8(_mm_or_si128(v, _mm_cmpeq_epi8(v, zero))));
+
+    if(mask != 0)
+      return i + firstSetBit(mask);
+  }
+
+  return i + asciiLengthScalar(s + i, n - i);
+}
+#endif
+
+#if defined(CLASSFILE_AVX2)
+__attribute__((target("avx2")))
+static size_t asciiLengthAVX2(const U8* s, size_t n)
+{
+  const __m256i zero = _mm256_setzero_si256();
+
+  size_t i{0};
+  for(; i + 32 <= n; i += 32)
+  {
+    __m256i v = _mm256_loadu_si256(reinterpret_cast<const __m256i*>(s + i));
+    U32 mask = static_cast<U32>(_mm256_movemask_epi8(_mm256_or_si256(v, _mm256_cmpeq_epi8(v, zero))));
+
+    if(mask != 0)
+      return i + firstSetBit(mask);
+  }
+
+  return i + asciiLengthSSE2(s + i, n - i);
+}
+#endif
+
+using ASCIILengthFn = size_t (*)(const U8*, size_t);
+
+static ASCIILengthFn selectASCIILength()
+{
+#if defined(CLASSFILE_AVX2)
+  if(__builtin_cpu_supports("avx2"))
+    return asciiLengthAVX2;
+#endif
+
+#if defined(CLASSFILE_SSE2)
+  return asciiLengthSSE2;
+#else
+  return asciiLengthScalar;
+#endif
+}
+
+static size_t asciiLength(const U8* s, size_t n)
+{
+  static const ASCIILengthFn impl = selectASCIILength();
+  return impl(s, n);
+}
+
+//Zero extends n ASCII bytes
+static void widenASCII(const U8* src, size_t n, char16_t* dst)
+{
+  size_t i{0};
+
+#if defined(CLASSFILE_SSE2)
+  const __m128i zero = _mm_setzero_si128();
+
+  for(; i + 16 <= n; i += 16)
+  {
+    __m128i v = _mm_loadu_si128(reinterpret_cast<const __m128i*>(src + i));
+    _mm_storeu_si128(reinterpret_cast<__m128i*>(dst + i), _mm_unpacklo_epi8(v, zero));
+    _mm_storeu_si128(reinterpret_cast<__m128i*>(dst + i + 8), _mm_unpackhi_epi8(v, zero));
+  }
+#endif
+
+  for(; i < n; i++)
+    dst[i] = src[i];
+}
+
+//Narrows the ASCII prefix of src into dst, returns its length
+static size_t narrowASCII(const char16_t* src, size_t n, char* dst)
+{
+  size_t i{0};
+
+#if defined(CLASSFILE_SSE2)
+  const __m128i zero = _mm_setzero_si128();
+  const __m128i nonASCII = _mm_set1_epi16(static_cast<S16>(0xFF80));
+
+  for(; i + 8 <= n; i += 8)
+  {
+    __m128i v = _mm_loadu_si128(reinterpret_cast<const __m128i*>(src + i));
+    __m128i ascii = _mm_andnot_si128(_mm_cmpeq_epi16(v, zero),
+        _mm_cmpeq_epi16(_mm_and_si128(v, nonASCII), zero));
+
+    if(_mm_movemask_epi8(ascii) != 0xFFFF)
+      break;
+
+    _mm_storel_epi64(reinterpret_cast<__m128i*>(dst + i), _mm_packus_epi16(v, v));
+  }
+#endif
+
+  for(; i < n && src[i] != 0 && src[i] < 0x80; i++)
+    dst[i] = static_cast<char>(src[i]);
+
+  return i;
+}
+
+//Decodes the 2 or 3 byte sequence at s[i] into a UTF-16 code unit, returns
+//its length or 0 if it's invalid. Overlong forms are rejected, except for
+//NUL's 0xC0 0x80.
+static size_t decodeSequence(const U8* s, size_t n, size_t i, char16_t& unit)
+{
+  U8 lead = s[i];
+
+  if((lead & 0xE0) == 0xC0)
+  {
+    if(n - i < 2 || (s[i + 1] & 0xC0) != 0x80)
+      return 0;
+
+    U32 c = (U32{lead & 0x1Fu} << 6) | (s[i + 1] & 0x3Fu);
+    if(c < 0x80 && c != 0)
+      return 0;
+
+    unit = static_cast<char16_t>(c);
+    return 2;
+  }
+
+  if((lead & 0xF0) == 0xE0)
+  {
+    if(n - i < 3 || (s[i + 1] & 0xC0) != 0x80 || (s[i + 2] & 0xC0) != 0x80)
+      return 0;
+
+    U32 c = (U32{lead & 0x0Fu} << 12) | (U32{s[i + 1] & 0x3Fu} << 6) | (s[i + 2] & 0x3Fu);
+    if(c < 0x800)
+      return 0;
+
+    unit = static_cast<char16_t>(c);
+    return 3;
+  }
+
+  return 0;
+}
+
+//Walks a modified UTF-8 string, handing ASCII runs to onASCII(offset, length)
+//and every other sequence to onUnit(offset, length, unit). The walk stops 
+//early once a callback returns false.
+template <typename OnASCII, typename OnUnit>
+static ErrorOr<void> walk(std::string_view str, OnASCII&& onASCII, OnUnit&& onUnit)
+{
+  const U8* s = reinterpret_cast<const U8*>(str.data());
+  size_t n = str.size();
+
+  size_t i{0};
+  while(i < n)
+  {
+    if(isASCII(s[i]))
+    {
+      size_t len = asciiLength(s + i, n - i);
+      if(!onASCII(i, len))
+        return {};
+
+      i += len;
+      continue;
+    }
+
+    char16_t unit;
+    size_t len = decodeSequence(s, n, i, unit);
+
+    if(len == 0)
+      return Error{ErrorCode::InvalidModifiedUTF8, Error::NoOffset, i, s[i]};
+
+    if(!onUnit(i, len, unit))
+      return {};
+
+    i += len;
+  }
+
+  return {};
+}
+
+static bool isHighSurrogate(U32 c) { return c >= 0xD800 && c <= 0xDBFF; }
+static bool isLowSurrogate(U32 c) { return c >= 0xDC00 && c <= 0xDFFF; }
+
+//Encodes a BMP code point or a surrogate into dst, returns the length (at 
+//most 3 bytes)
+static size_t encodeUnit(char* dst, U32 c)
+{
+  if(c == 0)
+  {
+    dst[0] = static_cast<char>(0xC0);
+    dst[1] = static_cast<char>(0x80);
+    return 2;
+  }
+
+  if(c < 0x80)
+  {
+    dst[0] = static_cast<char>(c);
+    return 1;
+  }
+
+  if(c < 0x800)
+  {
+    dst[0] = static_cast<char>(0xC0 | (c >> 6));
+    dst[1] = static_cast<char>(0x80 | (c & 0x3F));
+    return 2;
+  }
+
+  dst[0] = static_cast<char>(0xE0 | (c >> 12));
+  dst[1] = static_cast<char>(0x80 | ((c >> 6) & 0x3F));
+  dst[2] = static_cast<char>(0x80 | (c & 0x3F));
+  return 3;
+}
+
+static void appendUnit(std::string& out, U32 c)
+{
+  char bytes[3];
+  out.append(bytes, encodeUnit(bytes, c));
+}
+
+bool ModifiedUTF8::IsASCII(std::string_view str)
+{
+  return ModifiedUTF8::GetASCIILength(str) == str.size();
+}
+
+size_t ModifiedUTF8::GetASCIILength(std::string_view str)
+{
+  return asciiLength(reinterpret_cast<const U8*>(str.data()), str.size());
+}
+
+ErrorOr<void> ModifiedUTF8::Validate(std::string_view str)
+{
+  return walk(str,
+      [](size_t, size_t) { return true; },
+      [](size_t, size_t, char16_t) { return true; });
+}
+
+ErrorOr<std::string> ModifiedUTF8::ToUTF8(std::string_view str)
+{
+  if(ModifiedUTF8::IsASCII(str))
+    return std::string{str};
+
+  //only NULs (0xC0 0x80) and surrogates (0xED 0xA0-0xBF ..) are encoded 
+  //differently, without either a valid string is copied as is
+  if(str.find('\xC0') == std::string_view::npos && str.find('\xED') == std::string_view::npos)
+  {
+    TRY(ModifiedUTF8::Validate(str));
+    return std::string{str};
+  }
+
+  //never longer than the input, NULs & surrogate pairs shrink
+  std::string out(str.size(), '\0');
+  size_t pos{0};
+
+  //a pending high surrogate, or the unpaired surrogate the walk stopped at
+  U32 surrogate{0};
+  size_t surrogateOffset{0};
+  bool unpaired{false};
+
+  auto err = walk(str,
+      [&](size_t offset, size_t len)
+      {
+        if(surrogate != 0)
+          return !(unpaired = true);
+
+        std::memcpy(&out[pos], str.data() + offset, len);
+        pos += len;
+        return true;
+      },
+      [&](size_t offset, size_t len, char16_t unit)
+      {
+        if(surrogate != 0 && !isLowSurrogate(unit))
+          return !(unpaired = true);
+
+        if(isHighSurrogate(unit))
+        {
+          surrogate = unit;
+          surrogateOffset = offset;
+          return true;
+        }
+
+        if(isLowSurrogate(unit))
+        {
+          if(surrogate == 0)
+          {
+            surrogate = unit;
+            surrogateOffset = offset;
+            return !(unpaired = true);
+          }
+
+          U32 c = 0x10000 + ((surrogate - 0xD800) << 10) + (unit - 0xDC00u);
+          out[pos++] = static_cast<char>(0xF0 | (c >> 18));
+          out[pos++] = static_cast<char>(0x80 | ((c >> 12) & 0x3F));
+          out[pos++] = static_cast<char>(0x80 | ((c >> 6) & 0x3F));
+          out[pos++] = static_cast<char>(0x80 | (c & 0x3F));
+
+          surrogate = 0;
+          return true;
+        }
+
+        if(unit == 0)
+        {
+          out[pos++] = '\0';
+          return true;
+        }
+
+        std::memcpy(&out[pos], str.data() + offset, len);
+        pos += len;
+        return true;
+      });
+
+  VERIFY(err);
+
+  if(unpaired || surrogate != 0)
+    return Error{ErrorCode::UnpairedSurrogate, Error::NoOffset, surrogateOffset, surrogate};
+
+  out.resize(pos);
+  return out;
+}
+
+ErrorOr<std::u16string> ModifiedUTF8::ToUTF16(std::string_view str)
+{
+  //at most one code unit per byte
+  std::u16string out(str.size(), u'\0');
+  size_t pos{0};
+
+  auto err = walk(str,
+      [&](size_t offset, size_t len)
+      {
+        widenASCII(reinterpret_cast<const U8*>(str.data()) + offset, len, &out[pos]);
+        pos += len;
+        return true;
+      },
+      [&](size_t, size_t, char16_t unit)
+      {
+        out[pos++] = unit;
+        return true;
+      });
+
+  VERIFY(err);
+
+  out.resize(pos);
+  return out;
+}
+
+ErrorOr<std::string> ModifiedUTF8::FromUTF8(std::string_view str)
+{
+  const U8* s = reinterpret_cast<const U8*>(str.data());
+  size_t n = str.size();
+
+  size_t i = asciiLength(s, n);
+  if(i == n)
+    return std::string{str};
+
+  std::string out;
+  out.reserve(n + n / 2);
+  out.append(str.data(), i);
+
+  while(i < n)
+  {
+    if(isASCII(s[i]))
+    {
+      size_t len = asciiLength(s + i, n - i);
+      out.append(str.data() + i, len);
+
+      i += len;
+      continue;
+    }
+
+    U8 lead = s[i];
+    size_t len;
+    U32 c;
+
+    if(lead == 0)
+    {
+      len = 1;
+      c = 0;
+    }
+    else if(lead >= 0xC2 && lead <= 0xDF)
+    {
+      len = 2;
+      c = lead & 0x1Fu;
+    }
+    else if(lead >= 0xE0 && lead <= 0xEF)
+    {
+      len = 3;
+      c = lead & 0x0Fu;
+    }
+    else if(lead >= 0xF0 && lead <= 0xF4)
+    {
+      len = 4;
+      c = lead & 0x07u;
+    }
+    else
+    {
+      return Error{ErrorCode::InvalidUTF8, Error::NoOffset, i, lead};
+    }
+
+    if(n - i < len)
+      return Error{ErrorCode::InvalidUTF8, Error::NoOffset, i, lead};
+
+    for(size_t j = 1; j < len; j++)
+    {
+      if((s[i + j] & 0xC0) != 0x80)
+        return Error{ErrorCode::InvalidUTF8, Error::NoOffset, i + j, s[i + j]};
+
+      c = (c << 6) | (s[i + j] & 0x3Fu);
+    }
+
+    //overlong 3 & 4 byte forms, surrogates and code points past U+10FFFF
+    bool invalid = (len == 3 && (c < 0x800 || isHighSurrogate(c) || isLowSurrogate(c)))
+      || (len == 4 && (c < 0x10000 || c > 0x10FFFF));
+
+    if(invalid)
+      return Error{ErrorCode::InvalidUTF8, Error::NoOffset, i, lead};
+
+    if(len == 4)
+    {
+      c -= 0x10000;
+      appendUnit(out, 0xD800 + (c >> 10));
+      appendUnit(out, 0xDC00 + (c & 0x3FF));
+    }
+    else if(c == 0)
+    {
+      appendUnit(out, 0);
+    }
+    else
+    {
+      out.append(str.data() + i, len);
+    }
+
+    i += len;
+  }
+
+  return out;
+}
+
+std::string ModifiedUTF8::FromUTF16(std::u16string_view str)
+{
+  size_t n = str.size();
+
+  std::string out(n, '\0');
+  size_t i = narrowASCII(str.data(), n, &out[0]);
+
+  if(i == n)
+    return out;
+
+  //exact length of the rest, then encode it after the ASCII prefix
+  size_t len{i};
+  for(size_t j = i; j < n; j++)
+  {
+    char16_t c = str[j];
+    len += (c != 0 && c < 0x80) ? 1 : (c < 0x800 ? 2 : 3);
+  }
+
+  out.resize(len);
+  size_t pos{i};
+
+  while(i < n)
+  {
+    char16_t c = str[i];
+
+    if(c != 0 && c < 0x80)
+    {
+      size_t run = narrowASCII(str.data() + i, n - i, &out[pos]);
+
+      pos += run;
+      i += run;
+      continue;
+    }
+
+    pos += encodeUnit(&out[pos], c);
+    i++;
+  }
+
+  return out;
+}
+
+} //namespace ClassFile
@@ -1,21 +1,70 @@
 #include "ClassFile/Parser.hpp"
-
-#include <fmt/core.h>
+#include "ClassFile/ClassVisitor.hpp"
 
 #include "Util/IO.hpp"
 #include "Util/Error.hpp"
 
 #include <cxxabi.h>
 
-#include <iostream>
+#include <algorithm>
 #include <cassert>
 #include <map>
 #include <tuple>
+#include <type_traits>
 
 namespace ClassFile
 {
 
-ErrorOr<ClassFile> Parser::ParseClassFile(std::istream& stream)
+//Parsing is implemented once over a generic Stream, which is either an 
+//std::istream or a ByteReader over an in-memory buffer (see Util/IO.hpp)
+template <typename Stream>
+static ErrorOr<ConstantPool> parseConstantPool(Stream&, const ParseOptions&);
+template <typename Stream>
+static ErrorOr< std::unique_ptr<CPInfo> > parseConstant(Stream&, const ParseOptions&);
+template <typename Stream>
+static ErrorOr<FieldMethodInfo> parseFieldMethodInfo(Stream&, const ParseOptions&, const ConstantPool&);
+template <typename Stream>
+static ErrorOr< std::unique_ptr<AttributeInfo> > parseAttribute(Stream&, const ParseOptions&, const ConstantPool&);
+template <typename Stream>
+static ErrorOr<bool> parseAttributes(Stream&, const ParseOptions&, const ConstantPool&, 
+    std::vector< std::unique_ptr<AttributeInfo> >&);
+static ErrorOr<Instruction> parseInstruction(std::istream&);
+
+//Allocates a CPInfo or AttributeInfo node from ParseOptions::Resource
+template <typename NodeT>
+static NodeT* makeNode(const ParseOptions& opts)
+{
+  if(opts.Resource)
+    return new (opts.Resource) NodeT();
+
+  return new NodeT();
+}
+
+AttributeFilter AttributeFilter::Allow(std::vector<std::string> names)
+{
+  return AttributeFilter{true, std::move(names)};
+}
+
+AttributeFilter AttributeFilter::Deny(std::vector<std::string> names)
+{
+  return AttributeFilter{false, std::move(names)};
+}
+
+AttributeFilter AttributeFilter::StripDebug()
+{
+  return Deny({"SourceFile", "SourceDebugExtension", "LineNumberTable", 
+      "LocalVariableTable", "LocalVariableTypeTable"});
+}
+
+bool AttributeFilter::Keeps(std::string_view name) const
+{
+  //only a handful of names, a linear search beats hashing
+  bool listed = std::find(m_names.begin(), m_names.end(), name) != m_names.end();
+  return listed == m_allow;
+}
+
+template <typename Stream>
+static ErrorOr<ClassFile> parseClassFile(Stream& stream, const ParseOptions& opts)
 {
   ClassFile cf;
 
@@ -24,7 +73,7 @@ ErrorOr<ClassFile> Parser::ParseClassFile(std::istream& stream)
                       cf.MinorVersion,
                       cf.MajorVersion));
 
-  auto errOrCP = Parser::ParseConstantPool(stream);
+  auto errOrCP = parseConstantPool(stream, opts);
   VERIFY(errOrCP);
 
   cf.ConstPool = errOrCP.Release();
@@ -36,13 +85,8 @@ ErrorOr<ClassFile> Parser::ParseClassFile(std::istream& stream)
                       cf.SuperClass,
                       interfacesCount));
 
-  cf.Interfaces.reserve(interfacesCount);
-  for (auto i = 0; i < interfacesCount; i++)
-  {
-    U16 interfaceIndex;
-    TRY( Read<BigEndian>(stream, interfaceIndex));
-    cf.Interfaces.emplace_back(interfaceIndex);
-  }
+  cf.Interfaces.resize(interfacesCount);
+  TRY(ReadArray<BigEndian>(stream, cf.Interfaces.data(), interfacesCount));
 
   U16 fieldsCount;
   TRY(Read<BigEndian>(stream, fieldsCount));
@@ -50,7 +94,7 @@ ErrorOr<ClassFile> Parser::ParseClassFile(std::istream& stream)
   cf.Fields.reserve(fieldsCount);
   for (auto i = 0; i < fieldsCount; i++)
   {
-    auto errOrField = Parser::ParseFieldMethodInfo(stream, cf.ConstPool);
+    auto errOrField = parseFieldMethodInfo(stream, opts, cf.ConstPool);
     VERIFY(errOrField);
 
     cf.Fields.emplace_back(errOrField.Release());
@@ -63,28 +107,30 @@ ErrorOr<ClassFile> Parser::ParseClassFile(std::istream& stream)
   cf.Methods.reserve(methodsCount);
   for (auto i = 0; i < methodsCount; i++)
   {
-    auto errOrMethod = Parser::ParseFieldMethodInfo(stream, cf.ConstPool);
+    auto errOrMethod = parseFieldMethodInfo(stream, opts, cf.ConstPool);
     VERIFY(errOrMethod);
 
     cf.Methods.emplace_back(errOrMethod.Release());
   }
 
-  U16 attributesCount;
-  TRY(Read<BigEndian>(stream, attributesCount));
+  TRY(parseAttributes(stream, opts, cf.ConstPool, cf.Attributes));
 
-  cf.Attributes.reserve(attributesCount);
-  for (auto i = 0; i < attributesCount; i++)
-  {
-    auto errOrAttr = Parser::ParseAttribute(stream, cf.ConstPool);
-    VERIFY(errOrAttr);
+  return cf;
+}
 
-    cf.Attributes.emplace_back(errOrAttr.Release());
-  }
+ErrorOr<ClassFile> Parser::ParseClassFile(std::istream& stream)
+{
+  return parseClassFile(stream, ParseOptions{});
+}
 
-  return cf;
+ErrorOr<ClassFile> Parser::ParseClassFile(const U8* data, size_t size, const ParseOptions& opts)
+{
+  ByteReader reader{data, size};
+  return parseClassFile(reader, opts);
 }
 
-ErrorOr<ConstantPool> Parser::ParseConstantPool(std::istream& stream)
+template <typename Stream>
+static ErrorOr<ConstantPool> parseConstantPool(Stream& stream, const ParseOptions& opts)
 {
   ConstantPool cp;
 
@@ -96,7 +142,7 @@ ErrorOr<ConstantPool> Parser::ParseConstantPool(std::istream& stream)
   //count = number of constants + 1
   for(U16 i = 0; i < count-1; i++)
   {
-    auto errOrCPInfo = Parser::ParseConstant(stream);
+    auto errOrCPInfo = parseConstant(stream, opts);
     VERIFY(errOrCPInfo);
 
     auto cpInfo = errOrCPInfo.Release();
@@ -118,262 +164,505 @@ ErrorOr<ConstantPool> Parser::ParseConstantPool(std::istream& stream)
   return cp;
 }
 
-static ErrorOr<void> readConst(std::istream& stream, ClassInfo& info)
+ErrorOr<ConstantPool> Parser::ParseConstantPool(std::istream& stream)
+{
+  return parseConstantPool(stream, ParseOptions{});
+}
+
+template <typename Stream>
+static ErrorOr<void> readConst(Stream& stream, const ParseOptions& opts, ClassInfo& info)
 {
   TRY(Read<BigEndian>(stream, info.NameIndex));
   return {};
 }
 
-static ErrorOr<void> readConst(std::istream& stream, FieldrefInfo& info)
+template <typename Stream>
+static ErrorOr<void> readConst(Stream& stream, const ParseOptions& opts, FieldrefInfo& info)
 {
   TRY(Read<BigEndian>(stream, info.ClassIndex, info.NameAndTypeIndex));
   return {};
 }
 
-static ErrorOr<void> readConst(std::istream& stream, MethodrefInfo& info)
+template <typename Stream>
+static ErrorOr<void> readConst(Stream& stream, const ParseOptions& opts, MethodrefInfo& info)
 {
   TRY(Read<BigEndian>(stream, info.ClassIndex, info.NameAndTypeIndex));
   return {};
 }
 
-static ErrorOr<void> readConst(std::istream& stream, InterfaceMethodrefInfo& info)
+template <typename Stream>
+static ErrorOr<void> readConst(Stream& stream, const ParseOptions& opts, InterfaceMethodrefInfo& info)
 {
   TRY(Read<BigEndian>(stream, info.ClassIndex, info.NameAndTypeIndex));
   return {};
 }
 
-static ErrorOr<void> readConst(std::istream& stream, StringInfo& info)
+template <typename Stream>
+static ErrorOr<void> readConst(Stream& stream, const ParseOptions& opts, StringInfo& info)
 {
   TRY(Read<BigEndian>(stream, info.StringIndex));
   return {};
 }
 
-static ErrorOr<void> readConst(std::istream& stream, IntegerInfo& info)
+template <typename Stream>
+static ErrorOr<void> readConst(Stream& stream, const ParseOptions& opts, IntegerInfo& info)
 {
   TRY(Read<BigEndian>(stream, info.Bytes));
   return {};
 }
 
-static ErrorOr<void> readConst(std::istream& stream, FloatInfo& info)
+template <typename Stream>
+static ErrorOr<void> readConst(Stream& stream, const ParseOptions& opts, FloatInfo& info)
 {
   TRY(Read<BigEndian>(stream, info.Bytes));
   return {};
 }
 
-static ErrorOr<void> readConst(std::istream& stream, LongInfo& info)
+template <typename Stream>
+static ErrorOr<void> readConst(Stream& stream, const ParseOptions& opts, LongInfo& info)
 {
   TRY(Read<BigEndian>(stream, info.HighBytes, info.LowBytes));
   return {};
 }
 
-static ErrorOr<void> readConst(std::istream& stream, DoubleInfo& info)
+template <typename Stream>
+static ErrorOr<void> readConst(Stream& stream, const ParseOptions& opts, DoubleInfo& info)
 {
   TRY(Read<BigEndian>(stream, info.HighBytes, info.LowBytes));
   return {};
 }
 
-static ErrorOr<void> readConst(std::istream& stream, NameAndTypeInfo& info)
+template <typename Stream>
+static ErrorOr<void> readConst(Stream& stream, const ParseOptions& opts, NameAndTypeInfo& info)
 {
   TRY(Read<BigEndian>(stream, info.NameIndex, info.DescriptorIndex));
   return {};
 }
 
-static ErrorOr<void> readConst(std::istream& stream, UTF8Info& info)
+template <typename Stream>
+static ErrorOr<void> readConst(Stream& stream, const ParseOptions& opts, UTF8Info& info)
 {
   U16 len;
   TRY(Read<BigEndian>(stream, len));
 
-  //TODO: add IO util func for this
-  info.String = std::string(len, '\0');
-  stream.read(&info.String[0], len);
+  if constexpr (std::is_same_v<Stream, ByteReader>)
+  {
+    if(opts.BorrowBuffer)
+    {
+      auto errOrView = ReadView(stream, len);
+      VERIFY(errOrView, "Parser::readConst(UTF8Info): failed to read string");
+
+      info.Borrow(errOrView.Get());
+    }
+  }
+
+  if(!info.IsBorrowed())
+  {
+    info.String = std::string(len, '\0');
+    TRY(ReadBytes(stream, &info.String[0], len), "Parser::readConst(UTF8Info): failed to read string");
+  }
 
-  if (stream.bad())
-    return Error{fmt::format("Parser::readConst(UTF8Info): failed to read string")};
+  if(opts.ValidateUTF8)
+    TRY(info.Validate(), "Parser::readConst(UTF8Info): invalid string");
 
   return {};
 }
 
-static ErrorOr<void> readConst(std::istream& stream, MethodHandleInfo& info)
+template <typename Stream>
+static ErrorOr<void> readConst(Stream& stream, const ParseOptions& opts, MethodHandleInfo& info)
 {
   TRY(Read<BigEndian>(stream, info.ReferenceKind, info.ReferenceIndex));
   return {};
 }
 
-static ErrorOr<void> readConst(std::istream& stream, MethodTypeInfo& info)
+template <typename Stream>
+static ErrorOr<void> readConst(Stream& stream, const ParseOptions& opts, MethodTypeInfo& info)
 {
   TRY(Read<BigEndian>(stream, info.DescriptorIndex));
   return {};
 }
 
-static ErrorOr<void> readConst(std::istream& stream, InvokeDynamicInfo& info)
+template <typename Stream>
+static ErrorOr<void> readConst(Stream& stream, const ParseOptions& opts, InvokeDynamicInfo& info)
 {
   TRY(Read<BigEndian>(stream, info.BootstrapMethodAttrIndex, info.NameAndTypeIndex));
   return {};
 }
 
-template <typename CPInfoT>
-static ErrorOr< std::unique_ptr<CPInfo> > parseConstT(std::istream& stream)
+template <typename CPInfoT, typename Stream>
+static ErrorOr< std::unique_ptr<CPInfo> > parseConstT(Stream& stream, const ParseOptions& opts)
 {
-  CPInfoT* pInfo = new CPInfoT{};
-  auto errOrConst = readConst(stream, *pInfo);
+  std::unique_ptr<CPInfoT> pInfo{ makeNode<CPInfoT>(opts) };
+  auto errOrConst = readConst(stream, opts, *pInfo);
   VERIFY(errOrConst);
 
-  return std::unique_ptr<CPInfo>(pInfo);
+  return std::unique_ptr<CPInfo>(std::move(pInfo));
 }
 
-ErrorOr< std::unique_ptr<CPInfo> > Parser::ParseConstant(std::istream& stream)
+template <typename Stream>
+static ErrorOr< std::unique_ptr<CPInfo> > parseConstant(Stream& stream, const ParseOptions& opts)
 {
-  CPInfo::Type type = static_cast<CPInfo::Type>(stream.get());
+  U8 tag;
+  TRY(Read<BigEndian>(stream, tag));
+
+  CPInfo::Type type = static_cast<CPInfo::Type>(tag);
 
   switch(type)
   {
-    case CPInfo::Type::Class:       return parseConstT<ClassInfo>(stream);
-    case CPInfo::Type::Fieldref:    return parseConstT<FieldrefInfo>(stream);
-    case CPInfo::Type::Methodref:   return parseConstT<MethodrefInfo>(stream);
-    case CPInfo::Type::InterfaceMethodref: return parseConstT<InterfaceMethodrefInfo>(stream);
-    case CPInfo::Type::String:      return parseConstT<StringInfo>(stream);
-    case CPInfo::Type::Integer:     return parseConstT<IntegerInfo>(stream);
-    case CPInfo::Type::Float:       return parseConstT<FloatInfo>(stream);
-    case CPInfo::Type::Long:        return parseConstT<LongInfo>(stream);
-    case CPInfo::Type::Double:      return parseConstT<DoubleInfo>(stream);
-    case CPInfo::Type::NameAndType: return parseConstT<NameAndTypeInfo>(stream);
-    case CPInfo::Type::UTF8:        return parseConstT<UTF8Info>(stream);
-    case CPInfo::Type::MethodHandle:  return parseConstT<MethodHandleInfo>(stream);
-    case CPInfo::Type::MethodType:    return parseConstT<MethodTypeInfo>(stream);
-    case CPInfo::Type::InvokeDynamic: return parseConstT<InvokeDynamicInfo>(stream);
+    case CPInfo::Type::Class:       return parseConstT<ClassInfo>(stream, opts);
+    case CPInfo::Type::Fieldref:    return parseConstT<FieldrefInfo>(stream, opts);
+    case CPInfo::Type::Methodref:   return parseConstT<MethodrefInfo>(stream, opts);
+    case CPInfo::Type::InterfaceMethodref: return parseConstT<InterfaceMethodrefInfo>(stream, opts);
+    case CPInfo::Type::String:      return parseConstT<StringInfo>(stream, opts);
+    case CPInfo::Type::Integer:     return parseConstT<IntegerInfo>(stream, opts);
+    case CPInfo::Type::Float:       return parseConstT<FloatInfo>(stream, opts);
+    case CPInfo::Type::Long:        return parseConstT<LongInfo>(stream, opts);
+    case CPInfo::Type::Double:      return parseConstT<DoubleInfo>(stream, opts);
+    case CPInfo::Type::NameAndType: return parseConstT<NameAndTypeInfo>(stream, opts);
+    case CPInfo::Type::UTF8:        return parseConstT<UTF8Info>(stream, opts);
+    case CPInfo::Type::MethodHandle:  return parseConstT<MethodHandleInfo>(stream, opts);
+    case CPInfo::Type::MethodType:    return parseConstT<MethodTypeInfo>(stream, opts);
+    case CPInfo::Type::InvokeDynamic: return parseConstT<InvokeDynamicInfo>(stream, opts);
   }
 
-  return Error{fmt::format("Parser::ParseConstant: encountered unknown tag "
-      "value \"{}\"", static_cast<U8>(type))};
+  return Error{ErrorCode::UnknownConstantTag, Tell(stream) - sizeof(tag), tag};
 }
 
-ErrorOr<FieldMethodInfo> Parser::ParseFieldMethodInfo(
-    std::istream& stream, const ConstantPool& constPool)
+ErrorOr< std::unique_ptr<CPInfo> > Parser::ParseConstant(std::istream& stream)
+{
+  return parseConstant(stream, ParseOptions{});
+}
+
+//Range of the buffer read since start, if the node should retain it
+template <typename Stream>
+static ByteView getSource(const Stream& stream, const ParseOptions& opts, size_t start)
+{
+  if constexpr (std::is_same_v<Stream, ByteReader>)
+  {
+    if(opts.BorrowBuffer && opts.RetainSource)
+      return ByteView{stream.Data() + start, stream.Tell() - start};
+  }
+
+  return {};
+}
+
+template <typename Stream>
+static ErrorOr<FieldMethodInfo> parseFieldMethodInfo(
+    Stream& stream, const ParseOptions& opts, const ConstantPool& constPool)
 {
   FieldMethodInfo info;
+  size_t start = Tell(stream);
 
-  U16 attributesCount;
   TRY(Read<BigEndian>(stream, info.AccessFlags,
                               info.NameIndex,
-                              info.DescriptorIndex,
-                              attributesCount));
+                              info.DescriptorIndex));
 
-  info.Attributes.reserve(attributesCount);
-  for (auto i = 0; i < attributesCount; i++)
-  {
-    auto errOrAttr = Parser::ParseAttribute(stream, constPool);
-    VERIFY(errOrAttr);
+  auto errOrComplete = parseAttributes(stream, opts, constPool, info.Attributes);
+  VERIFY(errOrComplete);
 
-    info.Attributes.emplace_back(errOrAttr.Release());
-  }
+  //the source would still contain filtered out attributes
+  if(errOrComplete.Get())
+    info.SetSource(getSource(stream, opts, start));
 
   return info;
 }
 
+ErrorOr<FieldMethodInfo> Parser::ParseFieldMethodInfo(
+    std::istream& stream, const ConstantPool& constPool)
+{
+  return parseFieldMethodInfo(stream, ParseOptions{}, constPool);
+}
 
-static ErrorOr<void> readAttribute(std::istream& stream, 
+template <typename Stream>
+static ErrorOr<void> readAttribute(Stream& stream, const ParseOptions& opts,
     const ConstantPool& constPool, ConstantValueAttribute& attr)
 {
   TRY(Read<BigEndian>(stream, attr.Index));
   return {};
 }
 
-static ErrorOr<void> readAttribute(std::istream& stream, 
+template <typename Stream>
+static ErrorOr<void> readAttribute(Stream& stream, const ParseOptions& opts,
     const ConstantPool& constPool, SourceFileAttribute& attr)
 {
   TRY(Read<BigEndian>(stream, attr.SourceFileIndex));
   return {};
 }
 
-static ErrorOr<void> readAttribute(std::istream& stream, 
+template <typename Stream>
+static ErrorOr<void> readAttribute(Stream& stream, const ParseOptions& opts,
+    const ConstantPool& constPool, EnclosingMethodAttribute& attr)
+{
+  TRY(Read<BigEndian>(stream, attr.ClassIndex, attr.MethodIndex));
+  return {};
+}
+
+template <typename Stream>
+static ErrorOr<void> readAttribute(Stream& stream, const ParseOptions& opts,
+    const ConstantPool& constPool, SyntheticAttribute& attr)
+{
+  return {};
+}
+
+template <typename Stream>
+static ErrorOr<void> readAttribute(Stream& stream, const ParseOptions& opts,
+    const ConstantPool& constPool, DeprecatedAttribute& attr)
+{
+  return {};
+}
+
+template <typename Stream>
+static ErrorOr<void> readAttribute(Stream& stream, const ParseOptions& opts,
+    const ConstantPool& constPool, SignatureAttribute& attr)
+{
+  TRY(Read<BigEndian>(stream, attr.SignatureIndex));
+  return {};
+}
+
+template <typename Stream>
+static ErrorOr<void> readAttribute(Stream& stream, const ParseOptions& opts,
+    const ConstantPool& constPool, NestHostAttribute& attr)
+{
+  TRY(Read<BigEndian>(stream, attr.HostClassIndex));
+  return {};
+}
+
+template <typename Stream>
+static ErrorOr<void> readAttribute(Stream& stream, const ParseOptions& opts,
+    const ConstantPool& constPool, ModuleMainClassAttribute& attr)
+{
+  TRY(Read<BigEndian>(stream, attr.MainClassIndex));
+  return {};
+}
+
+//The code array is decoded from memory, instructions like the switches need
+//their offset & bounds. A ByteReader is viewed in place, streams are read
+//into scratch.
+static ErrorOr<ByteView> readCodeArray(ByteReader& reader, U32 codeLen, std::vector<U8>&)
+{
+  return ReadView(reader, codeLen);
+}
+
+static ErrorOr<ByteView> readCodeArray(std::istream& stream, U32 codeLen, std::vector<U8>& scratch)
+{
+  scratch.resize(codeLen);
+  TRY(ReadBytes(stream, scratch.data(), codeLen));
+
+  return ByteView{scratch.data(), scratch.size()};
+}
+
+//Reads everything of a Code attribute following max_locals
+template <typename Stream>
+static ErrorOr<void> readCodeBody(Stream& stream, const ParseOptions& opts,
+    const ConstantPool& constPool, CodeAttribute& attr)
+{
+  U32 codeLen{};
+  TRY(Read<BigEndian>(stream, codeLen));
+
+  std::vector<U8> scratch;
+  auto errOrCode = readCodeArray(stream, codeLen, scratch);
+  VERIFY(errOrCode, "failed to read code array");
+
+  ByteView code = errOrCode.Get();
+
+  size_t offset{0};
+  while(offset < code.Size)
+  {
+    size_t length;
+    auto errOrInstr = Instruction::Decode(code.Data, code.Size, offset, attr.Switches, length);
+    //carries the offset into the code array
+    VERIFY(errOrInstr, "failed to decode instruction");
+
+    attr.Code.emplace_back(errOrInstr.Get());
+    offset += length;
+  }
+
+  U16 exceptionTableLen;
+  TRY(Read<BigEndian>(stream, exceptionTableLen));
+
+  attr.ExceptionTable.resize(exceptionTableLen);
+  TRY((ReadArray<BigEndian, U16>(stream, attr.ExceptionTable.data(), exceptionTableLen)));
+
+  TRY(parseAttributes(stream, opts, constPool, attr.Attributes));
+
+  return {};
+}
+
+template <typename Stream>
+static ErrorOr<void> readAttribute(Stream& stream, const ParseOptions& opts,
     const ConstantPool& constPool, CodeAttribute& attr)
 {
-  U32 codeLen;
   TRY(Read<BigEndian>(stream, 
                       attr.MaxStack,
-                      attr.MaxLocals,
-                      codeLen));
+                      attr.MaxLocals));
 
+  return readCodeBody(stream, opts, constPool, attr);
+}
 
-  U32 parsedCodeLen{0};
-  while(parsedCodeLen < codeLen)
-  {
-    auto streampos_before = stream.tellg();
+template <typename AttributeT, typename Stream>
+static ErrorOr< std::unique_ptr<AttributeInfo> > parseAttributeT(Stream& stream, 
+    const ParseOptions& opts, const ConstantPool& constPool, U16 nameIndex, U32 len)
+{
+  std::unique_ptr<AttributeT> attr{ makeNode<AttributeT>(opts) };
+  attr->NameIndex = nameIndex;
 
-    //TODO: handle padding for instructions that require alignment
-    auto errOrInstr = Parser::ParseInstruction(stream);
-    VERIFY(errOrInstr);
+  size_t start = Tell(stream);
 
-    attr.Code.emplace_back(errOrInstr.Release());
+  auto err = readAttribute(stream, opts, constPool, *attr);
+  VERIFY(err);
 
-    auto parsed = stream.tellg() - streampos_before;
-    assert(parsed > 0);
+  //a buffer knows how much was read, which still matches if nested 
+  //attributes were filtered out (streams aren't filtered)
+  size_t attrLen;
+  if constexpr (std::is_same_v<Stream, ByteReader>)
+    attrLen = stream.Tell() - start;
+  else
+    attrLen = attr->GetLength();
 
-    parsedCodeLen += parsed;
+  if(attrLen != len)
+  {
+    return Error{ErrorCode::LengthMismatch, Tell(stream), len, attrLen};
   }
 
-  if(parsedCodeLen != codeLen)
+  return std::unique_ptr<AttributeInfo>(std::move(attr));
+}
+
+//Retains the next bodyLen bytes as the undecoded body of attr, borrowed from
+//the buffer if possible
+template <typename Stream>
+static ErrorOr<void> deferBody(Stream& stream, const ParseOptions& opts, 
+    LazyAttribute& attr, U32 bodyLen)
+{
+  if constexpr (std::is_same_v<Stream, ByteReader>)
   {
-    return Error{fmt::format("Parser::readAttribute(CodeAttr): "
-        "CodeLen field indicates codelen of: {}, "
-        "but total code bytes parsed was: {}.", codeLen, parsedCodeLen)};
+    if(opts.BorrowBuffer)
+    {
+      auto errOrView = ReadView(stream, bodyLen);
+      VERIFY(errOrView);
+
+      attr.Defer(errOrView.Get());
+      return {};
+    }
   }
 
-  //TODO: create a read util function for these sorts of 
-  //      "read length, then read array of that length" scenarios
-  U16 exceptionTableLen;
-  TRY(Read<BigEndian>(stream, exceptionTableLen));
+  std::vector<U8> body(bodyLen);
+  TRY(ReadBytes(stream, body.data(), bodyLen));
+
+  attr.Defer(std::move(body));
+  return {};
+}
+
+//Drops the nested attributes rejected by filter from the undecoded body of
+//a Code attribute, seeking past the code array & exception table without
+//decoding them. The body is only rebuilt (and owned) if something is dropped.
+static ErrorOr<void> filterLazyCode(CodeAttribute& attr, const ConstantPool& constPool, 
+    const AttributeFilter& filter)
+{
+  ByteView body = attr.GetUndecodedBody();
+  ByteReader reader{body.Data, body.Size};
 
-  attr.ExceptionTable.reserve(exceptionTableLen);
-  for(auto i = 0; i < exceptionTableLen; i++)
+  U32 codeLen{};
+  TRY(Read<BigEndian>(reader, codeLen));
+  TRY(Skip(reader, codeLen));
+
+  U16 handlerCount{};
+  TRY(Read<BigEndian>(reader, handlerCount));
+  TRY(Skip(reader, handlerCount * sizeof(CodeAttribute::ExceptionHandler)));
+
+  size_t tableStart = reader.Tell();
+
+  U16 count{};
+  TRY(Read<BigEndian>(reader, count));
+
+  //first pass only counts, most bodies keep everything
+  U16 kept{0};
+  for(U16 i = 0; i < count; i++)
   {
-    CodeAttribute::ExceptionHandler handler;
-    TRY(Read<BigEndian>(stream, handler.StartPC, 
-                                handler.EndPC, 
-                                handler.HandlerPC, 
-                                handler.CatchType));
+    U16 nameIndex{};
+    U32 len{};
+    TRY(Read<BigEndian>(reader, nameIndex, len));
+    TRY(Skip(reader, len));
 
-    attr.ExceptionTable.emplace_back(handler);
+    auto errOrName = constPool.LookupString(nameIndex);
+    VERIFY(errOrName);
+
+    if(filter.Keeps(errOrName.Get()))
+      kept++;
   }
 
-  U16 attributesCount;
-  TRY(Read<BigEndian>(stream, attributesCount));
+  if(kept == count)
+    return {};
+
+  std::vector<U8> filtered;
+  filtered.reserve(body.Size);
+  filtered.insert(filtered.end(), body.Data, body.Data + tableStart);
+  filtered.push_back(static_cast<U8>(kept >> 8));
+  filtered.push_back(static_cast<U8>(kept));
 
-  attr.Attributes.reserve(attributesCount);
-  for(auto i = 0; i < attributesCount; i++)
+  reader = ByteReader{body.Data, body.Size};
+  TRY(Skip(reader, tableStart + sizeof(U16)));
+
+  for(U16 i = 0; i < count; i++)
   {
-    auto errOrAttr = Parser::ParseAttribute(stream, constPool);
-    VERIFY(errOrAttr);
+    size_t start = reader.Tell();
 
-    attr.Attributes.emplace_back( errOrAttr.Release() );
+    U16 nameIndex{};
+    U32 len{};
+    TRY(Read<BigEndian>(reader, nameIndex, len));
+    TRY(Skip(reader, len));
+
+    if(filter.Keeps(constPool.LookupString(nameIndex).Get()))
+      filtered.insert(filtered.end(), body.Data + start, body.Data + reader.Tell());
   }
 
+  //trailing bytes are left for Parser::DecodeCode() to reject
+  filtered.insert(filtered.end(), body.Data + reader.Tell(), body.Data + body.Size);
+
+  attr.Defer(std::move(filtered));
   return {};
 }
 
-template <typename AttributeT>
-static ErrorOr< std::unique_ptr<AttributeInfo> > parseAttributeT(
-    std::istream& stream, const ConstantPool& constPool, U16 nameIndex, U32 len)
+//Reads max_stack & max_locals and retains the rest of the attribute for
+//Parser::DecodeCode(), without the nested attributes rejected by 
+//ParseOptions::Filter
+template <typename Stream>
+static ErrorOr< std::unique_ptr<AttributeInfo> > parseLazyCodeAttribute(
+    Stream& stream, const ParseOptions& opts, const ConstantPool& constPool, U16 nameIndex, U32 len)
 {
-  AttributeT* attr = new AttributeT();
+  //max_stack, max_locals, code_length, exception_table_length, attributes_count
+  constexpr U32 minLen = sizeof(U16) * 2 + sizeof(U32) + sizeof(U16) * 2;
+
+  if(len < minLen)
+    return Error{ErrorCode::LengthMismatch, Tell(stream), minLen, len};
+
+  std::unique_ptr<CodeAttribute> attr{ makeNode<CodeAttribute>(opts) };
   attr->NameIndex = nameIndex;
 
-  auto err = readAttribute(stream, constPool, *attr);
-  VERIFY(err);
+  TRY(Read<BigEndian>(stream, attr->MaxStack, attr->MaxLocals));
+  TRY(deferBody(stream, opts, *attr, len - sizeof(U16) * 2));
 
-  U32 attrLen = attr->GetLength();
-  if(attrLen != len)
-  {
-    return Error{ fmt::format("Parser::parseAttributeT<{}>(): "
-        "AttrLen field indicates len of: {}, "
-        "but total len of parsed bytes was: {}", typeid(AttributeT).name(), len, attrLen)};
-  }
+  if(!opts.Filter.KeepsAll())
+    TRY(filterLazyCode(*attr, constPool, opts.Filter));
 
-  return std::unique_ptr<AttributeInfo>(attr);
+  return std::unique_ptr<AttributeInfo>(std::move(attr));
 }
 
-ErrorOr< std::unique_ptr<AttributeInfo> > Parser::ParseAttribute(
-    std::istream& stream, const ConstantPool& constPool)
+//Retains the whole body for Parser::DecodeAttribute()
+template <typename AttributeT, typename Stream>
+static ErrorOr< std::unique_ptr<AttributeInfo> > parseLazyAttribute(
+    Stream& stream, const ParseOptions& opts, U16 nameIndex, U32 len)
+{
+  std::unique_ptr<AttributeT> attr{ makeNode<AttributeT>(opts) };
+  attr->NameIndex = nameIndex;
+
+  TRY(deferBody(stream, opts, *attr, len));
+
+  return std::unique_ptr<AttributeInfo>(std::move(attr));
+}
+
+template <typename Stream>
+static ErrorOr< std::unique_ptr<AttributeInfo> > parseAttributeNode(
+    Stream& stream, const ParseOptions& opts, const ConstantPool& constPool)
 {
   U16 nameIndex;
   U32 len;
@@ -382,85 +671,1093 @@ ErrorOr< std::unique_ptr<AttributeInfo> > Parser::ParseAttribute(
   auto errOrName = constPool.LookupString(nameIndex);
   VERIFY(errOrName);
 
-  auto errOrType = AttributeInfo::GetType(errOrName.Get());
-
-  AttributeInfo::Type type;
-  if (errOrType.IsError())
+  if(!opts.Filter.Keeps(errOrName.Get()))
   {
-    std::cerr << "[WARNING]: " << errOrType.GetError().What;
-    std::cerr << " (interpreting as raw attribute instead)\n";
-    type = AttributeInfo::Type::Raw;
+    TRY(Skip(stream, len));
+    return std::unique_ptr<AttributeInfo>{};
   }
-  else
-    type = errOrType.Get();
+
+  //unknown attributes are kept as RawAttribute
+  auto errOrType = AttributeInfo::GetType(errOrName.Get());
+  auto type = errOrType.IsError() ? AttributeInfo::Type::Raw : errOrType.Get();
 
   switch (type)
   {
-    case AttributeInfo::Type::ConstantValue: 
-      return parseAttributeT<ConstantValueAttribute>(stream, constPool, nameIndex, len);
-    case AttributeInfo::Type::SourceFile: 
-      return parseAttributeT<SourceFileAttribute>(stream, constPool, nameIndex, len);
-    case AttributeInfo::Type::Code: 
-      return parseAttributeT<CodeAttribute>(stream, constPool, nameIndex, len);
+    using Type = AttributeInfo::Type;
+
+    case Type::ConstantValue: 
+      return parseAttributeT<ConstantValueAttribute>(stream, opts, constPool, nameIndex, len);
+    case Type::SourceFile: 
+      return parseAttributeT<SourceFileAttribute>(stream, opts, constPool, nameIndex, len);
+    case Type::EnclosingMethod: 
+      return parseAttributeT<EnclosingMethodAttribute>(stream, opts, constPool, nameIndex, len);
+    case Type::Synthetic: 
+      return parseAttributeT<SyntheticAttribute>(stream, opts, constPool, nameIndex, len);
+    case Type::Deprecated: 
+      return parseAttributeT<DeprecatedAttribute>(stream, opts, constPool, nameIndex, len);
+    case Type::Signature: 
+      return parseAttributeT<SignatureAttribute>(stream, opts, constPool, nameIndex, len);
+    case Type::NestHost: 
+      return parseAttributeT<NestHostAttribute>(stream, opts, constPool, nameIndex, len);
+    case Type::ModuleMainClass: 
+      return parseAttributeT<ModuleMainClassAttribute>(stream, opts, constPool, nameIndex, len);
+    case Type::Code: 
+      if(opts.LazyCode)
+        return parseLazyCodeAttribute(stream, opts, constPool, nameIndex, len);
+
+      return parseAttributeT<CodeAttribute>(stream, opts, constPool, nameIndex, len);
+
+    case Type::StackMapTable:
+      return parseLazyAttribute<StackMapTableAttribute>(stream, opts, nameIndex, len);
+    case Type::Exceptions:
+      return parseLazyAttribute<ExceptionsAttribute>(stream, opts, nameIndex, len);
+    case Type::InnerClasses:
+      return parseLazyAttribute<InnerClassesAttribute>(stream, opts, nameIndex, len);
+    case Type::SourceDebugExtension:
+      return parseLazyAttribute<SourceDebugExtensionAttribute>(stream, opts, nameIndex, len);
+    case Type::LineNumberTable:
+      return parseLazyAttribute<LineNumberTableAttribute>(stream, opts, nameIndex, len);
+    case Type::LocalVariableTable:
+      return parseLazyAttribute<LocalVariableTableAttribute>(stream, opts, nameIndex, len);
+    case Type::LocalVariableTypeTable:
+      return parseLazyAttribute<LocalVariableTypeTableAttribute>(stream, opts, nameIndex, len);
+    case Type::RuntimeVisibleAnnotations:
+      return parseLazyAttribute<RuntimeVisibleAnnotationsAttribute>(stream, opts, nameIndex, len);
+    case Type::RuntimeInvisibleAnnotations:
+      return parseLazyAttribute<RuntimeInvisibleAnnotationsAttribute>(stream, opts, nameIndex, len);
+    case Type::RuntimeVisibleParameterAnnotations:
+      return parseLazyAttribute<RuntimeVisibleParameterAnnotationsAttribute>(stream, opts, nameIndex, len);
+    case Type::RuntimeInvisibleParameterAnnotations:
+      return parseLazyAttribute<RuntimeInvisibleParameterAnnotationsAttribute>(stream, opts, nameIndex, len);
+    case Type::RuntimeVisibleTypeAnnotations:
+      return parseLazyAttribute<RuntimeVisibleTypeAnnotationsAttribute>(stream, opts, nameIndex, len);
+    case Type::RuntimeInvisibleTypeAnnotations:
+      return parseLazyAttribute<RuntimeInvisibleTypeAnnotationsAttribute>(stream, opts, nameIndex, len);
+    case Type::AnnotationDefault:
+      return parseLazyAttribute<AnnotationDefaultAttribute>(stream, opts, nameIndex, len);
+    case Type::BootstrapMethods:
+      return parseLazyAttribute<BootstrapMethodsAttribute>(stream, opts, nameIndex, len);
+    case Type::MethodParameters:
+      return parseLazyAttribute<MethodParametersAttribute>(stream, opts, nameIndex, len);
+    case Type::Module:
+      return parseLazyAttribute<ModuleAttribute>(stream, opts, nameIndex, len);
+    case Type::ModulePackages:
+      return parseLazyAttribute<ModulePackagesAttribute>(stream, opts, nameIndex, len);
+    case Type::NestMembers:
+      return parseLazyAttribute<NestMembersAttribute>(stream, opts, nameIndex, len);
+    case Type::Record:
+    {
+      auto errOrAttr = parseLazyAttribute<RecordAttribute>(stream, opts, nameIndex, len);
+      VERIFY(errOrAttr);
+
+      //same for the attributes of the components
+      auto attr = errOrAttr.Release();
+      if(!opts.Filter.KeepsAll())
+        TRY(Parser::DecodeAttribute(*attr, constPool, opts.Filter));
+
+      return attr;
+    }
+    case Type::PermittedSubclasses:
+      return parseLazyAttribute<PermittedSubclassesAttribute>(stream, opts, nameIndex, len);
+
+    case Type::Raw:
+      break;
   }
 
-  //TODO: remove raws once everything is implemented, or WARN or something idk
-  RawAttribute* attr = new RawAttribute{};
+  std::unique_ptr<RawAttribute> attr{ makeNode<RawAttribute>(opts) };
   attr->NameIndex = nameIndex;
 
-  //TODO: add ReadArray<> to util
-  attr->Bytes.reserve(len);
-  for (unsigned i = 0; i < len; i++)
+  if constexpr (std::is_same_v<Stream, ByteReader>)
   {
-    U8 byte;
-    TRY(Read(stream, byte));
+    if(opts.BorrowBuffer)
+    {
+      auto errOrView = ReadView(stream, len);
+      VERIFY(errOrView);
 
-    attr->Bytes.emplace_back(byte);
+      attr->Borrow(errOrView.Get());
+      return std::unique_ptr<AttributeInfo>(std::move(attr));
+    }
   }
 
-  return std::unique_ptr<AttributeInfo>(attr);
+  attr->Bytes.resize(len);
+  TRY(ReadBytes(stream, attr->Bytes.data(), len));
+
+  return std::unique_ptr<AttributeInfo>(std::move(attr));
 }
 
-template <typename T>
-static ErrorOr<void> readOperand(std::istream& stream, Instruction& instr, size_t i)
+//nullptr if the attribute was filtered out
+template <typename Stream>
+static ErrorOr< std::unique_ptr<AttributeInfo> > parseAttribute(
+    Stream& stream, const ParseOptions& opts, const ConstantPool& constPool)
 {
-  auto errOrRef = instr.Operand<T>(i);
-  VERIFY(errOrRef, 
-      fmt::format("failed to access operand {} of \"{}\"", i, instr.GetMnemonic()));
+  size_t start = Tell(stream);
 
-  TRY(Read<BigEndian>(stream, errOrRef.Get().get()));
+  auto errOrAttr = parseAttributeNode(stream, opts, constPool);
+  VERIFY(errOrAttr);
 
-  return NoError{};
+  auto attr = errOrAttr.Release();
+  if(!attr)
+    return attr;
+
+  ByteView source = getSource(stream, opts, start);
+
+  //a Code attribute whose nested attributes were (partly) filtered out no
+  //longer matches its source
+  if(!opts.Filter.KeepsAll() && source.Data && 
+      source.Size != AttributeInfo::GetHeaderLength() + attr->GetLength())
+  {
+    source = {};
+  }
+
+  attr->SetSource(source);
+
+  return attr;
 }
 
-ErrorOr<Instruction> Parser::ParseInstruction(std::istream& stream)
+//Reads attributes_count and as many attributes, leaving out the ones 
+//rejected by ParseOptions::Filter. Returns whether all of them were kept.
+template <typename Stream>
+static ErrorOr<bool> parseAttributes(Stream& stream, const ParseOptions& opts, 
+    const ConstantPool& constPool, std::vector< std::unique_ptr<AttributeInfo> >& attrs)
+{
+  U16 count;
+  TRY(Read<BigEndian>(stream, count));
+
+  attrs.reserve(count);
+  for(auto i = 0; i < count; i++)
+  {
+    auto errOrAttr = parseAttribute(stream, opts, constPool);
+    VERIFY(errOrAttr);
+
+    if(auto attr = errOrAttr.Release())
+      attrs.emplace_back(std::move(attr));
+  }
+
+  return attrs.size() == count;
+}
+
+ErrorOr< std::unique_ptr<AttributeInfo> > Parser::ParseAttribute(
+    std::istream& stream, const ConstantPool& constPool)
+{
+  return parseAttribute(stream, ParseOptions{}, constPool);
+}
+
+ErrorOr<void> Parser::DecodeCode(CodeAttribute& attr, const ConstantPool& constPool, 
+    const AttributeFilter& filter)
 {
-  Instruction::Opcode op;
-  TRY(Read<BigEndian>(stream, (U8&)op));
+  if(attr.IsDecoded())
+    return {};
 
-  Instruction instr = Instruction::MakeInstruction(op).Get();
+  ByteView body = attr.GetUndecodedBody();
+  ByteReader reader{body.Data, body.Size};
 
-  if(instr.IsComplex())
+  //nested attributes may only keep borrowing if the body itself is borrowed,
+  //an owned body is released below
+  ParseOptions opts;
+  opts.BorrowBuffer = attr.BorrowsUndecodedBody();
+  opts.RetainSource = attr.HasSource();
+  opts.Filter = filter;
+
+  U32 undecodedLength = attr.GetLength();
+
+  auto err = readCodeBody(reader, opts, constPool, attr);
+
+  if(!err.IsError() && reader.Remaining() != 0)
   {
-    return Error{fmt::format("Parser::ParserInstruction(): "
-        "encountered complex instruction: \"{}\", "
-        "which parsing is not implemented for yet.", instr.GetMnemonic())};
+    err = Error{ErrorCode::TrailingBytes, reader.Tell(), reader.Remaining()};
   }
 
-  for(size_t i{0}; i < instr.GetNOperands(); i++)
+  if(err.IsError())
   {
-    switch( instr.GetOperandType(i) )
-    {
-      using Type = Instruction::OperandType;
-      case Type::TypeS32: TRY(readOperand<S32>(stream, instr, i)) break;
-      case Type::TypeS16: TRY(readOperand<S16>(stream, instr, i)) break;
-      case Type::TypeS8 : TRY(readOperand<S8 >(stream, instr, i)) break;
-      case Type::TypeU16: TRY(readOperand<U16>(stream, instr, i)) break;
-      case Type::TypeU8 : TRY(readOperand<U8 >(stream, instr, i)) break;
-    }
+    attr.Code.clear();
+    attr.Switches.clear();
+    attr.ExceptionTable.clear();
+    attr.Attributes.clear();
+
+    VERIFY(err);
   }
 
-  return instr;
+  attr.ClearUndecoded();
+
+  //some nested attributes were filtered out
+  if(!filter.KeepsAll() && attr.GetLength() != undecodedLength)
+    attr.MarkDirty();
+
+  return {};
+}
+
+//Lazy attributes are only ever decoded from their retained body in memory
+
+//A count prefixed table of structs made of U16 fields (or of U16 itself)
+template <typename CountT, typename T>
+static ErrorOr<void> readTable(ByteReader& reader, std::vector<T>& table)
+{
+  CountT count;
+  TRY(Read<BigEndian>(reader, count));
+
+  table.resize(count);
+  TRY((ReadArray<BigEndian, U16>(reader, table.data(), count)));
+
+  return {};
+}
+
+//Fails before allocating count elements if the remaining bytes can't hold 
+//them, counts of nested structures are otherwise free to allocate a lot 
+static ErrorOr<void> checkCount(const ByteReader& reader, size_t count, size_t minSize)
+{
+  if(count * minSize > reader.Remaining())
+  {
+    return Error{ErrorCode::BufferOverrun, reader.Tell(), count * minSize, reader.Remaining()};
+  }
+
+  return {};
+}
+
+static ErrorOr<void> decodeAttr(ByteReader& reader, const ParseOptions& opts,
+    const ConstantPool& constPool, IndexTableAttribute& attr)
+{
+  return readTable<U16>(reader, attr.Indices);
+}
+
+static ErrorOr<void> decodeAttr(ByteReader& reader, const ParseOptions& opts,
+    const ConstantPool& constPool, InnerClassesAttribute& attr)
+{
+  return readTable<U16>(reader, attr.Classes);
+}
+
+static ErrorOr<void> decodeAttr(ByteReader& reader, const ParseOptions& opts,
+    const ConstantPool& constPool, LineNumberTableAttribute& attr)
+{
+  return readTable<U16>(reader, attr.LineNumberTable);
+}
+
+static ErrorOr<void> decodeAttr(ByteReader& reader, const ParseOptions& opts,
+    const ConstantPool& constPool, LocalVariableTableAttribute& attr)
+{
+  return readTable<U16>(reader, attr.LocalVariableTable);
+}
+
+static ErrorOr<void> decodeAttr(ByteReader& reader, const ParseOptions& opts,
+    const ConstantPool& constPool, LocalVariableTypeTableAttribute& attr)
+{
+  return readTable<U16>(reader, attr.LocalVariableTypeTable);
+}
+
+static ErrorOr<void> decodeAttr(ByteReader& reader, const ParseOptions& opts,
+    const ConstantPool& constPool, MethodParametersAttribute& attr)
+{
+  return readTable<U8>(reader, attr.Parameters);
+}
+
+static ErrorOr<void> decodeAttr(ByteReader& reader, const ParseOptions& opts,
+    const ConstantPool& constPool, SourceDebugExtensionAttribute& attr)
+{
+  auto errOrView = ReadView(reader, reader.Remaining());
+  VERIFY(errOrView);
+
+  ByteView view = errOrView.Get();
+  attr.DebugExtension.assign(reinterpret_cast<const char*>(view.Data), view.Size);
+
+  return {};
+}
+
+static ErrorOr<void> readVerificationTypes(ByteReader& reader, 
+    std::vector<StackMapTableAttribute::VerificationType>& types, size_t count)
+{
+  using Item = StackMapTableAttribute::VerificationType::Item;
+
+  TRY(checkCount(reader, count, sizeof(U8)));
+  types.resize(count);
+
+  for(auto& type : types)
+  {
+    U8 tag;
+    TRY(Read<BigEndian>(reader, tag));
+
+    if(tag > static_cast<U8>(Item::Uninitialized))
+      return Error{ErrorCode::InvalidAttributeTag, reader.Tell() - sizeof(tag), tag};
+
+    type.Tag = static_cast<Item>(tag);
+
+    if(type.Tag == Item::Object || type.Tag == Item::Uninitialized)
+      TRY(Read<BigEndian>(reader, type.Data));
+  }
+
+  return {};
+}
+
+static ErrorOr<void> decodeAttr(ByteReader& reader, const ParseOptions& opts,
+    const ConstantPool& constPool, StackMapTableAttribute& attr)
+{
+  using Frame = StackMapTableAttribute::Frame;
+
+  U16 count;
+  TRY(Read<BigEndian>(reader, count));
+
+  TRY(checkCount(reader, count, sizeof(U8)));
+  attr.Entries.resize(count);
+
+  for(Frame& frame : attr.Entries)
+  {
+    TRY(Read<BigEndian>(reader, frame.FrameType));
+
+    if(Frame::IsReserved(frame.FrameType))
+      return Error{ErrorCode::InvalidAttributeTag, reader.Tell() - sizeof(U8), frame.FrameType};
+
+    U16 localsCount, stackCount;
+
+    switch(frame.GetKind())
+    {
+      case Frame::Kind::Same:
+        if(frame.FrameType < 64)
+          frame.OffsetDelta = frame.FrameType;
+        else
+          TRY(Read<BigEndian>(reader, frame.OffsetDelta));
+        break;
+
+      case Frame::Kind::SameLocals1StackItem:
+        if(frame.FrameType < 128)
+          frame.OffsetDelta = frame.FrameType - 64;
+        else
+          TRY(Read<BigEndian>(reader, frame.OffsetDelta));
+
+        TRY(readVerificationTypes(reader, frame.Stack, 1));
+        break;
+
+      case Frame::Kind::Chop:
+        TRY(Read<BigEndian>(reader, frame.OffsetDelta));
+        break;
+
+      case Frame::Kind::Append:
+        TRY(Read<BigEndian>(reader, frame.OffsetDelta));
+        TRY(readVerificationTypes(reader, frame.Locals, frame.FrameType - 251));
+        break;
+
+      case Frame::Kind::Full:
+        TRY(Read<BigEndian>(reader, frame.OffsetDelta, localsCount));
+        TRY(readVerificationTypes(reader, frame.Locals, localsCount));
+
+        TRY(Read<BigEndian>(reader, stackCount));
+        TRY(readVerificationTypes(reader, frame.Stack, stackCount));
+        break;
+    }
+  }
+
+  return {};
+}
+
+static ErrorOr<void> decodeAttr(ByteReader& reader, const ParseOptions& opts,
+    const ConstantPool& constPool, BootstrapMethodsAttribute& attr)
+{
+  U16 count;
+  TRY(Read<BigEndian>(reader, count));
+
+  //bootstrap_method_ref, num_bootstrap_arguments
+  TRY(checkCount(reader, count, sizeof(U16) * 2));
+  attr.BootstrapMethods.resize(count);
+
+  for(auto& method : attr.BootstrapMethods)
+  {
+    TRY(Read<BigEndian>(reader, method.BootstrapMethodRef));
+    TRY(readTable<U16>(reader, method.BootstrapArguments));
+  }
+
+  return {};
+}
+
+//exports & opens
+static ErrorOr<void> readModulePackages(ByteReader& reader, 
+    std::vector<ModuleAttribute::Package>& packages)
+{
+  U16 count;
+  TRY(Read<BigEndian>(reader, count));
+
+  //index, flags, to_count
+  TRY(checkCount(reader, count, sizeof(U16) * 3));
+  packages.resize(count);
+
+  for(auto& package : packages)
+  {
+    TRY(Read<BigEndian>(reader, package.Index, package.Flags));
+    TRY(readTable<U16>(reader, package.ToIndices));
+  }
+
+  return {};
+}
+
+static ErrorOr<void> decodeAttr(ByteReader& reader, const ParseOptions& opts,
+    const ConstantPool& constPool, ModuleAttribute& attr)
+{
+  TRY(Read<BigEndian>(reader, attr.ModuleNameIndex, attr.ModuleFlags, attr.ModuleVersionIndex));
+
+  TRY(readTable<U16>(reader, attr.Requires));
+  TRY(readModulePackages(reader, attr.Exports));
+  TRY(readModulePackages(reader, attr.Opens));
+  TRY(readTable<U16>(reader, attr.Uses));
+
+  U16 providesCount;
+  TRY(Read<BigEndian>(reader, providesCount));
+
+  //provides_index, provides_with_count
+  TRY(checkCount(reader, providesCount, sizeof(U16) * 2));
+  attr.Provides.resize(providesCount);
+
+  for(auto& provide : attr.Provides)
+  {
+    TRY(Read<BigEndian>(reader, provide.ProvidesIndex));
+    TRY(readTable<U16>(reader, provide.ProvidesWithIndices));
+  }
+
+  return {};
+}
+
+static ErrorOr<void> decodeAttr(ByteReader& reader, const ParseOptions& opts,
+    const ConstantPool& constPool, RecordAttribute& attr)
+{
+  U16 count;
+  TRY(Read<BigEndian>(reader, count));
+
+  //name_index, descriptor_index, attributes_count
+  TRY(checkCount(reader, count, sizeof(U16) * 3));
+  attr.Components.resize(count);
+
+  for(auto& component : attr.Components)
+  {
+    TRY(Read<BigEndian>(reader, component.NameIndex, component.DescriptorIndex));
+    TRY(parseAttributes(reader, opts, constPool, component.Attributes));
+  }
+
+  return {};
+}
+
+//Element values can nest annotations & arrays, deeper nesting than this is 
+//rejected instead of risking the stack
+static constexpr size_t maxElementValueDepth = 256;
+
+static ErrorOr<void> readElementValue(ByteReader&, ElementValue&, size_t depth);
+
+static ErrorOr<void> readAnnotation(ByteReader& reader, Annotation& annotation, size_t depth)
+{
+  U16 count;
+  TRY(Read<BigEndian>(reader, annotation.TypeIndex, count));
+
+  //element_name_index, tag, const_value_index
+  TRY(checkCount(reader, count, sizeof(U16) * 2 + sizeof(U8)));
+  annotation.ElementValuePairs.resize(count);
+
+  for(auto& pair : annotation.ElementValuePairs)
+  {
+    TRY(Read<BigEndian>(reader, pair.ElementNameIndex));
+    TRY(readElementValue(reader, pair.Value, depth));
+  }
+
+  return {};
+}
+
+static ErrorOr<void> readElementValue(ByteReader& reader, ElementValue& value, size_t depth)
+{
+  if(depth == maxElementValueDepth)
+    return Error{ErrorCode::NestingTooDeep, reader.Tell(), depth, maxElementValueDepth};
+
+  TRY(Read<BigEndian>(reader, value.Tag));
+
+  U16 count;
+
+  switch(value.Tag)
+  {
+    case 'B': case 'C': case 'D': case 'F': case 'I': case 'J': case 'S': case 'Z': 
+    case 's': case 'c':
+      TRY(Read<BigEndian>(reader, value.Index));
+      return {};
+
+    case 'e':
+      TRY(Read<BigEndian>(reader, value.Index, value.ConstNameIndex));
+      return {};
+
+    case '@':
+      value.AnnotationValue = std::make_unique<Annotation>();
+      return readAnnotation(reader, *value.AnnotationValue, depth + 1);
+
+    case '[':
+      TRY(Read<BigEndian>(reader, count));
+
+      //tag, const_value_index
+      TRY(checkCount(reader, count, sizeof(U8) + sizeof(U16)));
+      value.ArrayValue.resize(count);
+
+      for(ElementValue& element : value.ArrayValue)
+        TRY(readElementValue(reader, element, depth + 1));
+
+      return {};
+  }
+
+  return Error{ErrorCode::InvalidAttributeTag, reader.Tell() - sizeof(U8), value.Tag};
+}
+
+static ErrorOr<void> readAnnotations(ByteReader& reader, std::vector<Annotation>& annotations)
+{
+  U16 count;
+  TRY(Read<BigEndian>(reader, count));
+
+  //type_index, num_element_value_pairs
+  TRY(checkCount(reader, count, sizeof(U16) * 2));
+  annotations.resize(count);
+
+  for(Annotation& annotation : annotations)
+    TRY(readAnnotation(reader, annotation, 0));
+
+  return {};
+}
+
+static ErrorOr<void> decodeAttr(ByteReader& reader, const ParseOptions& opts,
+    const ConstantPool& constPool, AnnotationsAttribute& attr)
+{
+  return readAnnotations(reader, attr.Annotations);
+}
+
+static ErrorOr<void> decodeAttr(ByteReader& reader, const ParseOptions& opts,
+    const ConstantPool& constPool, ParameterAnnotationsAttribute& attr)
+{
+  U8 count;
+  TRY(Read<BigEndian>(reader, count));
+
+  attr.ParameterAnnotations.resize(count);
+
+  for(auto& annotations : attr.ParameterAnnotations)
+    TRY(readAnnotations(reader, annotations));
+
+  return {};
+}
+
+static ErrorOr<void> readTypeAnnotation(ByteReader& reader, TypeAnnotation& annotation)
+{
+  using Kind = TypeAnnotation::TargetKind;
+
+  TRY(Read<BigEndian>(reader, annotation.TargetType));
+
+  auto errOrKind = TypeAnnotation::GetTargetKind(annotation.TargetType);
+  if(errOrKind.IsError())
+  {
+    return Error{ErrorCode::InvalidAttributeTag, reader.Tell() - sizeof(U8), annotation.TargetType};
+  }
+
+  U8 index{};
+
+  switch(errOrKind.Get())
+  {
+    case Kind::TypeParameter:
+    case Kind::FormalParameter:
+      TRY(Read<BigEndian>(reader, index));
+      annotation.TargetIndex = index;
+      break;
+
+    case Kind::Supertype:
+    case Kind::Throws:
+    case Kind::Catch:
+    case Kind::Offset:
+      TRY(Read<BigEndian>(reader, annotation.TargetIndex));
+      break;
+
+    case Kind::TypeParameterBound:
+      TRY(Read<BigEndian>(reader, index, annotation.TargetArgument));
+      annotation.TargetIndex = index;
+      break;
+
+    case Kind::TypeArgument:
+      TRY(Read<BigEndian>(reader, annotation.TargetIndex, annotation.TargetArgument));
+      break;
+
+    case Kind::LocalVar:
+      TRY(readTable<U16>(reader, annotation.LocalVarTable));
+      break;
+
+    case Kind::Empty:
+      break;
+  }
+
+  U8 pathLength;
+  TRY(Read<BigEndian>(reader, pathLength));
+
+  annotation.TargetPath.resize(pathLength);
+  TRY((ReadArray<BigEndian, U8>(reader, annotation.TargetPath.data(), pathLength)));
+
+  return readAnnotation(reader, annotation, 0);
+}
+
+static ErrorOr<void> decodeAttr(ByteReader& reader, const ParseOptions& opts,
+    const ConstantPool& constPool, TypeAnnotationsAttribute& attr)
+{
+  U16 count;
+  TRY(Read<BigEndian>(reader, count));
+
+  //target_type, path_length, type_index, num_element_value_pairs
+  TRY(checkCount(reader, count, sizeof(U8) * 2 + sizeof(U16) * 2));
+  attr.Annotations.resize(count);
+
+  for(TypeAnnotation& annotation : attr.Annotations)
+    TRY(readTypeAnnotation(reader, annotation));
+
+  return {};
+}
+
+static ErrorOr<void> decodeAttr(ByteReader& reader, const ParseOptions& opts,
+    const ConstantPool& constPool, AnnotationDefaultAttribute& attr)
+{
+  return readElementValue(reader, attr.DefaultValue, 0);
+}
+
+template <typename AttributeT>
+static ErrorOr<void> decodeAttributeT(AttributeInfo& info, const ConstantPool& constPool, 
+    const AttributeFilter& filter)
+{
+  auto& attr = static_cast<AttributeT&>(info);
+
+  if(attr.IsDecoded())
+    return {};
+
+  ByteView body = attr.GetUndecodedBody();
+  ByteReader reader{body.Data, body.Size};
+
+  //same as Parser::DecodeCode() for the nested attributes of a Record
+  ParseOptions opts;
+  opts.BorrowBuffer = attr.BorrowsUndecodedBody();
+  opts.RetainSource = attr.HasSource();
+  opts.Filter = filter;
+
+  //decoded into a fresh attribute, so a failure leaves attr undecoded
+  AttributeT decoded;
+  TRY(decodeAttr(reader, opts, constPool, decoded), AttributeInfo::GetTypeName(info.GetType()));
+
+  if(reader.Remaining() != 0)
+  {
+    return Error{ErrorCode::TrailingBytes, reader.Tell(), reader.Remaining()};
+  }
+
+  decoded.NameIndex = attr.NameIndex;
+  decoded.SetSource(attr.GetSource());
+
+  //a Record's nested attributes may have been filtered out
+  if(!filter.KeepsAll() && decoded.GetLength() != attr.GetLength())
+    decoded.MarkDirty();
+
+  //also drops the retained body
+  attr = std::move(decoded);
+  return {};
+}
+
+ErrorOr<void> Parser::DecodeAttribute(AttributeInfo& attr, const ConstantPool& constPool, 
+    const AttributeFilter& filter)
+{
+  switch(attr.GetType())
+  {
+    using Type = AttributeInfo::Type;
+
+    case Type::Code:
+      return DecodeCode(static_cast<CodeAttribute&>(attr), constPool, filter);
+
+    case Type::StackMapTable:
+      return decodeAttributeT<StackMapTableAttribute>(attr, constPool, filter);
+    case Type::Exceptions:
+      return decodeAttributeT<ExceptionsAttribute>(attr, constPool, filter);
+    case Type::InnerClasses:
+      return decodeAttributeT<InnerClassesAttribute>(attr, constPool, filter);
+    case Type::SourceDebugExtension:
+      return decodeAttributeT<SourceDebugExtensionAttribute>(attr, constPool, filter);
+    case Type::LineNumberTable:
+      return decodeAttributeT<LineNumberTableAttribute>(attr, constPool, filter);
+    case Type::LocalVariableTable:
+      return decodeAttributeT<LocalVariableTableAttribute>(attr, constPool, filter);
+    case Type::LocalVariableTypeTable:
+      return decodeAttributeT<LocalVariableTypeTableAttribute>(attr, constPool, filter);
+    case Type::RuntimeVisibleAnnotations:
+      return decodeAttributeT<RuntimeVisibleAnnotationsAttribute>(attr, constPool, filter);
+    case Type::RuntimeInvisibleAnnotations:
+      return decodeAttributeT<RuntimeInvisibleAnnotationsAttribute>(attr, constPool, filter);
+    case Type::RuntimeVisibleParameterAnnotations:
+      return decodeAttributeT<RuntimeVisibleParameterAnnotationsAttribute>(attr, constPool, filter);
+    case Type::RuntimeInvisibleParameterAnnotations:
+      return decodeAttributeT<RuntimeInvisibleParameterAnnotationsAttribute>(attr, constPool, filter);
+    case Type::RuntimeVisibleTypeAnnotations:
+      return decodeAttributeT<RuntimeVisibleTypeAnnotationsAttribute>(attr, constPool, filter);
+    case Type::RuntimeInvisibleTypeAnnotations:
+      return decodeAttributeT<RuntimeInvisibleTypeAnnotationsAttribute>(attr, constPool, filter);
+    case Type::AnnotationDefault:
+      return decodeAttributeT<AnnotationDefaultAttribute>(attr, constPool, filter);
+    case Type::BootstrapMethods:
+      return decodeAttributeT<BootstrapMethodsAttribute>(attr, constPool, filter);
+    case Type::MethodParameters:
+      return decodeAttributeT<MethodParametersAttribute>(attr, constPool, filter);
+    case Type::Module:
+      return decodeAttributeT<ModuleAttribute>(attr, constPool, filter);
+    case Type::ModulePackages:
+      return decodeAttributeT<ModulePackagesAttribute>(attr, constPool, filter);
+    case Type::NestMembers:
+      return decodeAttributeT<NestMembersAttribute>(attr, constPool, filter);
+    case Type::Record:
+      return decodeAttributeT<RecordAttribute>(attr, constPool, filter);
+    case Type::PermittedSubclasses:
+      return decodeAttributeT<PermittedSubclassesAttribute>(attr, constPool, filter);
+
+    //decoded while parsing
+    default:
+      return {};
+  }
+}
+
+template <typename T, typename Stream>
+static ErrorOr<void> readOperand(Stream& stream, Instruction& instr, size_t i)
+{
+  //the context holds the operand index
+  auto errOrRef = instr.Operand<T>(i);
+  if(errOrRef.IsError())
+    errOrRef.GetError().Offset = Tell(stream);
+
+  VERIFY(errOrRef, "failed to access operand");
+
+  TRY(Read<BigEndian>(stream, errOrRef.Get().get()));
+
+  return NoError{};
+}
+
+//Reads a single instruction without knowing its offset, which switches need
+//for their padding
+static ErrorOr<Instruction> parseInstruction(std::istream& stream)
+{
+  U8 byte;
+  TRY(Read<BigEndian>(stream, byte));
+
+  auto errOrInstr = Instruction::MakeInstruction(static_cast<Instruction::Opcode>(byte));
+  VERIFY(errOrInstr);
+
+  Instruction instr = errOrInstr.Get();
+
+  if(instr.IsSwitch())
+  {
+    return Error{ErrorCode::ComplexInstruction, Tell(stream) - 1, byte};
+  }
+
+  if(instr.Op == Instruction::Opcode::WIDE)
+  {
+    U8 widened;
+    TRY(Read<BigEndian>(stream, widened));
+
+    auto errOrWide = Instruction::MakeWide(static_cast<Instruction::Opcode>(widened));
+    VERIFY(errOrWide);
+
+    instr = errOrWide.Get();
+  }
+
+  for(size_t i{0}; i < instr.GetNOperands(); i++)
+  {
+    switch( instr.GetOperandType(i) )
+    {
+      using Type = Instruction::OperandType;
+      case Type::TypeS32: TRY(readOperand<S32>(stream, instr, i)) break;
+      case Type::TypeS16: TRY(readOperand<S16>(stream, instr, i)) break;
+      case Type::TypeS8 : TRY(readOperand<S8 >(stream, instr, i)) break;
+      case Type::TypeU16: TRY(readOperand<U16>(stream, instr, i)) break;
+      case Type::TypeU8 : TRY(readOperand<U8 >(stream, instr, i)) break;
+    }
+  }
+
+  return instr;
+}
+
+ErrorOr<Instruction> Parser::ParseInstruction(std::istream& stream)
+{
+  return parseInstruction(stream);
+}
+
+//State of a Parser::Visit() walk
+struct VisitState
+{
+  ClassVisitor& Visitor;
+  ParseOptions Opts;
+
+  //indexed by constant pool index
+  std::vector<std::string_view> Strings;
+  std::vector<U16> ClassNames;
+
+  //scratch for the table of the switch being visited
+  std::vector<SwitchTable> Switches;
+
+  bool Stopped{false};
+
+  //Records the action returned by a callback, true if the walk should 
+  //descend into what was visited
+  bool Descend(ClassVisitor::Action action)
+  {
+    Stopped = action == ClassVisitor::Action::Stop;
+    return action == ClassVisitor::Action::Continue;
+  }
+
+  std::string_view GetString(U16 index) const
+  {
+    return index < Strings.size() ? Strings[index] : std::string_view{};
+  }
+
+  std::string_view GetClassName(U16 index) const
+  {
+    return index < ClassNames.size() ? this->GetString(ClassNames[index]) : std::string_view{};
+  }
+};
+
+template <typename CPInfoT>
+static ErrorOr<void> visitConstT(ByteReader& reader, VisitState& state, U16 index)
+{
+  CPInfoT info;
+  TRY(readConst(reader, state.Opts, info));
+
+  if constexpr (std::is_same_v<CPInfoT, UTF8Info>)
+    state.Strings[index] = info.GetString();
+
+  if constexpr (std::is_same_v<CPInfoT, ClassInfo>)
+    state.ClassNames[index] = info.NameIndex;
+
+  state.Descend(state.Visitor.VisitConstant(index, info));
+  return {};
+}
+
+static ErrorOr<void> visitConstantPool(ByteReader& reader, VisitState& state)
+{
+  U16 count;
+  TRY(Read<BigEndian>(reader, count));
+
+  state.Strings.resize(count);
+  state.ClassNames.resize(count);
+
+  for(U16 i = 1; i < count && !state.Stopped; i++)
+  {
+    U8 tag;
+    TRY(Read<BigEndian>(reader, tag));
+
+    switch(static_cast<CPInfo::Type>(tag))
+    {
+      case CPInfo::Type::Class:       TRY(visitConstT<ClassInfo>(reader, state, i)); break;
+      case CPInfo::Type::Fieldref:    TRY(visitConstT<FieldrefInfo>(reader, state, i)); break;
+      case CPInfo::Type::Methodref:   TRY(visitConstT<MethodrefInfo>(reader, state, i)); break;
+      case CPInfo::Type::InterfaceMethodref: TRY(visitConstT<InterfaceMethodrefInfo>(reader, state, i)); break;
+      case CPInfo::Type::String:      TRY(visitConstT<StringInfo>(reader, state, i)); break;
+      case CPInfo::Type::Integer:     TRY(visitConstT<IntegerInfo>(reader, state, i)); break;
+      case CPInfo::Type::Float:       TRY(visitConstT<FloatInfo>(reader, state, i)); break;
+      case CPInfo::Type::Long:        TRY(visitConstT<LongInfo>(reader, state, i)); break;
+      case CPInfo::Type::Double:      TRY(visitConstT<DoubleInfo>(reader, state, i)); break;
+      case CPInfo::Type::NameAndType: TRY(visitConstT<NameAndTypeInfo>(reader, state, i)); break;
+      case CPInfo::Type::UTF8:        TRY(visitConstT<UTF8Info>(reader, state, i)); break;
+      case CPInfo::Type::MethodHandle:  TRY(visitConstT<MethodHandleInfo>(reader, state, i)); break;
+      case CPInfo::Type::MethodType:    TRY(visitConstT<MethodTypeInfo>(reader, state, i)); break;
+      case CPInfo::Type::InvokeDynamic: TRY(visitConstT<InvokeDynamicInfo>(reader, state, i)); break;
+
+      default:
+        return Error{ErrorCode::UnknownConstantTag, reader.Tell() - sizeof(tag), tag};
+    }
+
+    //Long & Double take up the next slot as well, which has to exist (i
+    //would wrap around otherwise)
+    auto type = static_cast<CPInfo::Type>(tag);
+    if(type == CPInfo::Type::Long || type == CPInfo::Type::Double)
+    {
+      if(i + 1 >= count)
+        return Error{ErrorCode::InvalidConstantIndex, reader.Tell(), i + 1u, count};
+
+      i++;
+    }
+  }
+
+  return {};
+}
+
+static ErrorOr<void> skipAttributes(ByteReader& reader)
+{
+  U16 count;
+  TRY(Read<BigEndian>(reader, count));
+
+  for(U16 i = 0; i < count; i++)
+  {
+    U16 nameIndex;
+    U32 len;
+    TRY(Read<BigEndian>(reader, nameIndex, len));
+    TRY(ReadView(reader, len));
+  }
+
+  return {};
+}
+
+static ErrorOr<void> visitAttributes(ByteReader&, VisitState&, ClassVisitor::Owner);
+
+static ErrorOr<void> visitCode(ByteReader& reader, VisitState& state)
+{
+  U16 maxStack{}, maxLocals{};
+  U32 codeLen{};
+  TRY(Read<BigEndian>(reader, maxStack, maxLocals, codeLen));
+
+  auto errOrCode = ReadView(reader, codeLen);
+  VERIFY(errOrCode, "failed to read code array");
+
+  ByteView code = errOrCode.Get();
+
+  if(state.Descend(state.Visitor.VisitCode(maxStack, maxLocals, code)))
+  {
+    size_t offset{0};
+
+    while(offset < code.Size)
+    {
+      size_t length;
+      state.Switches.clear();
+
+      auto errOrInstr = Instruction::Decode(code.Data, code.Size, offset, state.Switches, length);
+      VERIFY(errOrInstr, "failed to decode instruction");
+
+      const Instruction& instr = errOrInstr.Get();
+
+      if(!state.Descend(state.Visitor.VisitInstruction(static_cast<U32>(offset), instr)))
+        break;
+
+      if(instr.IsSwitch() && 
+          !state.Descend(state.Visitor.VisitSwitch(static_cast<U32>(offset), instr, state.Switches.back())))
+        break;
+
+      offset += length;
+    }
+  }
+
+  if(state.Stopped)
+    return {};
+
+  U16 exceptionTableLen;
+  TRY(Read<BigEndian>(reader, exceptionTableLen));
+
+  for(U16 i = 0; i < exceptionTableLen; i++)
+  {
+    CodeAttribute::ExceptionHandler handler;
+    TRY(Read<BigEndian>(reader, handler.StartPC, 
+                                handler.EndPC, 
+                                handler.HandlerPC, 
+                                handler.CatchType));
+
+    state.Descend(state.Visitor.VisitExceptionHandler(handler));
+
+    if(state.Stopped)
+      return {};
+  }
+
+  return visitAttributes(reader, state, ClassVisitor::Owner::Code);
+}
+
+static ErrorOr<void> visitAttributes(ByteReader& reader, VisitState& state, ClassVisitor::Owner owner)
+{
+  U16 count;
+  TRY(Read<BigEndian>(reader, count));
+
+  for(U16 i = 0; i < count && !state.Stopped; i++)
+  {
+    U16 nameIndex;
+    U32 len;
+    TRY(Read<BigEndian>(reader, nameIndex, len));
+
+    auto errOrBody = ReadView(reader, len);
+    VERIFY(errOrBody, "failed to read attribute");
+
+    ByteView body = errOrBody.Get();
+    std::string_view name = state.GetString(nameIndex);
+
+    if(!state.Descend(state.Visitor.VisitAttribute(owner, name, body)))
+      continue;
+
+    if(name != "Code")
+      continue;
+
+    ByteReader bodyReader{body.Data, body.Size};
+    TRY(visitCode(bodyReader, state));
+
+    if(!state.Stopped && bodyReader.Remaining() != 0)
+    {
+      return Error{ErrorCode::TrailingBytes, bodyReader.Tell(), bodyReader.Remaining()};
+    }
+  }
+
+  return {};
+}
+
+static ErrorOr<void> visitFieldsMethods(ByteReader& reader, VisitState& state, bool methods)
+{
+  U16 count;
+  TRY(Read<BigEndian>(reader, count));
+
+  for(U16 i = 0; i < count && !state.Stopped; i++)
+  {
+    U16 accessFlags, nameIndex, descriptorIndex;
+    TRY(Read<BigEndian>(reader, accessFlags, nameIndex, descriptorIndex));
+
+    std::string_view name = state.GetString(nameIndex);
+    std::string_view descriptor = state.GetString(descriptorIndex);
+
+    auto action = methods 
+      ? state.Visitor.VisitMethod(accessFlags, name, descriptor)
+      : state.Visitor.VisitField(accessFlags, name, descriptor);
+
+    if(state.Descend(action))
+    {
+      TRY(visitAttributes(reader, state, methods ? ClassVisitor::Owner::Method : ClassVisitor::Owner::Field));
+    }
+    else if(!state.Stopped)
+    {
+      TRY(skipAttributes(reader));
+    }
+  }
+
+  return {};
+}
+
+ErrorOr<void> Parser::Visit(const U8* data, size_t size, ClassVisitor& visitor)
+{
+  ByteReader reader{data, size};
+
+  VisitState state{visitor, ParseOptions{}};
+
+  U32 magic{};
+  U16 minorVersion{}, majorVersion{};
+  TRY(Read<BigEndian>(reader, magic, minorVersion, majorVersion));
+
+  state.Descend(visitor.VisitHeader(magic, minorVersion, majorVersion));
+  if(state.Stopped)
+    return {};
+
+  TRY(visitConstantPool(reader, state));
+  if(state.Stopped)
+    return {};
+
+  U16 accessFlags, thisClass, superClass, interfacesCount;
+  TRY(Read<BigEndian>(reader, accessFlags, thisClass, superClass, interfacesCount));
+
+  state.Descend(visitor.VisitClass(accessFlags, state.GetClassName(thisClass), 
+        state.GetClassName(superClass)));
+
+  for(U16 i = 0; i < interfacesCount && !state.Stopped; i++)
+  {
+    U16 interfaceIndex;
+    TRY(Read<BigEndian>(reader, interfaceIndex));
+
+    state.Descend(visitor.VisitInterface(state.GetClassName(interfaceIndex)));
+  }
+
+  if(state.Stopped)
+    return {};
+
+  TRY(visitFieldsMethods(reader, state, false));
+  if(state.Stopped)
+    return {};
+
+  TRY(visitFieldsMethods(reader, state, true));
+  if(state.Stopped)
+    return {};
+
+  TRY(visitAttributes(reader, state, ClassVisitor::Owner::Class));
+  if(state.Stopped)
+    return {};
+
+  visitor.VisitEnd();
+  return {};
 }
 
 } //namespace ClassFile
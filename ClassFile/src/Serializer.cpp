@@ -3,16 +3,242 @@
 #include "Util/IO.hpp"
 #include "Util/Error.hpp"
 
+#include <algorithm>
+#include <array>
+#include <cassert>
+
 namespace ClassFile
 {
 
-ErrorOr<void> Serializer::SerializeClassFile(std::ostream& stream, const ClassFile& cf)
+static ErrorOr<size_t> getConstantSize(const CPInfo& info)
+{
+  constexpr size_t tagSize = sizeof(U8);
+
+  switch(info.GetType())
+  {
+    case CPInfo::Type::Class:              return tagSize + 2;
+    case CPInfo::Type::Fieldref:           return tagSize + 4;
+    case CPInfo::Type::Methodref:          return tagSize + 4;
+    case CPInfo::Type::InterfaceMethodref: return tagSize + 4;
+    case CPInfo::Type::String:             return tagSize + 2;
+    case CPInfo::Type::Integer:            return tagSize + 4;
+    case CPInfo::Type::Float:              return tagSize + 4;
+    case CPInfo::Type::Long:               return tagSize + 8;
+    case CPInfo::Type::Double:             return tagSize + 8;
+    case CPInfo::Type::NameAndType:        return tagSize + 4;
+    case CPInfo::Type::MethodHandle:       return tagSize + 3;
+    case CPInfo::Type::MethodType:         return tagSize + 2;
+    case CPInfo::Type::InvokeDynamic:      return tagSize + 4;
+
+    case CPInfo::Type::UTF8:
+      return tagSize + sizeof(U16) + static_cast<const UTF8Info&>(info).GetString().length();
+  }
+
+  return Error{ErrorCode::UnknownConstantTag, Error::NoOffset, static_cast<U8>(info.GetType())};
+}
+
+//Whether an attribute can be copied verbatim from the bytes it was parsed
+//from (see ParseOptions::RetainSource), nested attributes of a decoded 
+//Code or Record attribute have to be clean as well
+static bool isClean(const AttributeInfo& info)
+{
+  if(!info.HasSource())
+    return false;
+
+  auto allClean = [](const std::vector< std::unique_ptr<AttributeInfo> >& attrs)
+  {
+    return std::all_of(attrs.begin(), attrs.end(), 
+        [](const auto& pAttr) { return isClean(*pAttr); });
+  };
+
+  if(info.GetType() == AttributeInfo::Type::Code)
+  {
+    const auto& code = static_cast<const CodeAttribute&>(info);
+    return !code.IsDecoded() || allClean(code.Attributes);
+  }
+
+  if(info.GetType() == AttributeInfo::Type::Record)
+  {
+    const auto& record = static_cast<const RecordAttribute&>(info);
+
+    return !record.IsDecoded() || std::all_of(record.Components.begin(), record.Components.end(), 
+        [&](const auto& component) { return allClean(component.Attributes); });
+  }
+
+  return true;
+}
+
+static bool isClean(const FieldMethodInfo& info)
+{
+  if(!info.HasSource())
+    return false;
+
+  return std::all_of(info.Attributes.begin(), info.Attributes.end(), 
+      [](const auto& pAttr) { return isClean(*pAttr); });
+}
+
+//Attribute lengths in the order the writer visits attributes (preorder), 
+//computed once by sizeAttribute(). A decoded CodeAttribute takes a second 
+//slot right after its own for its code_length. This way attribute_length is 
+//written without calling GetLength(), which for a CodeAttribute (or a 
+//RecordAttribute) walks all of its nested attributes again at every nesting
+//level.
+struct AttributeSizes
+{
+  std::vector<U32> Lengths;
+  size_t Next{0};
+
+  U32 Take() { return Lengths[Next++]; }
+};
+
+static size_t sizeAttributes(const std::vector< std::unique_ptr<AttributeInfo> >&, AttributeSizes&);
+
+static U32 sizeAttribute(const AttributeInfo& info, AttributeSizes& sizes)
+{
+  size_t slot = sizes.Lengths.size();
+  sizes.Lengths.push_back(0);
+
+  //copied as is, nested attributes aren't visited by the writer
+  if(isClean(info))
+  {
+    sizes.Lengths[slot] = static_cast<U32>(info.GetSource().Size - AttributeInfo::GetHeaderLength());
+    return sizes.Lengths[slot];
+  }
+
+  const auto* record = info.GetType() == AttributeInfo::Type::Record 
+    ? static_cast<const RecordAttribute*>(&info) : nullptr;
+
+  if(record != nullptr && record->IsDecoded())
+  {
+    U32 len = sizeof(U16); //components_count
+
+    //name_index, descriptor_index, attributes_count
+    for(const auto& component : record->Components)
+    {
+      len += sizeof(U16) * 2;
+      len += static_cast<U32>(sizeAttributes(component.Attributes, sizes));
+    }
+
+    sizes.Lengths[slot] = len;
+    return len;
+  }
+
+  const auto* code = info.GetType() == AttributeInfo::Type::Code 
+    ? static_cast<const CodeAttribute*>(&info) : nullptr;
+
+  if(code == nullptr || !code->IsDecoded())
+  {
+    sizes.Lengths[slot] = info.GetLength();
+    return sizes.Lengths[slot];
+  }
+
+  size_t codeSlot = sizes.Lengths.size();
+  sizes.Lengths.push_back(0);
+
+  U32 codeLen = code->GetCodeLength();
+
+  U32 len{0};
+  len += sizeof(code->MaxStack);
+  len += sizeof(code->MaxLocals);
+  len += sizeof(U32) + codeLen; //code_length + code
+  len += sizeof(U16) + code->ExceptionTable.size() * sizeof(U16) * 4;
+  len += sizeof(U16); //attributes_count
+
+  for(const auto& pAttr : code->Attributes)
+    len += AttributeInfo::GetHeaderLength() + sizeAttribute(*pAttr, sizes);
+
+  sizes.Lengths[codeSlot] = codeLen;
+  sizes.Lengths[slot] = len;
+  return len;
+}
+
+static size_t sizeAttributes(const std::vector< std::unique_ptr<AttributeInfo> >& attrs, 
+    AttributeSizes& sizes)
+{
+  size_t size = sizeof(U16); //attributes_count
+
+  for(const auto& pAttr : attrs)
+    size += AttributeInfo::GetHeaderLength() + sizeAttribute(*pAttr, sizes);
+
+  return size;
+}
+
+static ErrorOr<size_t> sizeClassFile(const ClassFile& cf, AttributeSizes& sizes)
+{
+  size_t size{0};
+
+  size += sizeof(cf.Magic) + sizeof(cf.MinorVersion) + sizeof(cf.MajorVersion);
+
+  size += sizeof(U16); //constant_pool_count
+  for(auto i = 0; i < cf.ConstPool.GetCount(); i++)
+  {
+    const CPInfo* ptr = cf.ConstPool[i];
+
+    if(ptr == nullptr)
+      continue;
+
+    auto errOrSize = getConstantSize(*ptr);
+    VERIFY(errOrSize);
+
+    size += errOrSize.Get();
+  }
+
+  size += sizeof(cf.AccessFlags) + sizeof(cf.ThisClass) + sizeof(cf.SuperClass);
+
+  size += sizeof(U16) + cf.Interfaces.size() * sizeof(U16);
+
+  //access_flags, name_index, descriptor_index
+  constexpr size_t fieldMethodHeaderSize = 3 * sizeof(U16);
+
+  size += sizeof(U16); //fields_count
+  for(const auto& field : cf.Fields)
+  {
+    size += isClean(field) 
+      ? field.GetSource().Size 
+      : fieldMethodHeaderSize + sizeAttributes(field.Attributes, sizes);
+  }
+
+  size += sizeof(U16); //methods_count
+  for(const auto& method : cf.Methods)
+  {
+    size += isClean(method) 
+      ? method.GetSource().Size 
+      : fieldMethodHeaderSize + sizeAttributes(method.Attributes, sizes);
+  }
+
+  size += sizeAttributes(cf.Attributes, sizes);
+
+  return size;
+}
+
+ErrorOr<size_t> Serializer::GetSerializedSize(const ClassFile& cf)
+{
+  AttributeSizes sizes;
+  return sizeClassFile(cf, sizes);
+}
+
+//Serialization is implemented once over a generic Stream, which is either an
+//std::ostream or a ByteWriter over a buffer presized with GetSerializedSize()
+//(see Util/IO.hpp)
+template <typename Stream>
+static ErrorOr<void> serializeConstantPool(Stream&, const ConstantPool&);
+template <typename Stream>
+static ErrorOr<void> serializeConstant(Stream&, const CPInfo&);
+template <typename Stream>
+static ErrorOr<void> serializeFieldMethod(Stream&, const FieldMethodInfo&, AttributeSizes&);
+template <typename Stream>
+static ErrorOr<void> serializeAttribute(Stream&, const AttributeInfo&, AttributeSizes&);
+static ErrorOr<void> writeCode(ByteWriter&, const CodeAttribute&, U32 codeLen);
+static ErrorOr<void> writeCode(std::ostream&, const CodeAttribute&, U32 codeLen);
+
+template <typename Stream>
+static ErrorOr<void> serializeClassFile(Stream& stream, const ClassFile& cf, AttributeSizes& sizes)
 {
   TRY(Write<BigEndian>(stream, cf.Magic,
                                cf.MinorVersion,
                                cf.MajorVersion));
 
-  TRY( Serializer::SerializeConstantPool(stream, cf.ConstPool) );
+  TRY( serializeConstantPool(stream, cf.ConstPool) );
 
   TRY(Write<BigEndian>(stream, cf.AccessFlags,
                                cf.ThisClass,
@@ -20,28 +246,66 @@ ErrorOr<void> Serializer::SerializeClassFile(std::ostream& stream, const ClassFi
                                static_cast<U16>(cf.Interfaces.size())));
 
 
-  for(U16 interface : cf.Interfaces)
-    TRY(Write<BigEndian>(stream, interface));
+  TRY(WriteArray<BigEndian>(stream, cf.Interfaces.data(), cf.Interfaces.size()));
 
   TRY( Write<BigEndian>(stream, static_cast<U16>(cf.Fields.size())) );
 
   for(const auto& field : cf.Fields)
-    TRY( Serializer::SerializeFieldMethod(stream, field) );
+    TRY( serializeFieldMethod(stream, field, sizes) );
 
   TRY( Write<BigEndian>(stream, static_cast<U16>(cf.Methods.size())) );
 
   for(const auto& method: cf.Methods)
-    TRY( Serializer::SerializeFieldMethod(stream, method) );
+    TRY( serializeFieldMethod(stream, method, sizes) );
 
   TRY( Write<BigEndian>(stream, static_cast<U16>(cf.Attributes.size())) );
 
   for(const auto& pAttr: cf.Attributes)
-    TRY( Serializer::SerializeAttribute(stream, *pAttr) );
+    TRY( serializeAttribute(stream, *pAttr, sizes) );
 
   return {};
 }
 
-ErrorOr<void> Serializer::SerializeConstantPool(std::ostream& stream, const ConstantPool& cp)
+ErrorOr<void> Serializer::SerializeClassFile(std::ostream& stream, const ClassFile& cf)
+{
+  AttributeSizes sizes;
+  TRY( sizeClassFile(cf, sizes) );
+
+  return serializeClassFile(stream, cf, sizes);
+}
+
+ErrorOr<size_t> Serializer::SerializeClassFile(const ClassFile& cf, U8* buffer, size_t size)
+{
+  AttributeSizes sizes;
+  TRY( sizeClassFile(cf, sizes) );
+
+  ByteWriter writer{buffer, size};
+  TRY( serializeClassFile(writer, cf, sizes) );
+
+  return writer.Tell();
+}
+
+ErrorOr< std::vector<U8> > Serializer::SerializeClassFile(const ClassFile& cf)
+{
+  AttributeSizes sizes;
+  auto errOrSize = sizeClassFile(cf, sizes);
+  VERIFY(errOrSize);
+
+  std::vector<U8> bytes(errOrSize.Get());
+
+  ByteWriter writer{bytes.data(), bytes.size()};
+  TRY( serializeClassFile(writer, cf, sizes) );
+
+  if(writer.Tell() != bytes.size())
+  {
+    return Error{ErrorCode::LengthMismatch, writer.Tell(), bytes.size(), writer.Tell()};
+  }
+
+  return bytes;
+}
+
+template <typename Stream>
+static ErrorOr<void> serializeConstantPool(Stream& stream, const ConstantPool& cp)
 {
 
   TRY(Write<BigEndian>(stream, cp.GetCount()));
@@ -55,93 +319,113 @@ ErrorOr<void> Serializer::SerializeConstantPool(std::ostream& stream, const Cons
     if(ptr == nullptr)
       continue;
 
-    TRY(Serializer::SerializeConstant(stream, *ptr));
+    TRY(serializeConstant(stream, *ptr));
   }
 
   return {};
 }
 
-static ErrorOr<void> writeConst(std::ostream& stream, const InvokeDynamicInfo& info)
+ErrorOr<void> Serializer::SerializeConstantPool(std::ostream& stream, const ConstantPool& cp)
+{
+  return serializeConstantPool(stream, cp);
+}
+
+template <typename Stream>
+static ErrorOr<void> writeConst(Stream& stream, const InvokeDynamicInfo& info)
 {
   TRY(Write<BigEndian>(stream, info.BootstrapMethodAttrIndex,
                                info.NameAndTypeIndex));
   return {};
 }
 
-static ErrorOr<void> writeConst(std::ostream& stream, const MethodTypeInfo& info)
+template <typename Stream>
+static ErrorOr<void> writeConst(Stream& stream, const MethodTypeInfo& info)
 {
   TRY(Write<BigEndian>(stream, info.DescriptorIndex));
   return {};
 }
 
-static ErrorOr<void> writeConst(std::ostream& stream, const MethodHandleInfo& info)
+template <typename Stream>
+static ErrorOr<void> writeConst(Stream& stream, const MethodHandleInfo& info)
 {
   TRY(Write<BigEndian>(stream, info.ReferenceKind,
                                info.ReferenceIndex));
   return {};
 }
 
-static ErrorOr<void> writeConst(std::ostream& stream, const UTF8Info& info)
+template <typename Stream>
+static ErrorOr<void> writeConst(Stream& stream, const UTF8Info& info)
 {
-  TRY(Write<BigEndian>(stream, static_cast<U16>( info.String.length() )));
-  stream << info.String;
+  std::string_view str = info.GetString();
+
+  TRY(Write<BigEndian>(stream, static_cast<U16>( str.length() )));
+  TRY(WriteBytes(stream, str.data(), str.length()));
   return {};
 }
 
-static ErrorOr<void> writeConst(std::ostream& stream, const NameAndTypeInfo& info)
+template <typename Stream>
+static ErrorOr<void> writeConst(Stream& stream, const NameAndTypeInfo& info)
 {
   TRY(Write<BigEndian>(stream, info.NameIndex,
                                info.DescriptorIndex));
   return {};
 }
 
-static ErrorOr<void> writeConst(std::ostream& stream, const DoubleInfo& info)
+template <typename Stream>
+static ErrorOr<void> writeConst(Stream& stream, const DoubleInfo& info)
 {
   TRY(Write<BigEndian>(stream, info.HighBytes,
                                info.LowBytes));
   return {};
 }
 
-static ErrorOr<void> writeConst(std::ostream& stream, const LongInfo& info)
+template <typename Stream>
+static ErrorOr<void> writeConst(Stream& stream, const LongInfo& info)
 {
   TRY(Write<BigEndian>(stream, info.HighBytes,
                                info.LowBytes));
   return {};
 }
 
-static ErrorOr<void> writeConst(std::ostream& stream, const FloatInfo& info)
+template <typename Stream>
+static ErrorOr<void> writeConst(Stream& stream, const FloatInfo& info)
 {
   TRY(Write<BigEndian>(stream, info.Bytes));
   return {};
 }
 
-static ErrorOr<void> writeConst(std::ostream& stream, const IntegerInfo& info)
+template <typename Stream>
+static ErrorOr<void> writeConst(Stream& stream, const IntegerInfo& info)
 {
   TRY(Write<BigEndian>(stream, info.Bytes));
   return {};
 }
 
-static ErrorOr<void> writeConst(std::ostream& stream, const StringInfo& info)
+template <typename Stream>
+static ErrorOr<void> writeConst(Stream& stream, const StringInfo& info)
 {
   TRY(Write<BigEndian>(stream, info.StringIndex));
   return {};
 }
 
-static ErrorOr<void> writeConst(std::ostream& stream, const InterfaceMethodrefInfo& info)
+template <typename Stream>
+static ErrorOr<void> writeConst(Stream& stream, const InterfaceMethodrefInfo& info)
 {
   TRY(Write<BigEndian>(stream, info.ClassIndex, 
                                info.NameAndTypeIndex));
   return {};
 }
 
-static ErrorOr<void> writeConst(std::ostream& stream, const MethodrefInfo& info)
+template <typename Stream>
+static ErrorOr<void> writeConst(Stream& stream, const MethodrefInfo& info)
 {
   TRY(Write<BigEndian>(stream, info.ClassIndex, 
                                info.NameAndTypeIndex));
   return {};
 }
 
-static ErrorOr<void> writeConst(std::ostream& stream, const FieldrefInfo& info)
+template <typename Stream>
+static ErrorOr<void> writeConst(Stream& stream, const FieldrefInfo& info)
 {
   TRY(Write<BigEndian>(stream, info.ClassIndex, 
                                info.NameAndTypeIndex));
@@ -149,19 +433,21 @@ static ErrorOr<void> writeConst(std::ostream& stream, const FieldrefInfo& info)
 }
 
 
-static ErrorOr<void> writeConst(std::ostream& stream, const ClassInfo& info)
+template <typename Stream>
+static ErrorOr<void> writeConst(Stream& stream, const ClassInfo& info)
 {
   TRY(Write<BigEndian>(stream, info.NameIndex));
   return {};
 }
 
-template <typename T>
-static ErrorOr<void> writeConstT(std::ostream& stream, const CPInfo& info)
+template <typename T, typename Stream>
+static ErrorOr<void> writeConstT(Stream& stream, const CPInfo& info)
 {
   return writeConst(stream, static_cast<const T&>(info));
 }
 
-ErrorOr<void> Serializer::SerializeConstant(std::ostream& stream, const CPInfo& info)
+template <typename Stream>
+static ErrorOr<void> serializeConstant(Stream& stream, const CPInfo& info)
 {
   U8 tag = static_cast<U8>(info.GetType());
   TRY(Write<BigEndian>(stream, tag));
@@ -184,136 +470,628 @@ ErrorOr<void> Serializer::SerializeConstant(std::ostream& stream, const CPInfo&
     case CPInfo::Type::InvokeDynamic: return writeConstT<InvokeDynamicInfo>(stream, info);
   }
 
-  return Error{ fmt::format("Serializer::WriteConstant(): encountered unknown tag {}", tag) };
+  return Error{ErrorCode::UnknownConstantTag, Tell(stream), tag};
 }
 
-ErrorOr<void> Serializer::SerializeFieldMethod(std::ostream& stream, const FieldMethodInfo& info)
+ErrorOr<void> Serializer::SerializeConstant(std::ostream& stream, const CPInfo& info)
 {
+  return serializeConstant(stream, info);
+}
+
+template <typename Stream>
+static ErrorOr<void> serializeFieldMethod(Stream& stream, const FieldMethodInfo& info, 
+    AttributeSizes& sizes)
+{
+  if(isClean(info))
+  {
+    ByteView source = info.GetSource();
+    return WriteBytes(stream, source.Data, source.Size);
+  }
+
   TRY( Write<BigEndian>(stream, info.AccessFlags,
                                 info.NameIndex,
                                 info.DescriptorIndex,
                                 static_cast<U16>(info.Attributes.size())) );
 
   for(const auto& pAttr : info.Attributes)
-    TRY( Serializer::SerializeAttribute(stream, *pAttr) );
+    TRY( serializeAttribute(stream, *pAttr, sizes) );
 
   return {};
 }
 
-static ErrorOr<void> writeAttr(std::ostream& stream, const RawAttribute& attr)
+ErrorOr<void> Serializer::SerializeFieldMethod(std::ostream& stream, const FieldMethodInfo& info)
 {
-  //TODO: add array writing IO util funcs
-  stream.write(reinterpret_cast<const char*>(attr.Bytes.data()), attr.GetLength());
+  AttributeSizes sizes;
+
+  if(!isClean(info))
+    sizeAttributes(info.Attributes, sizes);
 
-  if(stream.bad())
-    return Error{ fmt::format("Serializer::writeAttr(): failed to write attribute.") };
+  return serializeFieldMethod(stream, info, sizes);
+}
+
+template <typename Stream>
+static ErrorOr<void> writeAttr(Stream& stream, const RawAttribute& attr)
+{
+  TRY( WriteBytes(stream, attr.GetBytes().Data, attr.GetLength()),
+      "Serializer::writeAttr(): failed to write attribute." );
 
   return {};
 }
 
-static ErrorOr<void> writeAttr(std::ostream& stream, const SourceFileAttribute& attr)
+template <typename Stream>
+static ErrorOr<void> writeAttr(Stream& stream, const SourceFileAttribute& attr)
 {
   TRY( Write<BigEndian>(stream, attr.SourceFileIndex) );
   return {};
 }
 
-static ErrorOr<void> writeAttr(std::ostream& stream, const CodeAttribute& attr)
+template <typename Stream>
+static ErrorOr<void> writeAttr(Stream& stream, const CodeAttribute& attr, AttributeSizes& sizes)
 {
   TRY( Write<BigEndian>(stream, attr.MaxStack,
                                 attr.MaxLocals) );
 
+  //lazily parsed and never decoded, the retained body is still exactly what
+  //would be serialized
+  if(!attr.IsDecoded())
+  {
+    ByteView body = attr.GetUndecodedBody();
+    TRY( WriteBytes(stream, body.Data, body.Size),
+        "Serializer::writeAttr(): failed to write code attribute body." );
 
-  //TODO: handle padding for instructions that require alignment
-  U32 codeLen{0};
-  for(const Instruction&  instr : attr.Code)
-    codeLen += instr.GetLength();
+    return {};
+  }
 
-  TRY( Write<BigEndian>(stream, codeLen) );
+  U32 codeLen = sizes.Take();
 
-  for(const Instruction& instr : attr.Code)
-    TRY( Serializer::SerializeInstruction(stream, instr) );
+  TRY( Write<BigEndian>(stream, codeLen) );
+  TRY( writeCode(stream, attr, codeLen) );
 
   TRY( Write<BigEndian>(stream, static_cast<U16>(attr.ExceptionTable.size())) );
 
-  for(auto handler : attr.ExceptionTable)
-  {
-    TRY( Write<BigEndian>(stream, handler.StartPC, 
-                                  handler.EndPC,
-                                  handler.HandlerPC,
-                                  handler.CatchType) );
-  }
+  TRY( (WriteArray<BigEndian, U16>(stream, attr.ExceptionTable.data(), attr.ExceptionTable.size())) );
 
   TRY( Write<BigEndian>(stream, static_cast<U16>(attr.Attributes.size())) );
 
   for(const auto& pAttr : attr.Attributes)
-    TRY ( Serializer::SerializeAttribute(stream, *pAttr) );
+    TRY ( serializeAttribute(stream, *pAttr, sizes) );
 
   return {};
 }
 
-static ErrorOr<void> writeAttr(std::ostream& stream, const ConstantValueAttribute& attr)
+template <typename Stream>
+static ErrorOr<void> writeAttr(Stream& stream, const ConstantValueAttribute& attr)
 {
   TRY( Write<BigEndian>(stream, attr.Index) );
   return {};
 }
 
-template <typename T>
-static ErrorOr<void> writeAttrT(std::ostream& stream, const AttributeInfo& info)
+template <typename Stream>
+static ErrorOr<void> writeAttr(Stream& stream, const EnclosingMethodAttribute& attr)
 {
-  return writeAttr(stream, static_cast<const T&>(info));
+  TRY( Write<BigEndian>(stream, attr.ClassIndex,
+                                attr.MethodIndex) );
+  return {};
 }
 
-ErrorOr<void> Serializer::SerializeAttribute(std::ostream& stream, const AttributeInfo& info)
+template <typename Stream>
+static ErrorOr<void> writeAttr(Stream& stream, const SyntheticAttribute& attr)
 {
-  TRY( Write<BigEndian>(stream, info.NameIndex, info.GetLength()) );
+  return {};
+}
 
-  switch(info.GetType())
+template <typename Stream>
+static ErrorOr<void> writeAttr(Stream& stream, const DeprecatedAttribute& attr)
+{
+  return {};
+}
+
+template <typename Stream>
+static ErrorOr<void> writeAttr(Stream& stream, const SignatureAttribute& attr)
+{
+  TRY( Write<BigEndian>(stream, attr.SignatureIndex) );
+  return {};
+}
+
+template <typename Stream>
+static ErrorOr<void> writeAttr(Stream& stream, const NestHostAttribute& attr)
+{
+  TRY( Write<BigEndian>(stream, attr.HostClassIndex) );
+  return {};
+}
+
+template <typename Stream>
+static ErrorOr<void> writeAttr(Stream& stream, const ModuleMainClassAttribute& attr)
+{
+  TRY( Write<BigEndian>(stream, attr.MainClassIndex) );
+  return {};
+}
+
+//A count prefixed table of structs made of U16 fields (or of U16 itself)
+template <typename CountT, typename Stream, typename T>
+static ErrorOr<void> writeTable(Stream& stream, const std::vector<T>& table)
+{
+  TRY( Write<BigEndian>(stream, static_cast<CountT>(table.size())) );
+  TRY( (WriteArray<BigEndian, U16>(stream, table.data(), table.size())) );
+
+  return {};
+}
+
+template <typename Stream>
+static ErrorOr<void> writeAttr(Stream& stream, const IndexTableAttribute& attr)
+{
+  return writeTable<U16>(stream, attr.Indices);
+}
+
+template <typename Stream>
+static ErrorOr<void> writeAttr(Stream& stream, const InnerClassesAttribute& attr)
+{
+  return writeTable<U16>(stream, attr.Classes);
+}
+
+template <typename Stream>
+static ErrorOr<void> writeAttr(Stream& stream, const LineNumberTableAttribute& attr)
+{
+  return writeTable<U16>(stream, attr.LineNumberTable);
+}
+
+template <typename Stream>
+static ErrorOr<void> writeAttr(Stream& stream, const LocalVariableTableAttribute& attr)
+{
+  return writeTable<U16>(stream, attr.LocalVariableTable);
+}
+
+template <typename Stream>
+static ErrorOr<void> writeAttr(Stream& stream, const LocalVariableTypeTableAttribute& attr)
+{
+  return writeTable<U16>(stream, attr.LocalVariableTypeTable);
+}
+
+template <typename Stream>
+static ErrorOr<void> writeAttr(Stream& stream, const MethodParametersAttribute& attr)
+{
+  return writeTable<U8>(stream, attr.Parameters);
+}
+
+template <typename Stream>
+static ErrorOr<void> writeAttr(Stream& stream, const SourceDebugExtensionAttribute& attr)
+{
+  return WriteBytes(stream, attr.DebugExtension.data(), attr.DebugExtension.size());
+}
+
+template <typename Stream>
+static ErrorOr<void> writeVerificationTypes(Stream& stream, 
+    const std::vector<StackMapTableAttribute::VerificationType>& types)
+{
+  using Item = StackMapTableAttribute::VerificationType::Item;
+
+  for(const auto& type : types)
+  {
+    TRY( Write<BigEndian>(stream, static_cast<U8>(type.Tag)) );
+
+    if(type.Tag == Item::Object || type.Tag == Item::Uninitialized)
+      TRY( Write<BigEndian>(stream, type.Data) );
+  }
+
+  return {};
+}
+
+template <typename Stream>
+static ErrorOr<void> writeAttr(Stream& stream, const StackMapTableAttribute& attr)
+{
+  using Frame = StackMapTableAttribute::Frame;
+
+  TRY( Write<BigEndian>(stream, static_cast<U16>(attr.Entries.size())) );
+
+  for(const Frame& frame : attr.Entries)
   {
-    case AttributeInfo::Type::ConstantValue: return writeAttrT<ConstantValueAttribute>(stream, info);
-    case AttributeInfo::Type::Code:          return writeAttrT<CodeAttribute>(stream, info);
-    case AttributeInfo::Type::SourceFile:    return writeAttrT<SourceFileAttribute>(stream, info);
+    if(Frame::IsReserved(frame.FrameType))
+      return Error{ErrorCode::InvalidAttributeTag, Tell(stream), frame.FrameType};
+
+    Frame::Kind kind = frame.GetKind();
+
+    if(kind == Frame::Kind::SameLocals1StackItem && frame.Stack.size() != 1)
+      return Error{ErrorCode::InvalidFrameItemCount, Tell(stream), frame.FrameType, frame.Stack.size()};
 
-    case AttributeInfo::Type::Raw:           return writeAttrT<RawAttribute>(stream, info);
+    if(kind == Frame::Kind::Append && (frame.Locals.empty() || frame.Locals.size() > 3))
+      return Error{ErrorCode::InvalidFrameItemCount, Tell(stream), frame.FrameType, frame.Locals.size()};
+
+    U8 frameType = frame.GetEncodedFrameType();
+    TRY( Write<BigEndian>(stream, frameType) );
+
+    if(frameType >= 128)
+      TRY( Write<BigEndian>(stream, frame.OffsetDelta) );
+
+    switch(kind)
+    {
+      case Frame::Kind::Same:
+      case Frame::Kind::Chop:
+        break;
+
+      case Frame::Kind::SameLocals1StackItem:
+        TRY( writeVerificationTypes(stream, frame.Stack) );
+        break;
+
+      case Frame::Kind::Append:
+        TRY( writeVerificationTypes(stream, frame.Locals) );
+        break;
+
+      case Frame::Kind::Full:
+        TRY( Write<BigEndian>(stream, static_cast<U16>(frame.Locals.size())) );
+        TRY( writeVerificationTypes(stream, frame.Locals) );
+        TRY( Write<BigEndian>(stream, static_cast<U16>(frame.Stack.size())) );
+        TRY( writeVerificationTypes(stream, frame.Stack) );
+        break;
+    }
   }
 
-  return Error{ fmt::format("Serializer::WriteAttribute(): encountered unknown "
-      "attribute \"{}\".", info.GetName()) };
+  return {};
 }
 
-template <typename T>
-static ErrorOr<void> writeOperand(std::ostream& stream, const Instruction& instr, size_t i)
+template <typename Stream>
+static ErrorOr<void> writeAttr(Stream& stream, const BootstrapMethodsAttribute& attr)
 {
-  auto errOrRef = instr.Operand<T>(i);
-  VERIFY(errOrRef, 
-      fmt::format("failed to access operand {}, of \"{}\"", i, instr.GetMnemonic()));
+  TRY( Write<BigEndian>(stream, static_cast<U16>(attr.BootstrapMethods.size())) );
 
-  TRY(Write<BigEndian>(stream, errOrRef.Get().get()));
+  for(const auto& method : attr.BootstrapMethods)
+  {
+    TRY( Write<BigEndian>(stream, method.BootstrapMethodRef) );
+    TRY( writeTable<U16>(stream, method.BootstrapArguments) );
+  }
 
-  return NoError{};
+  return {};
 }
 
-ErrorOr<void> Serializer::SerializeInstruction(std::ostream& stream, const Instruction& instr)
+//exports & opens
+template <typename Stream>
+static ErrorOr<void> writeModulePackages(Stream& stream, 
+    const std::vector<ModuleAttribute::Package>& packages)
+{
+  TRY( Write<BigEndian>(stream, static_cast<U16>(packages.size())) );
+
+  for(const auto& package : packages)
+  {
+    TRY( Write<BigEndian>(stream, package.Index,
+                                  package.Flags) );
+    TRY( writeTable<U16>(stream, package.ToIndices) );
+  }
+
+  return {};
+}
+
+template <typename Stream>
+static ErrorOr<void> writeAttr(Stream& stream, const ModuleAttribute& attr)
+{
+  TRY( Write<BigEndian>(stream, attr.ModuleNameIndex,
+                                attr.ModuleFlags,
+                                attr.ModuleVersionIndex) );
+
+  TRY( writeTable<U16>(stream, attr.Requires) );
+  TRY( writeModulePackages(stream, attr.Exports) );
+  TRY( writeModulePackages(stream, attr.Opens) );
+  TRY( writeTable<U16>(stream, attr.Uses) );
+
+  TRY( Write<BigEndian>(stream, static_cast<U16>(attr.Provides.size())) );
+
+  for(const auto& provide : attr.Provides)
+  {
+    TRY( Write<BigEndian>(stream, provide.ProvidesIndex) );
+    TRY( writeTable<U16>(stream, provide.ProvidesWithIndices) );
+  }
+
+  return {};
+}
+
+template <typename Stream>
+static ErrorOr<void> writeAttr(Stream& stream, const RecordAttribute& attr, AttributeSizes& sizes)
+{
+  TRY( Write<BigEndian>(stream, static_cast<U16>(attr.Components.size())) );
+
+  for(const auto& component : attr.Components)
+  {
+    TRY( Write<BigEndian>(stream, component.NameIndex,
+                                  component.DescriptorIndex,
+                                  static_cast<U16>(component.Attributes.size())) );
+
+    for(const auto& pAttr : component.Attributes)
+      TRY( serializeAttribute(stream, *pAttr, sizes) );
+  }
+
+  return {};
+}
+
+template <typename Stream>
+static ErrorOr<void> writeElementValue(Stream&, const ElementValue&);
+
+template <typename Stream>
+static ErrorOr<void> writeAnnotation(Stream& stream, const Annotation& annotation)
+{
+  TRY( Write<BigEndian>(stream, annotation.TypeIndex,
+                                static_cast<U16>(annotation.ElementValuePairs.size())) );
+
+  for(const auto& pair : annotation.ElementValuePairs)
+  {
+    TRY( Write<BigEndian>(stream, pair.ElementNameIndex) );
+    TRY( writeElementValue(stream, pair.Value) );
+  }
+
+  return {};
+}
+
+template <typename Stream>
+static ErrorOr<void> writeElementValue(Stream& stream, const ElementValue& value)
+{
+  TRY( Write<BigEndian>(stream, value.Tag) );
+
+  switch(value.Tag)
+  {
+    case 'B': case 'C': case 'D': case 'F': case 'I': case 'J': case 'S': case 'Z': 
+    case 's': case 'c':
+      return Write<BigEndian>(stream, value.Index);
+
+    case 'e':
+      return Write<BigEndian>(stream, value.Index, value.ConstNameIndex);
+
+    case '@':
+      if(!value.AnnotationValue)
+        break;
+
+      return writeAnnotation(stream, *value.AnnotationValue);
+
+    case '[':
+      TRY( Write<BigEndian>(stream, static_cast<U16>(value.ArrayValue.size())) );
+
+      for(const ElementValue& element : value.ArrayValue)
+        TRY( writeElementValue(stream, element) );
+
+      return {};
+  }
+
+  return Error{ErrorCode::InvalidAttributeTag, Tell(stream) - sizeof(U8), value.Tag};
+}
+
+template <typename Stream>
+static ErrorOr<void> writeAnnotations(Stream& stream, const std::vector<Annotation>& annotations)
+{
+  TRY( Write<BigEndian>(stream, static_cast<U16>(annotations.size())) );
+
+  for(const Annotation& annotation : annotations)
+    TRY( writeAnnotation(stream, annotation) );
+
+  return {};
+}
+
+template <typename Stream>
+static ErrorOr<void> writeAttr(Stream& stream, const AnnotationsAttribute& attr)
+{
+  return writeAnnotations(stream, attr.Annotations);
+}
+
+template <typename Stream>
+static ErrorOr<void> writeAttr(Stream& stream, const ParameterAnnotationsAttribute& attr)
+{
+  TRY( Write<BigEndian>(stream, static_cast<U8>(attr.ParameterAnnotations.size())) );
+
+  for(const auto& annotations : attr.ParameterAnnotations)
+    TRY( writeAnnotations(stream, annotations) );
+
+  return {};
+}
+
+template <typename Stream>
+static ErrorOr<void> writeTypeAnnotation(Stream& stream, const TypeAnnotation& annotation)
+{
+  using Kind = TypeAnnotation::TargetKind;
+
+  auto errOrKind = TypeAnnotation::GetTargetKind(annotation.TargetType);
+  if(errOrKind.IsError())
+  {
+    return Error{ErrorCode::InvalidAttributeTag, Tell(stream), annotation.TargetType};
+  }
+
+  TRY( Write<BigEndian>(stream, annotation.TargetType) );
+
+  switch(errOrKind.Get())
+  {
+    case Kind::TypeParameter:
+    case Kind::FormalParameter:
+      TRY( Write<BigEndian>(stream, static_cast<U8>(annotation.TargetIndex)) );
+      break;
+
+    case Kind::Supertype:
+    case Kind::Throws:
+    case Kind::Catch:
+    case Kind::Offset:
+      TRY( Write<BigEndian>(stream, annotation.TargetIndex) );
+      break;
+
+    case Kind::TypeParameterBound:
+      TRY( Write<BigEndian>(stream, static_cast<U8>(annotation.TargetIndex), 
+                                    annotation.TargetArgument) );
+      break;
+
+    case Kind::TypeArgument:
+      TRY( Write<BigEndian>(stream, annotation.TargetIndex, 
+                                    annotation.TargetArgument) );
+      break;
+
+    case Kind::LocalVar:
+      TRY( writeTable<U16>(stream, annotation.LocalVarTable) );
+      break;
+
+    case Kind::Empty:
+      break;
+  }
+
+  TRY( Write<BigEndian>(stream, static_cast<U8>(annotation.TargetPath.size())) );
+  TRY( (WriteArray<BigEndian, U8>(stream, annotation.TargetPath.data(), annotation.TargetPath.size())) );
+
+  return writeAnnotation(stream, annotation);
+}
+
+template <typename Stream>
+static ErrorOr<void> writeAttr(Stream& stream, const TypeAnnotationsAttribute& attr)
 {
-  if(instr.IsComplex())
-    return Error{ fmt::format("Serializer::SerializeInstruction(): \"{}\" is a "
-        "complex instruciton which serialization is not yet implemented for.", instr.GetMnemonic()) };
+  TRY( Write<BigEndian>(stream, static_cast<U16>(attr.Annotations.size())) );
 
-  TRY(Write<BigEndian>(stream, instr.Op));
+  for(const TypeAnnotation& annotation : attr.Annotations)
+    TRY( writeTypeAnnotation(stream, annotation) );
 
-  for(size_t i{0}; i < instr.GetNOperands(); ++i)
+  return {};
+}
+
+template <typename Stream>
+static ErrorOr<void> writeAttr(Stream& stream, const AnnotationDefaultAttribute& attr)
+{
+  return writeElementValue(stream, attr.DefaultValue);
+}
+
+template <typename T, typename Stream, typename... Args>
+static ErrorOr<void> writeAttrT(Stream& stream, const AttributeInfo& info, Args&... args)
+{
+  return writeAttr(stream, static_cast<const T&>(info), args...);
+}
+
+template <typename Stream>
+static ErrorOr<void> serializeAttribute(Stream& stream, const AttributeInfo& info, 
+    AttributeSizes& sizes)
+{
+  U32 len = sizes.Take();
+
+  if(isClean(info))
   {
-    switch( instr.GetOperandType(i) )
+    ByteView source = info.GetSource();
+    return WriteBytes(stream, source.Data, source.Size);
+  }
+
+  TRY( Write<BigEndian>(stream, info.NameIndex, len) );
+
+  //never decoded, the retained body is still exactly what would be 
+  //serialized (Code retains everything after max_locals, see writeAttr)
+  if(AttributeInfo::IsLazy(info.GetType()) && info.GetType() != AttributeInfo::Type::Code)
+  {
+    const auto& lazy = static_cast<const LazyAttribute&>(info);
+
+    if(!lazy.IsDecoded())
     {
-      using type = Instruction::OperandType;
-      case type::TypeS32: TRY( writeOperand<S32>(stream, instr, i) ); break;
-      case type::TypeS16: TRY( writeOperand<S16>(stream, instr, i) ); break;
-      case type::TypeS8 : TRY( writeOperand<S8 >(stream, instr, i) ); break;
-      case type::TypeU16: TRY( writeOperand<U16>(stream, instr, i) ); break;
-      case type::TypeU8 : TRY( writeOperand<U8 >(stream, instr, i) ); break;
+      ByteView body = lazy.GetUndecodedBody();
+      return WriteBytes(stream, body.Data, body.Size);
     }
   }
 
+  switch(info.GetType())
+  {
+    using Type = AttributeInfo::Type;
+
+    case Type::ConstantValue:   return writeAttrT<ConstantValueAttribute>(stream, info);
+    case Type::Code:            return writeAttrT<CodeAttribute>(stream, info, sizes);
+    case Type::SourceFile:      return writeAttrT<SourceFileAttribute>(stream, info);
+    case Type::EnclosingMethod: return writeAttrT<EnclosingMethodAttribute>(stream, info);
+    case Type::Synthetic:       return writeAttrT<SyntheticAttribute>(stream, info);
+    case Type::Deprecated:      return writeAttrT<DeprecatedAttribute>(stream, info);
+    case Type::Signature:       return writeAttrT<SignatureAttribute>(stream, info);
+    case Type::NestHost:        return writeAttrT<NestHostAttribute>(stream, info);
+    case Type::ModuleMainClass: return writeAttrT<ModuleMainClassAttribute>(stream, info);
+
+    case Type::StackMapTable:   return writeAttrT<StackMapTableAttribute>(stream, info);
+    case Type::InnerClasses:    return writeAttrT<InnerClassesAttribute>(stream, info);
+    case Type::LineNumberTable: return writeAttrT<LineNumberTableAttribute>(stream, info);
+    case Type::LocalVariableTable:     return writeAttrT<LocalVariableTableAttribute>(stream, info);
+    case Type::LocalVariableTypeTable: return writeAttrT<LocalVariableTypeTableAttribute>(stream, info);
+    case Type::SourceDebugExtension:   return writeAttrT<SourceDebugExtensionAttribute>(stream, info);
+    case Type::BootstrapMethods: return writeAttrT<BootstrapMethodsAttribute>(stream, info);
+    case Type::MethodParameters: return writeAttrT<MethodParametersAttribute>(stream, info);
+    case Type::Module:           return writeAttrT<ModuleAttribute>(stream, info);
+    case Type::Record:           return writeAttrT<RecordAttribute>(stream, info, sizes);
+    case Type::AnnotationDefault: return writeAttrT<AnnotationDefaultAttribute>(stream, info);
+
+    case Type::Exceptions:
+    case Type::NestMembers:
+    case Type::PermittedSubclasses:
+    case Type::ModulePackages:
+      return writeAttrT<IndexTableAttribute>(stream, info);
+
+    case Type::RuntimeVisibleAnnotations:
+    case Type::RuntimeInvisibleAnnotations:
+      return writeAttrT<AnnotationsAttribute>(stream, info);
+
+    case Type::RuntimeVisibleParameterAnnotations:
+    case Type::RuntimeInvisibleParameterAnnotations:
+      return writeAttrT<ParameterAnnotationsAttribute>(stream, info);
+
+    case Type::RuntimeVisibleTypeAnnotations:
+    case Type::RuntimeInvisibleTypeAnnotations:
+      return writeAttrT<TypeAnnotationsAttribute>(stream, info);
+
+    case Type::Raw:             return writeAttrT<RawAttribute>(stream, info);
+  }
+
+  return Error{ErrorCode::UnknownAttribute, Tell(stream)};
+}
+
+ErrorOr<void> Serializer::SerializeAttribute(std::ostream& stream, const AttributeInfo& info)
+{
+  AttributeSizes sizes;
+  sizeAttribute(info, sizes);
+
+  return serializeAttribute(stream, info, sizes);
+}
+
+//Encodes the code array into dst, which holds codeLen bytes as computed by 
+//CodeAttribute::GetCodeLength()
+static ErrorOr<void> encodeCode(const CodeAttribute& attr, U8* dst, U32 codeLen)
+{
+  size_t offset{0};
+
+  for(const Instruction& instr : attr.Code)
+  {
+    size_t length = instr.GetLength(offset, attr.Switches);
+    assert(offset + length <= codeLen);
+
+    //switch table errors don't know where the instruction is
+    auto err = instr.Encode(dst + offset, offset, attr.Switches);
+    if(err.IsError() && err.GetError().Offset == Error::NoOffset)
+      err.GetError().Offset = offset;
+
+    VERIFY(err, "failed to encode instruction");
+
+    offset += length;
+  }
+
   return {};
 }
 
+static ErrorOr<void> writeCode(ByteWriter& writer, const CodeAttribute& attr, U32 codeLen)
+{
+  if(!writer.Has(codeLen))
+    return Error{ErrorCode::BufferOverrun, writer.Tell(), codeLen, writer.Remaining()};
+
+  return encodeCode(attr, writer.Advance(codeLen), codeLen);
+}
+
+static ErrorOr<void> writeCode(std::ostream& stream, const CodeAttribute& attr, U32 codeLen)
+{
+  std::vector<U8> buffer(codeLen);
+  TRY( encodeCode(attr, buffer.data(), codeLen) );
+
+  return WriteBytes(stream, buffer.data(), buffer.size());
+}
+
+static ErrorOr<void> serializeInstruction(std::ostream& stream, const Instruction& instr)
+{
+  //a lone switch has no offset to pad from or table to encode
+  if(instr.IsSwitch())
+    return Error{ErrorCode::ComplexInstruction, Tell(stream), static_cast<U8>(instr.Op)};
+
+  std::array<U8, Instruction::MaxLength> bytes;
+  TRY( instr.Encode(bytes.data(), 0, {}) );
+
+  return WriteBytes(stream, bytes.data(), instr.GetLength());
+}
+
+ErrorOr<void> Serializer::SerializeInstruction(std::ostream& stream, const Instruction& instr)
+{
+  return serializeInstruction(stream, instr);
+}
+
 } //namespace ClassFile
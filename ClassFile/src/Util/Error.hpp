@@ -2,18 +2,29 @@
 
 #include <fmt/core.h>
 
+#include <utility>
+
+//Both only append a frame to the error's trace on the way up, nothing is 
+//formatted until Error::Message() is called. throwMsg may be a string 
+//literal, which is recorded as is, or any string, which is copied.
 #define TRY_2( expr, throwMsg )\
 {\
   auto errOr = (expr);\
 \
   if(errOr.IsError())\
-    return Error{ fmt::format("{} threw: {}\n  {}", __func__, throwMsg, errOr.GetError().What)};\
+  {\
+    errOr.GetError().AddFrame(__func__, throwMsg);\
+    return std::move(errOr.GetError());\
+  }\
 }
 
 #define VERIFY_2( errOr, throwMsg )\
 {\
   if (errOr.IsError())\
-    return Error{ fmt::format("{} threw: {}\n  {}", __func__, throwMsg, errOr.GetError().What)};\
+  {\
+    errOr.GetError().AddFrame(__func__, throwMsg);\
+    return std::move(errOr.GetError());\
+  }\
 }
 
 #define TRY_1( expr ) TRY_2(expr, "")
@@ -24,4 +35,3 @@
 
 #define TRY(...) GET_MACRO(__VA_ARGS__, TRY_2, TRY_1)(__VA_ARGS__)
 #define VERIFY(...) GET_MACRO(__VA_ARGS__, VERIFY_2, VERIFY_1)(__VA_ARGS__)
-
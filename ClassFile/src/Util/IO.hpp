@@ -1,10 +1,16 @@
 #pragma once
 
-#include "fmt/core.h"
-
 #include "ClassFile/Defs.hpp"
 #include "ClassFile/Error.hpp"
 
+#include <algorithm>
+#include <cstring>
+#include <type_traits>
+
+#if defined(__SSE2__)
+  #include <emmintrin.h>
+#endif
+
 using namespace ClassFile;
 
 #if defined(__BYTE_ORDER__) 
@@ -25,20 +31,98 @@ constexpr ByteOrder GetHostByteOrder()
   return HOST_BYTEORDER_IS_LE ? ByteOrder::LittleEndian : ByteOrder::BigEndian;
 }
 
+inline U16 ByteSwap(U16 v)
+{
+#if defined(__GNUC__)
+  return __builtin_bswap16(v);
+#else
+  return static_cast<U16>((v << 8) | (v >> 8));
+#endif
+}
+
+inline U32 ByteSwap(U32 v)
+{
+#if defined(__GNUC__)
+  return __builtin_bswap32(v);
+#else
+  return (v << 24) | ((v << 8) & 0x00FF0000) | ((v >> 8) & 0x0000FF00) | (v >> 24);
+#endif
+}
+
+inline U64 ByteSwap(U64 v)
+{
+#if defined(__GNUC__)
+  return __builtin_bswap64(v);
+#else
+  return (U64{ByteSwap(static_cast<U32>(v))} << 32) | ByteSwap(static_cast<U32>(v >> 32));
+#endif
+}
+
+template <size_t Size> struct UnsignedOfSize;
+template <> struct UnsignedOfSize<1> { using Type = U8;  };
+template <> struct UnsignedOfSize<2> { using Type = U16; };
+template <> struct UnsignedOfSize<4> { using Type = U32; };
+template <> struct UnsignedOfSize<8> { using Type = U64; };
+
 template <typename T>
 void SwapByteOrder(T& t)
 {
-  char* bytes = reinterpret_cast<char*>(&t);
-  size_t len = sizeof(t);
+  static_assert(std::is_trivially_copyable_v<T>);
+
+  if constexpr (sizeof(T) > 1)
+  {
+    typename UnsignedOfSize<sizeof(T)>::Type bits;
+    std::memcpy(&bits, &t, sizeof(T));
+
+    bits = ByteSwap(bits);
+    std::memcpy(&t, &bits, sizeof(T));
+  }
+}
+
+//Swaps the byte order of count consecutive Width byte values in place. 16 
+//and 32 bit values are swapped 16 bytes at a time with SSE2, the rest of 
+//the values (and every value without SSE2) with bswap.
+template <size_t Width>
+void SwapByteOrderArray(U8* data, size_t count)
+{
+  using Word = typename UnsignedOfSize<Width>::Type;
+
+  if constexpr (Width == 1)
+    return;
 
-  char tmp;
-  for (size_t i = 0; i < (len / 2); i++)
+  size_t i{0};
+
+#if defined(__SSE2__)
+  if constexpr (Width == 2 || Width == 4)
   {
-    tmp = bytes[i];
-    bytes[i] = bytes[len - 1 - i];
-    bytes[len - 1 - i] = tmp;
+    constexpr size_t perVector = 16 / Width;
+
+    for(; i + perVector <= count; i += perVector)
+    {
+      __m128i* ptr = reinterpret_cast<__m128i*>(data + i * Width);
+      __m128i v = _mm_loadu_si128(ptr);
+
+      //32 bit values swap their 16 bit halves first
+      if constexpr (Width == 4)
+      {
+        v = _mm_shufflelo_epi16(v, _MM_SHUFFLE(2, 3, 0, 1));
+        v = _mm_shufflehi_epi16(v, _MM_SHUFFLE(2, 3, 0, 1));
+      }
+
+      v = _mm_or_si128(_mm_slli_epi16(v, 8), _mm_srli_epi16(v, 8));
+      _mm_storeu_si128(ptr, v);
+    }
   }
+#endif
 
+  for(; i < count; i++)
+  {
+    Word word;
+    std::memcpy(&word, data + i * Width, Width);
+
+    SwapByteOrder(word);
+    std::memcpy(data + i * Width, &word, Width);
+  }
 }
 
 template <ByteOrder Order = LittleEndian, typename T>
@@ -48,8 +132,7 @@ ErrorOr<void> Read(std::istream& stream, T& t)
 
   if (stream.bad())
   {
-    return Error{fmt::format("Read: stream went bad at 0x{0:x} after trying to "
-        "read a \"{}\" ({} bytes)", static_cast<size_t>(stream.tellg()), typeid(T).name(), sizeof(T))};
+    return Error{ErrorCode::StreamFailure, static_cast<size_t>(stream.tellg()), sizeof(T)};
   }
 
   if (Order != GetHostByteOrder())
@@ -74,8 +157,7 @@ ErrorOr<void> Write(std::ostream& stream, const T& t)
 
   if (stream.bad())
   {
-    return Error{fmt::format("Write: stream went bad at 0x{0:x} after trying to "
-        "write a \"{}\" ({} bytes)", static_cast<size_t>(stream.tellp()), typeid(T).name(), sizeof(T))};
+    return Error{ErrorCode::StreamFailure, static_cast<size_t>(stream.tellp()), sizeof(T)};
   }
 
   return {};
@@ -92,3 +174,278 @@ ErrorOr<void> Write(std::ostream& stream, const Args&... args)
 {
   return (Write<Order>(stream, args), ...);
 }
+
+//Read cursor over a contiguous, in-memory byte range. Used in place of an 
+//std::istream by the buffer parsing path, reads are plain pointer arithmetic
+//and a bounds check is done once per Read() call rather than per field.
+class ByteReader
+{
+  public:
+    ByteReader(const U8* data, size_t size) : m_data{data}, m_size{size} {}
+
+    const U8* Data() const { return m_data; }
+    size_t Size() const { return m_size; }
+
+    size_t Tell() const { return m_pos; }
+    size_t Remaining() const { return m_size - m_pos; }
+    bool Has(size_t n) const { return n <= this->Remaining(); }
+
+    //Returns a pointer to the current position and moves past n bytes, 
+    //caller is responsible for checking Has(n) first
+    const U8* Advance(size_t n)
+    {
+      const U8* ptr = m_data + m_pos;
+      m_pos += n;
+      return ptr;
+    }
+
+  private:
+    const U8* m_data;
+    size_t m_size;
+    size_t m_pos{0};
+};
+
+inline size_t Tell(std::istream& stream) { return static_cast<size_t>(stream.tellg()); }
+inline size_t Tell(const ByteReader& reader) { return reader.Tell(); }
+
+template <ByteOrder Order, typename T>
+void Load(const U8* src, T& t)
+{
+  std::memcpy(&t, src, sizeof(T));
+
+  if (Order != GetHostByteOrder())
+    SwapByteOrder(t);
+}
+
+template <ByteOrder Order = LittleEndian, typename... Args>
+ErrorOr<void> Read(ByteReader& reader, Args&... args)
+{
+  constexpr size_t total = (sizeof(Args) + ...);
+
+  if (!reader.Has(total))
+  {
+    return Error{ErrorCode::BufferOverrun, reader.Tell(), total, reader.Remaining()};
+  }
+
+  (Load<Order>(reader.Advance(sizeof(Args)), args), ...);
+
+  return {};
+}
+
+inline ErrorOr<void> ReadBytes(std::istream& stream, void* dst, size_t n)
+{
+  stream.read(reinterpret_cast<char*>(dst), n);
+
+  if (stream.bad())
+  {
+    return Error{ErrorCode::StreamFailure, Tell(stream), n};
+  }
+
+  return {};
+}
+
+inline ErrorOr<void> ReadBytes(ByteReader& reader, void* dst, size_t n)
+{
+  if (!reader.Has(n))
+  {
+    return Error{ErrorCode::BufferOverrun, reader.Tell(), n, reader.Remaining()};
+  }
+
+  //empty vectors may pass nullptr, which memcpy doesn't take even for 0 bytes
+  if (n != 0)
+    std::memcpy(dst, reader.Advance(n), n);
+
+  return {};
+}
+
+//Reads n values of type T, whose byte order is swapped as consecutive Word
+//sized values. Word is T itself for integers, structs of same sized integer
+//fields (such as CodeAttribute::ExceptionHandler) pass the field type.
+template <ByteOrder Order = LittleEndian, typename Word = void, typename T, typename Stream>
+ErrorOr<void> ReadArray(Stream& stream, T* dst, size_t n)
+{
+  using W = std::conditional_t<std::is_void_v<Word>, T, Word>;
+  static_assert(std::is_trivially_copyable_v<T> && sizeof(T) % sizeof(W) == 0);
+
+  auto err = ReadBytes(stream, dst, n * sizeof(T));
+  if (err.IsError())
+    return err;
+
+  if (Order != GetHostByteOrder())
+    SwapByteOrderArray<sizeof(W)>(reinterpret_cast<U8*>(dst), n * (sizeof(T) / sizeof(W)));
+
+  return {};
+}
+
+//Zero-copy counterpart of ReadBytes(), returns a view into the reader's buffer
+inline ErrorOr<ByteView> ReadView(ByteReader& reader, size_t n)
+{
+  if (!reader.Has(n))
+  {
+    return Error{ErrorCode::BufferOverrun, reader.Tell(), n, reader.Remaining()};
+  }
+
+  return ByteView{reader.Advance(n), n};
+}
+
+//Moves past n bytes without copying them anywhere
+inline ErrorOr<void> Skip(std::istream& stream, size_t n)
+{
+  stream.ignore(static_cast<std::streamsize>(n));
+
+  if (stream.bad())
+  {
+    return Error{ErrorCode::StreamFailure, Tell(stream), n};
+  }
+
+  return {};
+}
+
+inline ErrorOr<void> Skip(ByteReader& reader, size_t n)
+{
+  if (!reader.Has(n))
+  {
+    return Error{ErrorCode::BufferOverrun, reader.Tell(), n, reader.Remaining()};
+  }
+
+  reader.Advance(n);
+  return {};
+}
+
+//Write cursor over a caller-sized, in-memory byte range, the counterpart of 
+//ByteReader used by the buffer serialization path
+class ByteWriter
+{
+  public:
+    ByteWriter(U8* data, size_t size) : m_data{data}, m_size{size} {}
+
+    U8* Data() const { return m_data; }
+    size_t Size() const { return m_size; }
+
+    size_t Tell() const { return m_pos; }
+    size_t Remaining() const { return m_size - m_pos; }
+    bool Has(size_t n) const { return n <= this->Remaining(); }
+
+    //Returns a pointer to the current position and moves past n bytes, 
+    //caller is responsible for checking Has(n) first
+    U8* Advance(size_t n)
+    {
+      U8* ptr = m_data + m_pos;
+      m_pos += n;
+      return ptr;
+    }
+
+  private:
+    U8* m_data;
+    size_t m_size;
+    size_t m_pos{0};
+};
+
+inline size_t Tell(std::ostream& stream) { return static_cast<size_t>(stream.tellp()); }
+inline size_t Tell(const ByteWriter& writer) { return writer.Tell(); }
+
+template <ByteOrder Order, typename T>
+void Store(U8* dst, T t)
+{
+  if (Order != GetHostByteOrder())
+    SwapByteOrder(t);
+
+  std::memcpy(dst, &t, sizeof(T));
+}
+
+template <ByteOrder Order = LittleEndian, typename... Args>
+ErrorOr<void> Write(ByteWriter& writer, const Args&... args)
+{
+  constexpr size_t total = (sizeof(Args) + ...);
+
+  if (!writer.Has(total))
+  {
+    return Error{ErrorCode::BufferOverrun, writer.Tell(), total, writer.Remaining()};
+  }
+
+  (Store<Order>(writer.Advance(sizeof(Args)), args), ...);
+
+  return {};
+}
+
+inline ErrorOr<void> WriteBytes(std::ostream& stream, const void* src, size_t n)
+{
+  stream.write(reinterpret_cast<const char*>(src), n);
+
+  if (stream.bad())
+  {
+    return Error{ErrorCode::StreamFailure, Tell(stream), n};
+  }
+
+  return {};
+}
+
+inline ErrorOr<void> WriteBytes(ByteWriter& writer, const void* src, size_t n)
+{
+  if (!writer.Has(n))
+  {
+    return Error{ErrorCode::BufferOverrun, writer.Tell(), n, writer.Remaining()};
+  }
+
+  if (n != 0)
+    std::memcpy(writer.Advance(n), src, n);
+
+  return {};
+}
+
+//Counterpart of ReadArray(), a ByteWriter is swapped in place after copying,
+//streams go through a small swapped chunk at a time
+template <ByteOrder Order = LittleEndian, typename Word = void, typename T>
+ErrorOr<void> WriteArray(ByteWriter& writer, const T* src, size_t n)
+{
+  using W = std::conditional_t<std::is_void_v<Word>, T, Word>;
+  static_assert(std::is_trivially_copyable_v<T> && sizeof(T) % sizeof(W) == 0);
+
+  size_t size = n * sizeof(T);
+
+  if (!writer.Has(size))
+  {
+    return Error{ErrorCode::BufferOverrun, writer.Tell(), size, writer.Remaining()};
+  }
+
+  if (size == 0)
+    return {};
+
+  U8* dst = writer.Advance(size);
+  std::memcpy(dst, src, size);
+
+  if (Order != GetHostByteOrder())
+    SwapByteOrderArray<sizeof(W)>(dst, size / sizeof(W));
+
+  return {};
+}
+
+template <ByteOrder Order = LittleEndian, typename Word = void, typename T>
+ErrorOr<void> WriteArray(std::ostream& stream, const T* src, size_t n)
+{
+  using W = std::conditional_t<std::is_void_v<Word>, T, Word>;
+  static_assert(std::is_trivially_copyable_v<T> && sizeof(T) % sizeof(W) == 0);
+
+  if (Order == GetHostByteOrder())
+    return WriteBytes(stream, src, n * sizeof(T));
+
+  constexpr size_t chunkSize = 256;
+  constexpr size_t perChunk = chunkSize / sizeof(T) > 0 ? chunkSize / sizeof(T) : 1;
+
+  U8 chunk[perChunk * sizeof(T)];
+
+  for (size_t i = 0; i < n; i += perChunk)
+  {
+    size_t count = std::min(perChunk, n - i);
+    size_t size = count * sizeof(T);
+
+    std::memcpy(chunk, src + i, size);
+    SwapByteOrderArray<sizeof(W)>(chunk, size / sizeof(W));
+
+    auto err = WriteBytes(stream, chunk, size);
+    if (err.IsError())
+      return err;
+  }
+
+  return {};
+}
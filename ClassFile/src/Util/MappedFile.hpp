@@ -0,0 +1,73 @@
+#pragma once
+
+#include "fmt/core.h"
+
+#include "ClassFile/Defs.hpp"
+#include "ClassFile/Error.hpp"
+
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <fcntl.h>
+#include <unistd.h>
+
+#include <cerrno>
+#include <cstring>
+#include <string>
+#include <string_view>
+
+using namespace ClassFile;
+
+//Maps a whole file read-only, caller is responsible for UnmapFile()ing the 
+//returned view. who is used to prefix error messages. Sequential hints the 
+//kernel that the mapping will be read front to back.
+inline ErrorOr<ByteView> MapFile(const std::string& path, std::string_view who, bool sequential)
+{
+  int fd = ::open(path.c_str(), O_RDONLY);
+
+  if(fd < 0)
+  {
+    return Error{fmt::format("{}: unable to open \"{}\": {}", 
+        who, path, std::strerror(errno))};
+  }
+
+  struct stat st;
+  if(::fstat(fd, &st) != 0)
+  {
+    int err = errno;
+    ::close(fd);
+    return Error{fmt::format("{}: unable to stat \"{}\": {}", 
+        who, path, std::strerror(err))};
+  }
+
+  if(st.st_size == 0)
+  {
+    ::close(fd);
+    return Error{fmt::format("{}: \"{}\" is empty", who, path)};
+  }
+
+  size_t size = static_cast<size_t>(st.st_size);
+  void* addr = ::mmap(nullptr, size, PROT_READ, MAP_PRIVATE, fd, 0);
+  int err = errno;
+
+  //the mapping stays valid after the descriptor is closed
+  ::close(fd);
+
+  if(addr == MAP_FAILED)
+  {
+    return Error{fmt::format("{}: unable to map \"{}\": {}", 
+        who, path, std::strerror(err))};
+  }
+
+  if(sequential)
+    ::madvise(addr, size, MADV_SEQUENTIAL);
+
+  ::madvise(addr, size, MADV_WILLNEED);
+
+  return ByteView{static_cast<const U8*>(addr), size};
+}
+
+inline void UnmapFile(ByteView view)
+{
+  if(view.Data != nullptr)
+    ::munmap(const_cast<U8*>(view.Data), view.Size);
+}
@@ -0,0 +1,111 @@
+#pragma once
+
+#include <atomic>
+#include <condition_variable>
+#include <cstddef>
+#include <functional>
+#include <mutex>
+#include <thread>
+#include <vector>
+
+//Fixed set of worker threads which are kept alive between jobs. A job is an
+//index range that workers pull indices from through a shared counter, so
+//uneven item costs (e.g. class files of very different sizes) balance out.
+class ThreadPool
+{
+  public:
+    using Job = std::function<void(unsigned worker, size_t index)>;
+
+    explicit ThreadPool(unsigned threads)
+    {
+      m_threads.reserve(threads);
+
+      for(unsigned i = 0; i < threads; i++)
+        m_threads.emplace_back(&ThreadPool::run, this, i);
+    }
+
+    ~ThreadPool()
+    {
+      {
+        std::lock_guard<std::mutex> lock{m_mutex};
+        m_stop = true;
+      }
+
+      m_wake.notify_all();
+
+      for(auto& thread : m_threads)
+        thread.join();
+    }
+
+    ThreadPool(const ThreadPool&) = delete;
+    ThreadPool& operator=(const ThreadPool&) = delete;
+
+    unsigned GetSize() const { return static_cast<unsigned>(m_threads.size()); }
+
+    //Calls job(worker, index) for every index in [0, count), where worker is
+    //in [0, GetSize()) and never runs two calls at once. Blocks until every
+    //call returned. Concurrent callers are serialized.
+    void ForEach(size_t count, const Job& job)
+    {
+      if(count == 0)
+        return;
+
+      std::lock_guard<std::mutex> submit{m_submitMutex};
+      std::unique_lock<std::mutex> lock{m_mutex};
+
+      m_job = &job;
+      m_count = count;
+      m_next = 0;
+      m_busy = this->GetSize();
+      m_generation++;
+
+      m_wake.notify_all();
+      m_done.wait(lock, [this]() { return m_busy == 0; });
+
+      m_job = nullptr;
+    }
+
+  private:
+    void run(unsigned worker)
+    {
+      size_t seen{0};
+
+      std::unique_lock<std::mutex> lock{m_mutex};
+
+      while(true)
+      {
+        m_wake.wait(lock, [&]() { return m_stop || m_generation != seen; });
+
+        if(m_stop)
+          return;
+
+        seen = m_generation;
+        const Job& job = *m_job;
+        size_t count = m_count;
+
+        lock.unlock();
+
+        for(size_t i = m_next++; i < count; i = m_next++)
+          job(worker, i);
+
+        lock.lock();
+
+        if(--m_busy == 0)
+          m_done.notify_all();
+      }
+    }
+
+    std::vector<std::thread> m_threads;
+
+    std::mutex m_submitMutex;
+    std::mutex m_mutex;
+    std::condition_variable m_wake;
+    std::condition_variable m_done;
+
+    const Job* m_job{nullptr};
+    size_t m_count{0};
+    std::atomic<size_t> m_next{0};
+    unsigned m_busy{0};
+    size_t m_generation{0};
+    bool m_stop{false};
+};
@@ -0,0 +1,729 @@
+#include "ClassFile/ZipArchive.hpp"
+
+#include "Util/IO.hpp"
+#include "Util/Error.hpp"
+#include "Util/MappedFile.hpp"
+
+#include <fmt/core.h>
+
+#include <algorithm>
+#include <iterator>
+#include <utility>
+
+namespace ClassFile
+{
+
+static constexpr U32 localHeaderSignature = 0x04034b50;
+static constexpr U32 centralHeaderSignature = 0x02014b50;
+static constexpr U32 endOfCentralDirSignature = 0x06054b50;
+
+static constexpr size_t localHeaderSize = 30;
+static constexpr size_t endOfCentralDirSize = 22;
+
+//general purpose bit flag 0
+static constexpr U16 encryptedFlag = 0x1;
+
+//Slicing-by-8 tables, Tables[0] is the plain byte-at-a-time table and 
+//Tables[k] advances a CRC by k additional zero bytes
+struct CRC32Tables
+{
+  U32 Tables[8][256];
+
+  constexpr CRC32Tables() : Tables{}
+  {
+    for(U32 i = 0; i < 256; i++)
+    {
+      U32 crc = i;
+      for(int bit = 0; bit < 8; bit++)
+        crc = (crc & 1) ? (crc >> 1) ^ 0xEDB88320 : crc >> 1;
+
+      Tables[0][i] = crc;
+    }
+
+    for(U32 i = 0; i < 256; i++)
+      for(int k = 1; k < 8; k++)
+        Tables[k][i] = (Tables[k - 1][i] >> 8) ^ Tables[0][Tables[k - 1][i] & 0xFF];
+  }
+};
+
+static U32 crc32(const U8* data, size_t size)
+{
+  static constexpr CRC32Tables crc32Tables;
+  const auto& t = crc32Tables.Tables;
+
+  U32 crc = 0xFFFFFFFF;
+
+  for(; size >= 8; data += 8, size -= 8)
+  {
+    U32 lo, hi;
+    Load<LittleEndian>(data, lo);
+    Load<LittleEndian>(data + 4, hi);
+
+    lo ^= crc;
+
+    crc = t[7][lo & 0xFF] ^ t[6][(lo >> 8) & 0xFF] ^ t[5][(lo >> 16) & 0xFF] ^ t[4][lo >> 24]
+        ^ t[3][hi & 0xFF] ^ t[2][(hi >> 8) & 0xFF] ^ t[1][(hi >> 16) & 0xFF] ^ t[0][hi >> 24];
+  }
+
+  for(; size > 0; data++, size--)
+    crc = t[0][(crc ^ *data) & 0xFF] ^ (crc >> 8);
+
+  return crc ^ 0xFFFFFFFF;
+}
+
+//
+// Raw DEFLATE (RFC 1951) decoder
+//
+
+//LSB-first bit reader over the compressed data. Reading past the end yields
+//zero bits, which is detected once the stream is done with Overrun().
+class BitReader
+{
+  public:
+    BitReader(const U8* data, size_t size) : m_pos{data}, m_end{data + size} {}
+
+    //Ensures at least 56 bits are buffered
+    void Refill()
+    {
+      if(m_count > 56)
+        return;
+
+      if(m_end - m_pos >= 8)
+      {
+        U64 word;
+        Load<LittleEndian>(m_pos, word);
+
+        m_bits |= word << m_count;
+
+        size_t n = (63 - m_count) >> 3;
+        m_pos += n;
+        m_count += n * 8;
+        return;
+      }
+
+      while(m_count <= 56)
+      {
+        U64 byte{0};
+
+        if(m_pos < m_end)
+          byte = *m_pos++;
+        else
+          m_padding += 8;
+
+        m_bits |= byte << m_count;
+        m_count += 8;
+      }
+    }
+
+    //Callers Refill() beforehand, n <= 56
+    U32 Peek(unsigned n) const { return static_cast<U32>(m_bits & ((U64{1} << n) - 1)); }
+    void Consume(unsigned n) { m_bits >>= n; m_count -= n; }
+
+    U32 Bits(unsigned n)
+    {
+      this->Refill();
+      U32 value = this->Peek(n);
+      this->Consume(n);
+      return value;
+    }
+
+    void AlignToByte() { this->Consume(m_count % 8); }
+
+    //true if any of the zero bits fed past the end of the input were consumed
+    bool Overrun() const { return m_padding > m_count; }
+
+  private:
+    const U8* m_pos;
+    const U8* m_end;
+    U64 m_bits{0};
+    unsigned m_count{0};
+    size_t m_padding{0};
+};
+
+//Canonical Huffman code. Codes of up to FastBits bits are decoded with a
+//single table lookup, longer ones fall back to walking the code lengths.
+struct Huffman
+{
+  static constexpr unsigned MaxBits = 15;
+  static constexpr unsigned FastBits = 10;
+
+  //(symbol << 4) | code length, 0 if the code is longer than FastBits
+  U16 Fast[1 << FastBits];
+  U16 Counts[MaxBits + 1];
+  U16 Symbols[288];
+
+  ErrorOr<void> Build(const U8* lengths, size_t n)
+  {
+    std::fill(std::begin(Counts), std::end(Counts), 0);
+    std::fill(std::begin(Fast), std::end(Fast), 0);
+
+    for(size_t sym = 0; sym < n; sym++)
+      Counts[lengths[sym]]++;
+
+    Counts[0] = 0;
+
+    //reject over-subscribed codes, incomplete ones are allowed (e.g. a
+    //single distance code)
+    int left = 1;
+    for(unsigned len = 1; len <= MaxBits; len++)
+    {
+      left <<= 1;
+      left -= Counts[len];
+
+      if(left < 0)
+        return Error{"Inflate: over-subscribed huffman code"};
+    }
+
+    U16 offsets[MaxBits + 2];
+    offsets[1] = 0;
+    for(unsigned len = 1; len <= MaxBits; len++)
+      offsets[len + 1] = offsets[len] + Counts[len];
+
+    for(size_t sym = 0; sym < n; sym++)
+      if(lengths[sym] != 0)
+        Symbols[offsets[lengths[sym]]++] = static_cast<U16>(sym);
+
+    U32 code{0};
+    size_t index{0};
+    for(unsigned len = 1; len <= MaxBits; len++)
+    {
+      for(U16 i = 0; i < Counts[len]; i++, code++)
+      {
+        U16 sym = Symbols[index++];
+
+        if(len > FastBits)
+          continue;
+
+        //huffman codes are packed starting with their most significant bit
+        U32 reversed{0};
+        for(unsigned bit = 0; bit < len; bit++)
+          reversed |= ((code >> bit) & 1) << (len - 1 - bit);
+
+        for(U32 j = reversed; j < (1u << FastBits); j += (1u << len))
+          Fast[j] = static_cast<U16>((sym << 4) | len);
+      }
+
+      code <<= 1;
+    }
+
+    return {};
+  }
+
+  //Returns the decoded symbol or -1 for an invalid code
+  int Decode(BitReader& bits) const
+  {
+    bits.Refill();
+
+    U16 entry = Fast[bits.Peek(FastBits)];
+    if(entry != 0)
+    {
+      bits.Consume(entry & 0xF);
+      return entry >> 4;
+    }
+
+    int code{0};
+    int first{0};
+    int index{0};
+
+    for(unsigned len = 1; len <= MaxBits; len++)
+    {
+      code |= static_cast<int>(bits.Peek(1));
+      bits.Consume(1);
+
+      int count = Counts[len];
+      if(code - first < count)
+        return Symbols[index + (code - first)];
+
+      index += count;
+      first += count;
+      first <<= 1;
+      code <<= 1;
+    }
+
+    return -1;
+  }
+};
+
+static constexpr U16 lengthBase[29] = {
+  3, 4, 5, 6, 7, 8, 9, 10, 11, 13, 15, 17, 19, 23, 27, 31,
+  35, 43, 51, 59, 67, 83, 99, 115, 131, 163, 195, 227, 258 };
+static constexpr U8 lengthExtra[29] = {
+  0, 0, 0, 0, 0, 0, 0, 0, 1, 1, 1, 1, 2, 2, 2, 2,
+  3, 3, 3, 3, 4, 4, 4, 4, 5, 5, 5, 5, 0 };
+static constexpr U16 distBase[30] = {
+  1, 2, 3, 4, 5, 7, 9, 13, 17, 25, 33, 49, 65, 97, 129, 193,
+  257, 385, 513, 769, 1025, 1537, 2049, 3073, 4097, 6145, 8193, 12289, 16385, 24577 };
+static constexpr U8 distExtra[30] = {
+  0, 0, 0, 0, 1, 1, 2, 2, 3, 3, 4, 4, 5, 5, 6, 6,
+  7, 7, 8, 8, 9, 9, 10, 10, 11, 11, 12, 12, 13, 13 };
+
+struct FixedCodes
+{
+  Huffman LitLen;
+  Huffman Dist;
+
+  FixedCodes()
+  {
+    U8 lengths[288];
+    std::fill(lengths, lengths + 144, 8);
+    std::fill(lengths + 144, lengths + 256, 9);
+    std::fill(lengths + 256, lengths + 280, 7);
+    std::fill(lengths + 280, lengths + 288, 8);
+    LitLen.Build(lengths, 288);
+
+    std::fill(lengths, lengths + 30, 5);
+    Dist.Build(lengths, 30);
+  }
+};
+
+static ErrorOr<void> inflateCodes(BitReader& bits, const Huffman& litLen, const Huffman& dist,
+    U8* dst, size_t size, size_t& pos)
+{
+  while(true)
+  {
+    int sym = litLen.Decode(bits);
+
+    if(sym < 0)
+      return Error{"Inflate: invalid literal/length code"};
+
+    if(sym < 256)
+    {
+      if(pos >= size)
+        return Error{"Inflate: output exceeds the uncompressed size"};
+
+      dst[pos++] = static_cast<U8>(sym);
+      continue;
+    }
+
+    if(sym == 256)
+      return {};
+
+    sym -= 257;
+    if(sym >= 29)
+      return Error{fmt::format("Inflate: invalid length symbol {}", sym + 257)};
+
+    size_t len = lengthBase[sym] + bits.Bits(lengthExtra[sym]);
+
+    int distSym = dist.Decode(bits);
+    if(distSym < 0 || distSym >= 30)
+      return Error{"Inflate: invalid distance code"};
+
+    size_t distance = distBase[distSym] + bits.Bits(distExtra[distSym]);
+
+    if(distance > pos)
+      return Error{fmt::format("Inflate: distance {} reaches before the start of the output", distance)};
+
+    if(len > size - pos)
+      return Error{"Inflate: output exceeds the uncompressed size"};
+
+    const U8* src = dst + pos - distance;
+
+    //byte by byte when the match overlaps its own output (e.g. runs)
+    if(distance >= len)
+      std::memcpy(dst + pos, src, len);
+    else
+      for(size_t i = 0; i < len; i++)
+        dst[pos + i] = src[i];
+
+    pos += len;
+  }
+}
+
+static ErrorOr<void> inflateDynamic(BitReader& bits, U8* dst, size_t size, size_t& pos)
+{
+  static constexpr U8 order[19] = { 16, 17, 18, 0, 8, 7, 9, 6, 10, 5, 11, 4, 12, 3, 13, 2, 14, 1, 15 };
+
+  size_t nLitLen = bits.Bits(5) + 257;
+  size_t nDist = bits.Bits(5) + 1;
+  size_t nCodeLen = bits.Bits(4) + 4;
+
+  if(nLitLen > 286 || nDist > 30)
+    return Error{"Inflate: bad dynamic block counts"};
+
+  U8 lengths[286 + 30]{};
+
+  for(size_t i = 0; i < nCodeLen; i++)
+    lengths[order[i]] = static_cast<U8>(bits.Bits(3));
+
+  Huffman codeLen;
+  TRY(codeLen.Build(lengths, 19));
+
+  std::fill(lengths, lengths + 19, 0);
+
+  for(size_t i = 0; i < nLitLen + nDist; )
+  {
+    int sym = codeLen.Decode(bits);
+
+    if(sym < 0)
+      return Error{"Inflate: invalid code length code"};
+
+    if(sym < 16)
+    {
+      lengths[i++] = static_cast<U8>(sym);
+      continue;
+    }
+
+    U8 value{0};
+    size_t repeat{0};
+
+    if(sym == 16)
+    {
+      if(i == 0)
+        return Error{"Inflate: repeated code length without a previous one"};
+
+      value = lengths[i - 1];
+      repeat = 3 + bits.Bits(2);
+    }
+    else if(sym == 17)
+      repeat = 3 + bits.Bits(3);
+    else
+      repeat = 11 + bits.Bits(7);
+
+    if(i + repeat > nLitLen + nDist)
+      return Error{"Inflate: code lengths exceed the declared counts"};
+
+    std::fill(lengths + i, lengths + i + repeat, value);
+    i += repeat;
+  }
+
+  if(lengths[256] == 0)
+    return Error{"Inflate: missing end of block code"};
+
+  Huffman litLen;
+  Huffman dist;
+  TRY(litLen.Build(lengths, nLitLen));
+  TRY(dist.Build(lengths + nLitLen, nDist));
+
+  return inflateCodes(bits, litLen, dist, dst, size, pos);
+}
+
+static ErrorOr<void> inflateStored(BitReader& bits, U8* dst, size_t size, size_t& pos)
+{
+  bits.AlignToByte();
+
+  U16 len = static_cast<U16>(bits.Bits(16));
+  U16 nlen = static_cast<U16>(bits.Bits(16));
+
+  if(len != static_cast<U16>(~nlen))
+    return Error{"Inflate: stored block length doesn't match its complement"};
+
+  if(len > size - pos)
+    return Error{"Inflate: output exceeds the uncompressed size"};
+
+  for(U16 i = 0; i < len; i++)
+    dst[pos++] = static_cast<U8>(bits.Bits(8));
+
+  return {};
+}
+
+//Decompresses exactly size bytes of raw DEFLATE data into dst
+static ErrorOr<void> inflate(ByteView src, U8* dst, size_t size)
+{
+  static const FixedCodes fixed;
+
+  BitReader bits{src.Data, src.Size};
+  size_t pos{0};
+  bool final{false};
+
+  while(!final)
+  {
+    final = bits.Bits(1);
+
+    switch(bits.Bits(2))
+    {
+      case 0: TRY(inflateStored(bits, dst, size, pos)); break;
+      case 1: TRY(inflateCodes(bits, fixed.LitLen, fixed.Dist, dst, size, pos)); break;
+      case 2: TRY(inflateDynamic(bits, dst, size, pos)); break;
+
+      default: return Error{"Inflate: invalid block type"};
+    }
+
+    if(bits.Overrun())
+      return Error{"Inflate: compressed data is truncated"};
+  }
+
+  if(pos != size)
+    return Error{fmt::format("Inflate: produced {} bytes, expected {}", pos, size)};
+
+  return {};
+}
+
+//
+// ZipArchive
+//
+
+ErrorOr<ZipArchive> ZipArchive::Open(const std::string& path)
+{
+  //entries are read in whatever order callers (possibly several threads)
+  //extract them, so no sequential hint
+  auto errOrView = MapFile(path, "ZipArchive::Open()", false);
+  VERIFY(errOrView);
+
+  ZipArchive archive;
+  archive.m_data = errOrView.Get().Data;
+  archive.m_size = errOrView.Get().Size;
+  archive.m_mapped = true;
+
+  TRY(archive.readCentralDirectory(), fmt::format("failed to read \"{}\"", path));
+
+  return archive;
+}
+
+ErrorOr<ZipArchive> ZipArchive::FromBuffer(const U8* data, size_t size)
+{
+  ZipArchive archive;
+  archive.m_data = data;
+  archive.m_size = size;
+
+  TRY(archive.readCentralDirectory());
+
+  return archive;
+}
+
+ErrorOr<void> ZipArchive::readCentralDirectory()
+{
+  if(m_size < endOfCentralDirSize)
+    return Error{"ZipArchive: too small to be a zip archive"};
+
+  //the end of central directory record is followed by a comment of up to
+  //64KiB, so scan backwards for its signature
+  size_t eocd = m_size - endOfCentralDirSize;
+  size_t lowest = eocd > 0xFFFF ? eocd - 0xFFFF : 0;
+
+  while(true)
+  {
+    U32 signature;
+    Load<LittleEndian>(m_data + eocd, signature);
+
+    if(signature == endOfCentralDirSignature)
+      break;
+
+    if(eocd == lowest)
+      return Error{"ZipArchive: end of central directory record not found"};
+
+    eocd--;
+  }
+
+  ByteReader reader{m_data + eocd + 4, endOfCentralDirSize - 4};
+
+  U16 disk, cdDisk, diskEntries, totalEntries;
+  U32 cdSize, cdOffset;
+  TRY(Read<LittleEndian>(reader, disk, cdDisk, diskEntries, totalEntries, cdSize, cdOffset));
+
+  if(disk != 0 || cdDisk != 0 || diskEntries != totalEntries)
+    return Error{"ZipArchive: multi-disk archives aren't supported"};
+
+  if(totalEntries == 0xFFFF || cdSize == 0xFFFFFFFF || cdOffset == 0xFFFFFFFF)
+    return Error{"ZipArchive: ZIP64 archives aren't supported"};
+
+  if(cdOffset > eocd || cdSize > eocd - cdOffset)
+    return Error{"ZipArchive: central directory lies outside of the archive"};
+
+  reader = ByteReader{m_data + cdOffset, cdSize};
+
+  m_entries.clear();
+  m_entries.reserve(totalEntries);
+
+  for(U16 i = 0; i < totalEntries; i++)
+  {
+    U32 signature;
+    U16 versionMadeBy, versionNeeded, time, date;
+    U16 nameLen, extraLen, commentLen, diskStart, internalAttrs;
+    U32 externalAttrs;
+
+    Entry entry;
+
+    TRY(Read<LittleEndian>(reader, signature, versionMadeBy, versionNeeded, entry.Flags,
+          entry.Method, time, date, entry.CRC32, entry.CompressedSize, entry.UncompressedSize,
+          nameLen, extraLen, commentLen, diskStart, internalAttrs, externalAttrs,
+          entry.LocalHeaderOffset), fmt::format("failed to read central directory entry {}", i));
+
+    if(signature != centralHeaderSignature)
+    {
+      return Error{fmt::format("ZipArchive: bad signature 0x{:x} for central "
+          "directory entry {}", signature, i)};
+    }
+
+    auto errOrName = ReadView(reader, nameLen);
+    VERIFY(errOrName, fmt::format("failed to read name of entry {}", i));
+
+    ByteView name = errOrName.Get();
+    entry.Name = {reinterpret_cast<const char*>(name.Data), name.Size};
+
+    TRY(ReadView(reader, static_cast<size_t>(extraLen) + commentLen),
+        fmt::format("failed to skip extra fields of \"{}\"", entry.Name));
+
+    m_entries.push_back(entry);
+  }
+
+  return {};
+}
+
+ErrorOr<ByteView> ZipArchive::GetData(const Entry& entry) const
+{
+  if(entry.LocalHeaderOffset > m_size || m_size - entry.LocalHeaderOffset < localHeaderSize)
+    return Error{fmt::format("ZipArchive: local header of \"{}\" is out of bounds", entry.Name)};
+
+  ByteReader reader{m_data + entry.LocalHeaderOffset, m_size - entry.LocalHeaderOffset};
+
+  //the local header repeats most of the central directory entry, only its
+  //name and extra field lengths are needed to locate the data as they may 
+  //differ from the central directory's
+  U32 signature, crc, compressedSize, uncompressedSize;
+  U16 versionNeeded, flags, method, time, date, nameLen, extraLen;
+
+  TRY(Read<LittleEndian>(reader, signature, versionNeeded, flags, method, time, date, 
+        crc, compressedSize, uncompressedSize, nameLen, extraLen));
+
+  if(signature != localHeaderSignature)
+  {
+    return Error{fmt::format("ZipArchive: bad local header signature 0x{:x} for \"{}\"",
+        signature, entry.Name)};
+  }
+
+  size_t offset = entry.LocalHeaderOffset + localHeaderSize + nameLen + extraLen;
+
+  if(offset > m_size || m_size - offset < entry.CompressedSize)
+    return Error{fmt::format("ZipArchive: data of \"{}\" is out of bounds", entry.Name)};
+
+  return ByteView{m_data + offset, entry.CompressedSize};
+}
+
+ErrorOr<void> ZipArchive::CheckSize(const Entry& entry) const
+{
+  if(entry.UncompressedSize > m_maxEntrySize)
+  {
+    return Error{fmt::format("ZipArchive: \"{}\" claims {} bytes uncompressed, more than "
+        "the maximum entry size of {}", entry.Name, entry.UncompressedSize, m_maxEntrySize)};
+  }
+
+  //the final block's header and padding are a couple of bytes on their own
+  constexpr U64 margin = 16;
+
+  if(entry.Method == CompressionMethod::Deflated && 
+      entry.UncompressedSize > U64{entry.CompressedSize} * MaxDeflateRatio + margin)
+  {
+    return Error{fmt::format("ZipArchive: \"{}\" claims {} bytes uncompressed, which {} "
+        "compressed bytes can't inflate to", entry.Name, entry.UncompressedSize, entry.CompressedSize)};
+  }
+
+  return {};
+}
+
+ErrorOr<void> ZipArchive::Extract(const Entry& entry, U8* dst) const
+{
+  if(entry.Flags & encryptedFlag)
+    return Error{fmt::format("ZipArchive: \"{}\" is encrypted", entry.Name)};
+
+  TRY(this->CheckSize(entry));
+
+  auto errOrData = this->GetData(entry);
+  VERIFY(errOrData);
+
+  ByteView data = errOrData.Get();
+
+  switch(entry.Method)
+  {
+    case CompressionMethod::Stored:
+    {
+      if(entry.CompressedSize != entry.UncompressedSize)
+        return Error{fmt::format("ZipArchive: stored entry \"{}\" has mismatching sizes", entry.Name)};
+
+      std::copy(data.begin(), data.end(), dst);
+      break;
+    }
+
+    case CompressionMethod::Deflated:
+      TRY(inflate(data, dst, entry.UncompressedSize), fmt::format("failed to inflate \"{}\"", entry.Name));
+      break;
+
+    default:
+      return Error{fmt::format("ZipArchive: \"{}\" uses unsupported compression "
+          "method {}", entry.Name, entry.Method)};
+  }
+
+  U32 crc = crc32(dst, entry.UncompressedSize);
+
+  if(crc != entry.CRC32)
+  {
+    return Error{fmt::format("ZipArchive: CRC-32 mismatch for \"{}\" (0x{:08x}, "
+        "expected 0x{:08x})", entry.Name, crc, entry.CRC32)};
+  }
+
+  return {};
+}
+
+ErrorOr< std::vector<U8> > ZipArchive::Extract(const Entry& entry) const
+{
+  TRY(this->CheckSize(entry));
+
+  std::vector<U8> bytes(entry.UncompressedSize);
+  TRY(this->Extract(entry, bytes.data()));
+
+  return bytes;
+}
+
+ErrorOr<ByteView> ZipArchive::View(const Entry& entry) const
+{
+  if(entry.Method != CompressionMethod::Stored || entry.CompressedSize != entry.UncompressedSize)
+    return Error{fmt::format("ZipArchive: \"{}\" isn't stored uncompressed", entry.Name)};
+
+  if(entry.Flags & encryptedFlag)
+    return Error{fmt::format("ZipArchive: \"{}\" is encrypted", entry.Name)};
+
+  auto errOrData = this->GetData(entry);
+  VERIFY(errOrData);
+
+  ByteView data = errOrData.Get();
+  U32 crc = crc32(data.Data, data.Size);
+
+  if(crc != entry.CRC32)
+  {
+    return Error{fmt::format("ZipArchive: CRC-32 mismatch for \"{}\" (0x{:08x}, "
+        "expected 0x{:08x})", entry.Name, crc, entry.CRC32)};
+  }
+
+  return data;
+}
+
+ZipArchive::ZipArchive(ZipArchive&& other) noexcept
+: m_data{std::exchange(other.m_data, nullptr)}
+, m_size{std::exchange(other.m_size, 0)}
+, m_mapped{std::exchange(other.m_mapped, false)}
+, m_maxEntrySize{other.m_maxEntrySize}
+, m_entries{std::move(other.m_entries)}
+{
+}
+
+ZipArchive& ZipArchive::operator=(ZipArchive&& other) noexcept
+{
+  if(this == &other)
+    return *this;
+
+  this->unmap();
+
+  m_data = std::exchange(other.m_data, nullptr);
+  m_size = std::exchange(other.m_size, 0);
+  m_mapped = std::exchange(other.m_mapped, false);
+  m_maxEntrySize = other.m_maxEntrySize;
+  m_entries = std::move(other.m_entries);
+
+  return *this;
+}
+
+ZipArchive::~ZipArchive()
+{
+  this->unmap();
+}
+
+void ZipArchive::unmap()
+{
+  if(m_mapped)
+    UnmapFile({m_data, m_size});
+
+  m_data = nullptr;
+  m_size = 0;
+  m_mapped = false;
+}
+
+} //namespace ClassFile